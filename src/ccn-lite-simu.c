@@ -417,8 +417,7 @@ ccnl_simu_add_fwd(char node, const char *name, char dstnode, int mtu)
         fwd->face->frag = ccnl_frag_new(CCNL_FRAG_BEGINEND2015, mtu);
 #endif
     fwd->face->flags |= CCNL_FACE_FLAGS_STATIC;
-    fwd->next = relay->fib;
-    relay->fib = fwd;
+    ccnl_fib_link(relay, fwd);
 }
 
 
@@ -513,21 +512,7 @@ simu_eventloop()
             ts.tv_nsec = 1000 * (usec % 1000000);
             nanosleep(&ts, NULL);
         }
-        t = eventqueue;
-        eventqueue = t->next;
-        if (t->fct) {
-            void (*fct)(char,int) = t->fct;
-            char c = t->node;
-            int i = t->intarg;
-            ccnl_free(t);
-            (fct)(c, i);
-        } else if (t->fct2) {
-            void (*fct2)(void*,void*) = t->fct2;
-            void *aux1 = t->aux1;
-            void *aux2 = t->aux2;
-            ccnl_free(t);
-            (fct2)(aux1, aux2);
-        }
+        ccnl_run_events();
     }
     DEBUGMSG(ERROR, "simu event loop: no more events to handle\n");
 }
@@ -549,8 +534,7 @@ ccnl_simu_cleanup(void *dummy, void *dummy2)
         ccnl_core_cleanup(relay);
     }
 
-    while(eventqueue)
-        ccnl_rem_timer(eventqueue);
+    ccnl_timer_cleanup();
 
     while(etherqueue) {
         struct ccnl_ethernet_s *e = etherqueue->next;
@@ -345,7 +345,7 @@ ccnl_populate_cache(struct ccnl_relay_s *ccnl, char *path)
             continue;
         }
 
-        buf = (struct ccnl_buf_s *) ccnl_malloc(sizeof(*buf) + s.st_size);
+        buf = ccnl_buf_new(NULL, s.st_size);
         if (buf)
             datalen = read(fd, buf->data, s.st_size);
         else
@@ -420,15 +420,15 @@ ccnl_populate_cache(struct ccnl_relay_s *ccnl, char *path)
             DEBUGMSG(WARNING, "could not create content (%s)\n", de->d_name);
             goto Done;
         }
-        ccnl_content_add2cache(ccnl, c);
         c->flags |= CCNL_CONTENT_FLAGS_STATIC;
+        ccnl_content_add2cache(ccnl, c);
 Done:
         ccnl_pkt_free(pk);
-        ccnl_free(buf);
+        ccnl_buf_free(buf);
         continue;
 notacontent:
         DEBUGMSG(WARNING, "not a content object (%s)\n", de->d_name);
-        ccnl_free(buf);
+        ccnl_buf_free(buf);
     }
 
     closedir(dir);
@@ -114,8 +114,7 @@ add_route(char *pfx, struct ccnl_face_s *face, int suite, int mtu)
     }
 #endif
     fwd->suite = suite;
-    fwd->next = theRelay.fib;
-    theRelay.fib = fwd;
+    ccnl_fib_link(&theRelay, fwd);
 }
 
 JNIEXPORT void JNICALL
@@ -22,24 +22,143 @@
 #ifndef CCNL_LINUXKERNEL
 #include <unistd.h> //FIXME: SWITCH HERE
 #include <string.h>
+#include <stdint.h>
 #endif
 #include <stddef.h>
 
+/**
+ * @brief Number of bytes at either end of a buffer covered by \ref ccnl_buf_hash
+ */
+#define CCNL_BUF_HASH_SPAN      32
+
+/**
+ * @brief A packet takes its receive buffer, rather than a copy, only if it
+ *        fills at least 1/CCNL_BUF_ADOPT_SHARE of it (see \ref ccnl_buf_adopt)
+ */
+#define CCNL_BUF_ADOPT_SHARE    2
+
 
 struct ccnl_relay_s;
+struct ccnl_bufpool_s;
 
 struct ccnl_buf_s {
     struct ccnl_buf_s *next;
+    struct ccnl_bufpool_s *pool; // where the buffer goes when freed, or NULL
+    unsigned int refcnt;        // owners of the buffer, see ccnl_buf_ref()
     size_t datalen;
     unsigned char data[1];
 };
 
+/**
+ * @brief A free list of equally sized buffers to receive packets into
+ *
+ * A pool must outlive its buffers: buffers handed out keep pointing to it.
+ * Buffers are taken by a single thread. If the pool is shared (where
+ * CCNL_BUFPOOL_SHARED is defined), they may be given back by any thread,
+ * and are collected when the free list runs empty.
+ */
+struct ccnl_bufpool_s {
+    struct ccnl_buf_s *free;
+    size_t bufsize;             // room in each buffer
+    unsigned int count;         // buffers in the free list
+    unsigned int max;           // most buffers kept in the free list
+    int shared;                 // buffers are given back by other threads
+    struct ccnl_buf_s *returned; // given back, but not collected yet
+};
+
 /**
  * 
  */
 struct ccnl_buf_s*
 ccnl_buf_new(void *data, size_t len);
 
+/**
+ * @brief Takes another reference to a buffer
+ *
+ * A packet sent to several faces, or sent and kept in the cache, shares one
+ * buffer. Its contents must not be changed while it is shared.
+ *
+ * @param[in] buf       the buffer, may be NULL
+ *
+ * @return buf
+ */
+struct ccnl_buf_s*
+ccnl_buf_ref(struct ccnl_buf_s *buf);
+
+/**
+ * @brief Drops a reference to a buffer
+ *
+ * The last reference frees the buffer, or puts it back into its pool.
+ *
+ * @param[in] buf       the buffer, may be NULL
+ */
+void
+ccnl_buf_free(struct ccnl_buf_s *buf);
+
+/**
+ * @brief Takes a buffer from a pool, allocating one if the pool is empty
+ *
+ * @param[in] pool      the pool
+ *
+ * @return a buffer with datalen set to the pool's buffer size, NULL if
+ *         there is no memory left
+ */
+struct ccnl_buf_s*
+ccnl_bufpool_get(struct ccnl_bufpool_s *pool);
+
+/**
+ * @brief Frees the buffers in the free list of a pool, and those given back
+ *        to a shared pool
+ *
+ * Buffers still in use are freed when they are given back.
+ *
+ * @param[in] pool      the pool
+ */
+void
+ccnl_bufpool_drain(struct ccnl_bufpool_s *pool);
+
+/**
+ * @brief Offers the buffer a frame was received into to the packet parsers
+ *
+ * While a buffer is offered, \ref ccnl_buf_adopt hands it to the parser of
+ * a packet that fills all of it, instead of copying the packet.
+ *
+ * @param[in] buf       the receive buffer, NULL to withdraw the offer
+ *
+ * @return the buffer offered before, NULL if a parser has adopted it
+ */
+struct ccnl_buf_s*
+ccnl_buf_offer(struct ccnl_buf_s *buf);
+
+/**
+ * @brief Returns a buffer holding the packet at data
+ *
+ * That is the offered receive buffer if it holds exactly this packet, and
+ * the packet takes up at least 1/CCNL_BUF_ADOPT_SHARE of the buffer's room,
+ * or a copy otherwise.
+ *
+ * @param[in] data      start of the packet
+ * @param[in] len       length of the packet
+ *
+ * @return the buffer, NULL if there is no memory left
+ */
+struct ccnl_buf_s*
+ccnl_buf_adopt(void *data, size_t len);
+
+/**
+ * @brief Returns a digest of a buffer for \ref ccnl_htable_s lookups
+ *
+ * Only the length and the first and last \ref CCNL_BUF_HASH_SPAN bytes are
+ * hashed, which tell packets apart by their name and signature in constant
+ * time. Buffers with equal digests have to be compared with buf_equal.
+ *
+ * @param[in] buf       the buffer
+ *
+ * @return the digest
+ */
+uint32_t
+ccnl_buf_hash(const struct ccnl_buf_s *buf);
+
 #define buf_dup(B)      (B) ? ccnl_buf_new(B->data, B->datalen) : NULL
 #define buf_equal(X,Y)  ((X) && (Y) && (X->datalen==Y->datalen) &&\
                          !memcmp(X->data,Y->data,X->datalen))
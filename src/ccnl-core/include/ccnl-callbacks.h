@@ -31,6 +31,13 @@ typedef int (*ccnl_cb_on_data)(struct ccnl_relay_s *relay,
                                struct ccnl_face_s *face,
                                struct ccnl_pkt_s *pkt);
 
+/**
+ * @brief Function pointer callback type for Data delivered to the local
+ *        application
+ */
+typedef int (*ccnl_cb_on_app_data)(struct ccnl_relay_s *relay,
+                                   struct ccnl_content_s *c);
+
 /**
  * @brief Set an inbound on-data event callback function
  *
@@ -85,4 +92,21 @@ int ccnl_callback_tx_on_data(struct ccnl_relay_s *relay,
                              struct ccnl_face_s *to,
                              struct ccnl_pkt_s *pkt);
 
+/**
+ * @brief Callback for Data delivered to the local application
+ *
+ * Calls the relay's app_rx, which \ref ccnl_app_open sets, for Data which
+ * satisfies an Interest received over the local (in-memory) face, either
+ * from the Content Store or when the Data arrives. The content is borrowed:
+ * it is only valid until the callback returns.
+ *
+ * @param[in] relay The active ccn-lite relay
+ * @param[in] c     The content which satisfies the application's Interest
+ *
+ * @return return value of the callback function
+ * @return 0, if no function has been set
+ */
+int ccnl_callback_app_rx(struct ccnl_relay_s *relay,
+                         struct ccnl_content_s *c);
+
 #endif  /* CCNL_CALLBACKS_H */
@@ -26,6 +26,9 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include "ccnl-htable.h"
+#include "ccnl-wheel.h"
+
 #ifdef CCNL_RIOT
 #include "evtimer_msg.h"
 #endif
@@ -49,12 +52,17 @@ typedef enum ccnl_content_flags_e {
  *
  * The content store is implemented as linked list and stores the
  * full byte representation (the packet) of an content object 
- * (and not just the content itself).
+ * (and not just the content itself). Entries are additionally indexed
+ * by their exact name (suite, components and chunk number).
  */
 typedef struct ccnl_content_s {
     struct ccnl_content_s *next;          /**< pointer to the next element in the content store */
     struct ccnl_content_s *prev;          /**< pointer to the previous element in the content store */
     struct ccnl_pkt_s *pkt;               /**< a byte representation of received content (the actual packet) */
+    struct ccnl_hlink_s hlink;            /**< link in the content store's name index */
+    struct ccnl_content_s *lru_prev;      /**< more recently used content (NULL for the newest) */
+    struct ccnl_content_s *lru_next;      /**< less recently used content (NULL for the oldest) */
+    struct ccnl_wlink_s wlink;            /**< link in the content store's ageing wheel */
 
     ccnl_content_flags flags;             /**< indicates if content is marked static or stale */
 
@@ -62,6 +70,7 @@ typedef struct ccnl_content_s {
     // >> CCNL: currently no stale bit, old content is fully removed <<
 
     uint32_t last_used;                   /**< indicates when the stored content was last used */
+    uint32_t created;                     /**< indicates when the content was received (for freshness) */
 #ifdef CCNL_RIOT
     evtimer_msg_event_t evtmsg_cstimeout; /**< event timer message which is triggered when a timeout in the content store occurs */
 #endif
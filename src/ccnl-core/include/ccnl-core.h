@@ -28,6 +28,8 @@
 #include "ccnl-defs.h"
 #include "ccnl-face.h"
 #include "ccnl-frag.h"
+#include "ccnl-htable.h"
+#include "ccnl-wheel.h"
 #include "ccnl-interest.h"
 #include "ccnl-malloc.h"
 #include "ccnl-os-time.h"
@@ -82,6 +82,9 @@
 #ifndef CCNL_MAX_INTEREST_RETRANSMIT
 # define CCNL_MAX_INTEREST_RETRANSMIT    7
 #endif
+#ifndef CCNL_INTEREST_RETRANS_PERIOD
+# define CCNL_INTEREST_RETRANS_PERIOD    1   // sec, between retransmissions
+#endif
 
 #ifndef CCNL_FACE_TIMEOUT
 // # define CCNL_FACE_TIMEOUT    60 // sec
@@ -89,11 +92,29 @@
 #endif
 
 #define CCNL_DEFAULT_MAX_CACHE_ENTRIES  0   // means: no content caching
+#ifndef CCNL_MAX_NONCES
 #ifdef CCNL_RIOT
 #define CCNL_MAX_NONCES                 -1 // -1 --> detect dups by PIT
 #else //!CCNL_RIOT
-#define CCNL_MAX_NONCES                 256 // for detected dups
+#define CCNL_MAX_NONCES                 262144 // default bound of the nonce ring
 #endif //CCNL_RIOT
+#endif
+#ifndef CCNL_NONCE_RING_MIN
+#define CCNL_NONCE_RING_MIN             1024 // slots first allocated, doubled as needed
+#endif
+#ifndef CCNL_NONCE_TIMEOUT
+# define CCNL_NONCE_TIMEOUT             4 // sec, default window a nonce is a dup in
+#endif
+#define CCNL_NONCE_MAXLEN               16 // longer nonces are compared by prefix and hash
+
+// static scratch buffers (printable addresses, timestamps etc.) are per
+// thread where forwarding threads may use them concurrently
+#if defined(CCNL_UNIX) && defined(__GNUC__)
+# define CCNL_THREAD_LOCAL              __thread
+# define CCNL_BUFPOOL_SHARED            // see struct ccnl_bufpool_s
+#else
+# define CCNL_THREAD_LOCAL
+#endif
 
 enum {
 #ifdef USE_SUITE_CCNB
@@ -242,6 +263,7 @@ typedef enum ccnl_enc_e {
 #define CCNL_FACE_FLAGS_REFLECT 2
 #define CCNL_FACE_FLAGS_SERVED  4
 #define CCNL_FACE_FLAGS_FWDALLI 8 // forward all interests, also known ones
+#define CCNL_FACE_FLAGS_APP     16 // the local application, its Data is cached
 
 #define CCNL_FRAG_NONE          0
 #define CCNL_FRAG_SEQUENCED2012 1
@@ -259,10 +281,14 @@ typedef enum ccnl_enc_e {
 // ----------------------------------------------------------------------
 
 
+#define CCNL_CCNX_DIGEST_LEN    32 // SHA256
+
+// writes the digest of a packet to md (CCNL_CCNX_DIGEST_LEN bytes) and
+// returns md, or NULL without digest support
 #ifdef USE_CCNxDIGEST
-#  define compute_ccnx_digest(buf) SHA256(buf->data, buf->datalen, NULL)
+#  define compute_ccnx_digest(buf, md) SHA256((buf)->data, (buf)->datalen, md)
 #else
-#  define compute_ccnx_digest(b) NULL
+#  define compute_ccnx_digest(b, md) ((void) (md), NULL)
 #endif
 
 #endif //CCNL_DEFS_H
@@ -24,19 +24,38 @@
 #define CCNL_FACE_H
 
 #include "ccnl-sockunion.h"
+#include "ccnl-htable.h"
+#include "ccnl-wheel.h"
 
 #ifdef CCNL_RIOT
 #include "evtimer_msg.h"
 #endif
 
+struct ccnl_outq_s {            // a packet waiting in a face's queue
+    struct ccnl_outq_s *next;
+    struct ccnl_hlink_s hlink;  // link in the face's outq_index
+    struct ccnl_buf_s *buf;     // a reference, the buffer may be shared
+};
+
 struct ccnl_face_s {
     struct ccnl_face_s *next, *prev;
+    struct ccnl_hlink_s hlink; // link in the relay's face index (ifndx, peer)
+    struct ccnl_hlink_s idlink; // link in the relay's face id index
     int faceid;
     int ifndx;
     sockunion peer;
     int flags;
     int last_used; // updated when we receive a packet
-    struct ccnl_buf_s *outq, *outqend; // queue of packets to send
+    uint32_t served_epoch; // relay's serve_epoch when data was last sent on this face
+    struct ccnl_wlink_s wlink; // link in the relay's face ageing wheel
+    struct ccnl_pendint_s *pendints; // PIT pending entries for this face
+    struct ccnl_interest_s *origins; // PIT entries received from this face
+    struct ccnl_forward_s *fwds; // FIB entries forwarding to this face
+    struct ccnl_outq_s *outq, *outqend; // queue of packets to send
+    struct ccnl_htable_s outq_index; // the queued packets, by ccnl_buf_hash()
+#ifdef USE_STATS
+    uint32_t outq_dups; // packets not queued because already there
+#endif
     struct ccnl_frag_s *frag;  // which special datagram armoring
     struct ccnl_sched_s *sched;
 #ifdef CCNL_RIOT
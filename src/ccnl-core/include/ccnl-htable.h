@@ -0,0 +1,156 @@
+/**
+ * @addtogroup CCNL-core
+ * @{
+ *
+ * @file ccnl-htable.h
+ * @brief CCN lite, intrusive hash table used to index the relay's tables
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef CCNL_HTABLE_H
+#define CCNL_HTABLE_H
+
+#ifndef CCNL_LINUXKERNEL
+#include <stddef.h>
+#include <stdint.h>
+#endif
+
+/**
+ * @brief Initial number of buckets, must be a power of two
+ */
+#ifndef CCNL_HTABLE_MIN_SIZE
+#define CCNL_HTABLE_MIN_SIZE        16
+#endif
+
+/**
+ * @brief Start value for the FNV-1a hash helpers
+ */
+#define CCNL_HASH_INIT              2166136261u
+
+/**
+ * @brief Returns the element of type \p type which embeds the link \p link
+ * as member \p member
+ */
+#define CCNL_HTABLE_ENTRY(link, type, member) \
+    ((type *) (void *) ((char *) (link) - offsetof(type, member)))
+
+/**
+ * @brief Link embedded into every element which is stored in a hash table
+ *
+ * The hash table does not allocate memory for its elements. An element is
+ * in at most one table per embedded link.
+ */
+struct ccnl_hlink_s {
+    struct ccnl_hlink_s *next;  /**< next element in the same bucket */
+    uint32_t hash;              /**< hash value the element was added with */
+};
+
+/**
+ * @brief A chained hash table with a power-of-two number of buckets
+ *
+ * A zeroed table is a valid empty table, the bucket array is allocated on
+ * the first insert and grows with the number of elements.
+ */
+struct ccnl_htable_s {
+    struct ccnl_hlink_s **buckets; /**< the bucket array */
+    uint32_t size;                 /**< number of buckets (0: not allocated) */
+    uint32_t count;                /**< number of elements in the table */
+};
+
+/**
+ * @brief Continues a FNV-1a hash over \p len bytes of \p data
+ *
+ * @param[in] hash  The hash value so far (start with \ref CCNL_HASH_INIT)
+ * @param[in] data  The bytes to add to the hash
+ * @param[in] len   The number of bytes in \p data
+ *
+ * @return The updated hash value
+ */
+uint32_t
+ccnl_hash_bytes(uint32_t hash, const void *data, size_t len);
+
+/**
+ * @brief Continues a FNV-1a hash over the integer \p value
+ *
+ * @param[in] hash  The hash value so far
+ * @param[in] value The value to add to the hash
+ *
+ * @return The updated hash value
+ */
+uint32_t
+ccnl_hash_uint(uint32_t hash, uint32_t value);
+
+/**
+ * @brief Adds the element linked by \p link to \p table
+ *
+ * @param[in] table The hash table
+ * @param[in] link  The link embedded in the element
+ * @param[in] hash  The hash value of the element's key
+ *
+ * @return 0 upon success
+ * @return -1 if the bucket array could not be allocated
+ */
+int
+ccnl_htable_add(struct ccnl_htable_s *table, struct ccnl_hlink_s *link,
+                uint32_t hash);
+
+/**
+ * @brief Removes the element linked by \p link from \p table
+ *
+ * @param[in] table The hash table
+ * @param[in] link  The link embedded in the element
+ *
+ * @return 0 upon success
+ * @return -1 if the element is not in the table
+ */
+int
+ccnl_htable_remove(struct ccnl_htable_s *table, struct ccnl_hlink_s *link);
+
+/**
+ * @brief Returns the first element in \p table which was added with \p hash
+ *
+ * Keys are not compared, the caller has to check the returned element and
+ * continue with \ref ccnl_htable_next on a mismatch.
+ *
+ * @param[in] table The hash table
+ * @param[in] hash  The hash value to look for
+ *
+ * @return The link of the first candidate, NULL if there is none
+ */
+struct ccnl_hlink_s*
+ccnl_htable_first(struct ccnl_htable_s *table, uint32_t hash);
+
+/**
+ * @brief Returns the next element with the same hash value as \p link
+ *
+ * @param[in] link  A link returned by \ref ccnl_htable_first or
+ *                  \ref ccnl_htable_next
+ *
+ * @return The link of the next candidate, NULL if there is none
+ */
+struct ccnl_hlink_s*
+ccnl_htable_next(struct ccnl_hlink_s *link);
+
+/**
+ * @brief Releases the bucket array of \p table (but not its elements)
+ *
+ * @param[in] table The hash table
+ */
+void
+ccnl_htable_free(struct ccnl_htable_s *table);
+
+#endif // CCNL_HTABLE_H
+/** @} */
@@ -40,6 +40,33 @@ int ccnl_http_status(struct ccnl_relay_s *ccnl, struct ccnl_http_s *http);
 struct ccnl_http_s*
 ccnl_http_cleanup(struct ccnl_http_s *http);
 
+/**
+ * @brief Returns the socket the status server currently waits on
+ *
+ * @param[in]  http     the status server
+ * @param[out] rd       whether the server wants to read from the socket
+ * @param[out] wr       whether the server wants to write to the socket
+ *
+ * @return the socket, -1 if \ref http is NULL
+ */
+int
+ccnl_http_wants(struct ccnl_http_s *http, int *rd, int *wr);
+
+/**
+ * @brief Serves the status server socket after it became ready
+ *
+ * @param[in] ccnl      the relay
+ * @param[in] http      the status server
+ * @param[in] fd        the socket returned by \ref ccnl_http_wants
+ * @param[in] rd        whether the socket is readable
+ * @param[in] wr        whether the socket is writable
+ *
+ * @return 0 on success, -1 if \ref http is NULL
+ */
+int
+ccnl_http_io(struct ccnl_relay_s *ccnl, struct ccnl_http_s *http,
+             int fd, int rd, int wr);
+
 int
 ccnl_http_anteselect(struct ccnl_relay_s *ccnl, struct ccnl_http_s *http,
                      fd_set *readfs, fd_set *writefs, int *maxfd);
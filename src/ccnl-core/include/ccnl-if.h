@@ -59,6 +59,7 @@ struct ccnl_if_s { // interface for packet IO
 #endif
     int reflect; // whether to reflect I packets on this interface
     int fwdalli; // whether to forward all I packets rcvd on this interface
+    int stream; // whether each peer is reached over a connection of its own
     uint32_t mtu;
 
     size_t qlen;  // number of pending sends
@@ -68,6 +69,7 @@ struct ccnl_if_s { // interface for packet IO
 
 #ifdef USE_STATS
     uint32_t rx_cnt, tx_cnt;
+    uint32_t rx_batches, rx_batched; // socket reads, and datagrams they returned
 #endif
 };
 
@@ -27,6 +27,8 @@
 
 #include "ccnl-pkt.h"
 #include "ccnl-face.h"
+#include "ccnl-htable.h"
+#include "ccnl-wheel.h"
 
 #ifdef CCNL_RIOT
 #include "evtimer_msg.h"
@@ -38,6 +40,9 @@
 struct ccnl_pendint_s { 
     struct ccnl_pendint_s *next; /**< pointer to the next list element */
     struct ccnl_face_s *face;    /**< pointer to incoming face  */
+    struct ccnl_interest_s *interest; /**< the interest this entry belongs to */
+    struct ccnl_pendint_s *face_next;   /**< next entry of the same face */
+    struct ccnl_pendint_s **face_pprev; /**< link pointing at this entry in the face's list */
     uint32_t last_used;          /** */
 };
 
@@ -47,8 +52,14 @@ struct ccnl_pendint_s {
 struct ccnl_interest_s {
     struct ccnl_interest_s *next;       /**< pointer to the next list element */
     struct ccnl_interest_s *prev;       /**< pointer to the previous list element */
+    struct ccnl_hlink_s hlink;          /**< link in the PIT index (name and selectors) */
+    struct ccnl_hlink_s nlink;          /**< link in the PIT name index (name only) */
+    struct ccnl_hlink_s dlink;          /**< link in the PIT digest index (name without its last component) */
+    struct ccnl_wlink_s wlink;          /**< link in the PIT ageing wheel */
     struct ccnl_pkt_s *pkt;             /**< the packet the interests originates from (?) */
     struct ccnl_face_s *from;           /**< the face the interest was received from */
+    struct ccnl_interest_s *from_next;  /**< next interest received from the same face */
+    struct ccnl_interest_s **from_pprev; /**< link pointing at this interest in the face's list */
     struct ccnl_pendint_s *pending;     /**< linked list of faces wanting that content */
     uint32_t lifetime;                  /**< interest lifetime */
     uint32_t last_used;                 /**< last time the entry was used */
@@ -73,6 +84,24 @@ struct ccnl_interest_s*
 ccnl_interest_new(struct ccnl_relay_s *ccnl, struct ccnl_face_s *from,
                   struct ccnl_pkt_s **pkt);
 
+/**
+ * Returns when the ageing has to look at an interest next: when it is due
+ * for retransmission or times out, whichever comes first
+ *
+ * A retransmission is due up to half a period early, by an amount which
+ * differs between interests: entries created in the same second are not
+ * all retransmitted in the same tick again.
+ *
+ * @param[in] i         the interest
+ * @param[in] now       the current time, in seconds
+ * @param[in] period    the seconds between retransmissions
+ *
+ * @return the deadline, in seconds
+ */
+uint32_t
+ccnl_interest_deadline(struct ccnl_interest_s *i, uint32_t now,
+                       uint32_t period);
+
 /**
  * Checks if two interests are the same
  * 
@@ -87,6 +116,20 @@ ccnl_interest_new(struct ccnl_relay_s *ccnl, struct ccnl_face_s *from,
 int
 ccnl_interest_isSame(struct ccnl_interest_s *i, struct ccnl_pkt_s *pkt);
 
+/**
+ * Looks up the PIT entry which is the same interest as \ref pkt
+ *
+ * This is a probe of the PIT index and equivalent to calling
+ * \ref ccnl_interest_isSame on every PIT entry.
+ *
+ * @param[in] ccnl
+ * @param[in] pkt
+ *
+ * @return the PIT entry, NULL if there is none
+ */
+struct ccnl_interest_s*
+ccnl_interest_find(struct ccnl_relay_s *ccnl, struct ccnl_pkt_s *pkt);
+
 /**
  * Adds a pending interest
  * 
@@ -115,4 +158,13 @@ ccnl_interest_append_pending(struct ccnl_interest_s *i, struct ccnl_face_s *from
 int
 ccnl_interest_remove_pending(struct ccnl_interest_s *i, struct ccnl_face_s *face);
 
+/**
+ * Unlinks a pending interest entry from its interest and from its face and
+ * frees it
+ * 
+ * @param[in] pi the pending interest entry
+ */
+void
+ccnl_pendint_free(struct ccnl_pendint_s *pi);
+
 #endif //CCNL_INTEREST_H
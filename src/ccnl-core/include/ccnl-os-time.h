@@ -75,8 +75,12 @@ timestamp(void);
 // ----------------------------------------------------------------------
 
 struct ccnl_timer_s {
-    struct ccnl_timer_s *next;
+    struct ccnl_timer_s *next; // next unused timer (in the pool)
     struct timeval timeout;
+    int heapidx;               // position in the timer heap, -1 if not pending
+    uint32_t seq;              // orders timers with equal timeouts
+    uint32_t idx;              // position among all timers, for the handle
+    uintptr_t gen;             // incremented whenever the timer is reused
     void (*fct)(char,int);
     void (*fct2)(void*,void*);
     char node;
@@ -92,13 +96,42 @@ ccnl_get_timeval(struct timeval *tv);
 long
 timevaldelta(struct timeval *a, struct timeval *b);
 
+/**
+ * @brief Calls @p fct with @p aux1 and @p aux2 in @p usec microseconds
+ *
+ * @return an opaque handle for \ref ccnl_rem_timer, NULL on error
+ */
 void*
 ccnl_set_timer(uint64_t usec, void (*fct)(void *aux1, void *aux2),
                  void *aux1, void *aux2);
 
+/**
+ * @brief Removes a pending timer
+ *
+ * A handle stays valid after its timer expired or was removed: it then
+ * refers to no timer, even when the timer's memory is reused.
+ *
+ * @param[in] h     a handle returned by \ref ccnl_set_timer
+ */
 void
 ccnl_rem_timer(void *h);
 
+/**
+ * @brief Removes all pending timers and releases the memory kept for timers
+ */
+void
+ccnl_timer_cleanup(void);
+
+/**
+ * @brief Reports when the earliest pending timer expires
+ *
+ * @param[out] tv   the absolute expiry time (as set by gettimeofday)
+ *
+ * @return 0 if a timer is pending, -1 otherwise
+ */
+int
+ccnl_timer_next(struct timeval *tv);
+
 #endif
 
 #ifdef CCNL_LINUXKERNEL
@@ -141,7 +174,7 @@ ccnl_run_events(void);
 
 void*
 ccnl_set_absolute_timer(struct timeval abstime, void (*fct)(void *aux1, void *aux2),
-         void *aux1, void *aux2)
+         void *aux1, void *aux2);
 
 #endif
 
@@ -34,12 +34,18 @@
 #include "ccnl-pkt-ndntlv.h"
 #endif
 
-// packet flags:  0000ebtt
+// packet flags:  00laebtt
 #define CCNL_PKT_REQUEST    0x01 // "Interest"
 #define CCNL_PKT_REPLY      0x02 // "Object", "Data"
 #define CCNL_PKT_FRAGMENT   0x03 // "Fragment"
 #define CCNL_PKT_FRAG_BEGIN 0x04 // see also CCNL_DATA_FRAG_FLAG_FIRST etc
 #define CCNL_PKT_FRAG_END   0x08
+#define CCNL_PKT_ARENA      0x10 // prefix and nonce share the pkt's allocation
+#define CCNL_PKT_LAZY       0x20 // TLVs from lazyoffs on are not decoded yet
+
+// decoding options
+#define CCNL_DECODE_ARENA   0x01 // decode into a single allocation
+#define CCNL_DECODE_LAZY    0x02 // leave what forwarding does not need for later
 
 /**
  * @brief Options for Interest messages of all TLV formats
@@ -106,6 +112,7 @@ struct ccnl_pkt_s {
     uint8_t *hmacSignature;
 #endif
     unsigned int flags;
+    size_t lazyoffs;               /**< first TLV left by CCNL_DECODE_LAZY */
     char suite;
 };
 
@@ -117,6 +124,21 @@ struct ccnl_pkt_s {
 void
 ccnl_pkt_free(struct ccnl_pkt_s *pkt);
 
+/**
+ * @brief Decodes the TLVs of a pkt which CCNL_DECODE_LAZY left for later
+ *
+ * Forwarding only needs the name, the nonce, the lifetime and the
+ * selectors. Whatever looks at the rest, the metadata and the signature,
+ * has to call this first: the Content Store and the callbacks to
+ * applications do.
+ *
+ * @param[in] pkt       the pkt, decoded lazily or not
+ *
+ * @return 0 on success, -1 if the rest of the packet is malformed
+ */
+int8_t
+ccnl_pkt_decode_rest(struct ccnl_pkt_s *pkt);
+
 /**
  * @brief Duplicates a pkt data structure
  *
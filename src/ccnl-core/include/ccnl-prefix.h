@@ -95,6 +95,35 @@ ccnl_prefix_appendCmp(struct ccnl_prefix_s *prefix, uint8_t *cmp, size_t cmplen)
 int
 ccnl_prefix_addChunkNum(struct ccnl_prefix_s *prefix, uint32_t chunknum);
 
+/**
+ * @brief Hashes the suite and the first \p cnt components of a Prefix
+ *
+ * Prefixes which are equal in their first \p cnt components (and suite)
+ * have the same hash value. The chunk number is not part of the hash.
+ *
+ * @param[in] prefix   Prefix to be hashed
+ * @param[in] cnt      Number of components to include (capped at compcnt)
+ *
+ * @return      the hash value
+*/
+uint32_t
+ccnl_prefix_hash(struct ccnl_prefix_s *prefix, uint32_t cnt);
+
+/**
+ * @brief Hashes all leading parts of a Prefix in one pass
+ *
+ * Stores ccnl_prefix_hash(prefix, k) in @p hashes[k] for k = 0 .. n, where
+ * n is @p cnt capped at the number of components.
+ *
+ * @param[in] prefix   Prefix to be hashed
+ * @param[out] hashes  Array of at least @p cnt + 1 hash values
+ * @param[in] cnt      Maximum number of components to include
+ *
+ * @return      n, the number of components which were hashed
+*/
+uint32_t
+ccnl_prefix_hashes(struct ccnl_prefix_s *prefix, uint32_t *hashes, uint32_t cnt);
+
 /**
  * @brief Compares two Prefix datastructures
  *
@@ -25,10 +25,21 @@
 
 #include "ccnl-defs.h"
 #include "ccnl-face.h"
+#include "ccnl-htable.h"
 #include "ccnl-if.h"
 #include "ccnl-pkt.h"
 #include "ccnl-sched.h"
+#include "ccnl-wheel.h"
 
+/**
+ * @brief A slot in the relay's nonce ring
+ */
+struct ccnl_nonce_s {
+    struct ccnl_hlink_s hlink;      /**< link in the relay's nonce index */
+    int last_used;                  /**< time the nonce was recorded */
+    uint8_t len;                    /**< number of bytes in \p data */
+    unsigned char data[CCNL_NONCE_MAXLEN]; /**< the (first bytes of the) nonce */
+};
 
 struct ccnl_relay_s {
     void (*ccnl_ll_TX_ptr)(struct ccnl_relay_s*, struct ccnl_if_s*,
@@ -38,11 +49,35 @@ struct ccnl_relay_s {
 #endif
     int id;
     struct ccnl_face_s *faces;  /**< The existing forwarding faces */
+    struct ccnl_htable_s face_index; /**< The faces, indexed by interface and peer address */
+    struct ccnl_htable_s face_ids; /**< The faces, indexed by face id */
+    struct ccnl_wheel_s face_wheel; /**< The faces, by the time they may time out */
     struct ccnl_forward_s *fib; /**< The Forwarding Information Base (FIB) */
+    struct ccnl_htable_s fib_index; /**< The FIB entries, indexed by suite and prefix */
+    int fib_lencnt[CCNL_MAX_NAME_COMP + 1]; /**< number of indexed FIB entries per prefix length */
+    uint32_t fib_epoch; /**< incremented whenever a FIB entry is added, changed or removed */
+    char fib_ifaces_only; /**< FIB entries over faces without an interface are refused */
 
     struct ccnl_interest_s *pit; /**< The Pending Interest Table (PIT) */
+    struct ccnl_htable_s pit_index; /**< The PIT entries, indexed by name and selectors */
+    struct ccnl_htable_s pit_names; /**< The PIT entries, indexed by name only */
+    int pit_lencnt[CCNL_MAX_NAME_COMP + 1]; /**< number of PIT entries per name length */
+    struct ccnl_htable_s pit_digests; /**< The PIT entries whose last component may be a digest, indexed by the name before it */
+    uint32_t serve_epoch; /**< incremented for every Data which is served to the PIT */
+    struct ccnl_wheel_s pit_wheel; /**< The PIT entries, by their next retransmission or timeout */
     struct ccnl_content_s *contents; /**< contentsend; */
-    struct ccnl_buf_s *nonces;  /**< The nonces that are currently in use */
+    struct ccnl_htable_s cs_index; /**< The contents, indexed by exact name */
+    struct ccnl_content_s *lru_head; /**< most recently used evictable content */
+    struct ccnl_content_s *lru_tail; /**< least recently used evictable content */
+    struct ccnl_wheel_s cs_wheel; /**< The evictable contents, by the time they may time out or become stale */
+    struct ccnl_nonce_s *nonces; /**< ring of the nonces seen in the last nonce_window seconds */
+    struct ccnl_htable_s nonce_index; /**< the nonces in the ring, indexed by value */
+    int nonce_first;            /**< ring slot of the oldest nonce */
+    int noncecnt;               /**< number of nonces in the ring */
+    int noncesize;              /**< number of slots in the ring */
+    int nonce_window;           /**< seconds a nonce is a duplicate for; 0: CCNL_NONCE_TIMEOUT */
+    int max_nonces;             /**< bound of the ring's slots; 0: CCNL_MAX_NONCES */
+    int retrans_period;         /**< seconds between an interest's retransmissions; 0: CCNL_INTEREST_RETRANS_PERIOD */
     int contentcnt;             /**< number of cached items */
     int max_cache_entries;      /**< max number of cached items -1: unlimited */
     int pitcnt;                 /**< Number of entries in the PIT */
@@ -50,6 +85,8 @@ struct ccnl_relay_s {
     struct ccnl_if_s ifs[CCNL_MAX_INTERFACES];
     int ifcount;               /**< number of active interfaces */
     char halt_flag;            /**< Flag to interrupt the IO_Loop and to exit the relay */
+    char tx_deferred;          /**< Interface queues are drained by the IO loop rather than on enqueue */
+    void (*tx_flush)(struct ccnl_relay_s*, struct ccnl_if_s*); /**< drains a full interface queue while tx_deferred is set */
     struct ccnl_sched_s* (*defaultFaceScheduler)(struct ccnl_relay_s*,
                                                  void(*cts_done)(void*,void*)); /**< FuncPoint to the scheduler for faces*/
     struct ccnl_sched_s* (*defaultInterfaceScheduler)(struct ccnl_relay_s*,
@@ -58,6 +95,11 @@ struct ccnl_relay_s {
     struct ccnl_http_s *http;  /**< http server for status information*/
 #endif
     void *aux;
+    struct ccnl_face_s *app_face; /**< the local face of an embedding application (see ccnl-app.h) */
+    int (*app_rx)(struct ccnl_relay_s *relay,
+                  struct ccnl_content_s *c); /**< called with the Data for the local application */
+    int app_busy;               /**< app_rx is running: the relay is in the middle of a packet */
+    struct ccnl_buf_s *app_queue; /**< packets the application sent from within app_rx */
   /*
     struct ccnl_face_s *crypto_face;
     struct ccnl_pendcrypt_s *pendcrypt;
@@ -76,6 +118,17 @@ void ccnl_interest_broadcast(struct ccnl_relay_s *ccnl,
 
 void ccnl_face_CTS(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f);
 
+/**
+ * @brief Looks up a face by its id
+ *
+ * @param[in] ccnl      pointer to current ccnl relay
+ * @param[in] faceid    the id of the face
+ *
+ * @return the face, NULL if there is no face with this id
+ */
+struct ccnl_face_s*
+ccnl_face_find(struct ccnl_relay_s *ccnl, int faceid);
+
 struct ccnl_face_s*
 ccnl_get_face_or_create(struct ccnl_relay_s *ccnl, int ifndx,
                         struct sockaddr *sa, size_t addrlen);
@@ -153,6 +206,33 @@ ccnl_content_remove(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c);
 struct ccnl_content_s*
 ccnl_content_add2cache(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c);
 
+/**
+ * @brief look up the content with exactly the name @p pfx
+ *
+ * Suite, name components and chunk number have to match. This is a probe
+ * of the content store's name index and does not walk the content store.
+ *
+ * @param[in] ccnl  pointer to current ccnl relay
+ * @param[in] pfx   name of the content
+ *
+ * @return   reference to the matching content
+ * @return   NULL, if there is no content with name @p pfx
+*/
+struct ccnl_content_s*
+ccnl_content_find(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *pfx);
+
+/**
+ * @brief mark content @p c as just used (i.e. a content store hit)
+ *
+ * Refreshes the last use of @p c and makes it the most recently used
+ * content, which is the last one to be evicted from a full content store.
+ *
+ * @param[in] ccnl  pointer to current ccnl relay
+ * @param[in] c     content which was used
+*/
+void
+ccnl_content_touch(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c);
+
 /**
  * @brief deliver new content @p c to all clients with (loosely) matching interest 
  *
@@ -164,9 +244,30 @@ ccnl_content_add2cache(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c);
 int
 ccnl_content_serve_pending(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c);
 
+/**
+ * @brief Times out contents, PIT entries and faces and retransmits pending
+ * interests, meant to be called once per second
+ *
+ * Only the entries which are due on the relay's ageing wheels are visited.
+ *
+ * @param[in] ptr   pointer to current ccnl relay
+ * @param[in] dummy unused
+ */
 void
 ccnl_do_ageing(void *ptr, void *dummy);
 
+/**
+ * @brief Records \p nonce unless it was seen in the relay's nonce window
+ *
+ * The nonces are kept in a ring which is allocated on first use. When the
+ * ring is full of nonces still in the window, it is doubled, up to the
+ * relay's max_nonces slots; beyond that the oldest nonce is forgotten early.
+ *
+ * @param[in] ccnl  pointer to current ccnl relay
+ * @param[in] nonce the nonce of a received interest
+ *
+ * @return -1 if the nonce is a duplicate, 0 otherwise
+ */
 int
 ccnl_nonce_find_or_append(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *nonce);
 
@@ -206,6 +307,42 @@ ccnl_fib_rem_entry(struct ccnl_relay_s *relay, struct ccnl_prefix_s *pfx,
                    struct ccnl_face_s *face);
 #endif //NEEDS_PREFIX_MATCHING
 
+/**
+ * @brief Links a forwarding entry into the FIB
+ *
+ * The entry is added to the FIB list and, if it has a prefix, to the
+ * index used for the longest prefix match. An entry over a face without an
+ * interface is refused if the relay's fib_ifaces_only is set.
+ *
+ * @par[in] relay   Local relay struct
+ * @par[in] fwd     The forwarding entry, with prefix, suite and face set
+ *
+ * @return 0    on success
+ * @return -1   on error
+ */
+int
+ccnl_fib_link(struct ccnl_relay_s *relay, struct ccnl_forward_s *fwd);
+
+/**
+ * @brief Unlinks a forwarding entry from the FIB (without freeing it)
+ *
+ * @par[in] relay   Local relay struct
+ * @par[in] fwd     The forwarding entry
+ */
+void
+ccnl_fib_unlink(struct ccnl_relay_s *relay, struct ccnl_forward_s *fwd);
+
+/**
+ * @brief Finds the first FIB entry with exactly the prefix @p pfx
+ *
+ * @par[in] relay   Local relay struct
+ * @par[in] pfx     The prefix (and suite) to look for
+ *
+ * @return the FIB entry, NULL if there is none
+ */
+struct ccnl_forward_s*
+ccnl_fib_find(struct ccnl_relay_s *relay, struct ccnl_prefix_s *pfx);
+
 /**
  * @brief Prints the current FIB
  *
@@ -225,6 +362,32 @@ ccnl_cs_dump(struct ccnl_relay_s *ccnl);
 void
 ccnl_interface_CTS(void *aux1, void *aux2);
 
+/**
+ * @brief Takes the next request from an interface queue without sending it
+ *
+ * The caller sends the packet and then completes the request with
+ * \ref ccnl_interface_tx_done.
+ *
+ * @param[in] ifc       the interface
+ * @param[out] req      the request taken from the queue
+ *
+ * @return 0 on success, -1 if the queue is empty
+ */
+int
+ccnl_interface_dequeue(struct ccnl_if_s *ifc, struct ccnl_txrequest_s *req);
+
+/**
+ * @brief Completes a request taken from an interface queue
+ *
+ * Does the accounting for the sent packet, calls its completion callback
+ * and releases its buffer.
+ *
+ * @param[in] ifc       the interface the request was queued on
+ * @param[in] req       the request
+ */
+void
+ccnl_interface_tx_done(struct ccnl_if_s *ifc, struct ccnl_txrequest_s *req);
+
 #define DBL_LINKED_LIST_ADD(l,e) \
   do { if ((l)) (l)->prev = (e); \
        (e)->next = (l); \
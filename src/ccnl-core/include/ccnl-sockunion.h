@@ -130,6 +130,18 @@ char* ccnl_addr2ascii(sockunion *su);
 int
 ccnl_addr_cmp(sockunion *s1, sockunion *s2);
 
+/**
+ * @brief Continues the hash \p h over the parts of \p su which are compared
+ * by \ref ccnl_addr_cmp
+ *
+ * @param[in] h  The hash value so far
+ * @param[in] su The socket address
+ *
+ * @return The updated hash value
+ */
+uint32_t
+ccnl_addr_hash(uint32_t h, sockunion *su);
+
 char*
 ll2ascii(unsigned char *addr, size_t len);
 
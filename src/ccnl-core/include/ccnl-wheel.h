@@ -0,0 +1,119 @@
+/**
+ * @addtogroup CCNL-core
+ * @{
+ *
+ * @file ccnl-wheel.h
+ * @brief CCN lite, hashed timing wheel for the relay's timeouts
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+
+#ifndef CCNL_WHEEL_H
+#define CCNL_WHEEL_H
+
+#ifndef CCNL_LINUXKERNEL
+#include <stddef.h>
+#include <stdint.h>
+#endif
+
+/**
+ * @brief Number of slots (one per second), must be a power of two
+ *
+ * Deadlines further away than this are kept in their slot for more than one
+ * revolution. The default covers the longest relay timeout.
+ */
+#ifndef CCNL_WHEEL_SIZE
+#ifdef CCNL_RIOT
+#define CCNL_WHEEL_SIZE             16
+#else
+#define CCNL_WHEEL_SIZE             512
+#endif
+#endif
+
+/**
+ * @brief Returns the element of type \p type which embeds the link \p link
+ * as member \p member
+ */
+#define CCNL_WHEEL_ENTRY(link, type, member) \
+    ((type *) (void *) ((char *) (link) - offsetof(type, member)))
+
+/**
+ * @brief Link embedded into every element which is scheduled on a wheel
+ */
+struct ccnl_wlink_s {
+    struct ccnl_wlink_s *next;   /**< next element in the same slot */
+    struct ccnl_wlink_s **pprev; /**< the pointer to this element (NULL: not scheduled) */
+    uint32_t deadline;           /**< time (in seconds) the element is due */
+};
+
+/**
+ * @brief A hashed timing wheel with a resolution of one second
+ *
+ * A zeroed wheel is a valid empty wheel, the slots are allocated on the
+ * first schedule.
+ */
+struct ccnl_wheel_s {
+    struct ccnl_wlink_s **slots; /**< the slot array */
+    uint32_t cursor;             /**< the next second to be expired */
+};
+
+/**
+ * @brief Schedules (or reschedules) the element linked by \p link
+ *
+ * A deadline in the past makes the element due at the next expiry.
+ *
+ * @param[in] wheel     The timing wheel
+ * @param[in] link      The link embedded in the element
+ * @param[in] deadline  Time (in seconds) at which the element is due
+ *
+ * @return 0 upon success
+ * @return -1 if the slots could not be allocated
+ */
+int
+ccnl_wheel_schedule(struct ccnl_wheel_s *wheel, struct ccnl_wlink_s *link,
+                    uint32_t deadline);
+
+/**
+ * @brief Removes the element linked by \p link from its wheel (if any)
+ *
+ * @param[in] link  The link embedded in the element
+ */
+void
+ccnl_wheel_cancel(struct ccnl_wlink_s *link);
+
+/**
+ * @brief Unlinks and returns one element which is due at time \p now
+ *
+ * Call repeatedly until NULL is returned. Only the slots between the last
+ * expiry and \p now are visited, the returned element is no longer scheduled.
+ *
+ * @param[in] wheel The timing wheel
+ * @param[in] now   The current time (in seconds)
+ *
+ * @return The link of a due element, NULL if there is none
+ */
+struct ccnl_wlink_s*
+ccnl_wheel_expire(struct ccnl_wheel_s *wheel, uint32_t now);
+
+/**
+ * @brief Releases the slots of \p wheel (but not its elements)
+ *
+ * @param[in] wheel The timing wheel
+ */
+void
+ccnl_wheel_free(struct ccnl_wheel_s *wheel);
+
+#endif // CCNL_WHEEL_H
+/** @} */
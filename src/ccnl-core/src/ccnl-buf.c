@@ -48,6 +48,8 @@ ccnl_buf_new(void *data, size_t len)
         return NULL;
     }
     b->next = NULL;
+    b->pool = NULL;
+    b->refcnt = 1;
     b->datalen = len;
     if (data) {
         memcpy(b->data, data, len);
@@ -55,6 +57,149 @@ ccnl_buf_new(void *data, size_t len)
     return b;
 }
 
+struct ccnl_buf_s*
+ccnl_buf_ref(struct ccnl_buf_s *buf)
+{
+    if (buf) {
+        buf->refcnt++;
+    }
+    return buf;
+}
+
+void
+ccnl_buf_free(struct ccnl_buf_s *buf)
+{
+    struct ccnl_bufpool_s *pool;
+
+    if (!buf || --buf->refcnt > 0) {
+        return;
+    }
+    pool = buf->pool;
+#ifdef CCNL_BUFPOOL_SHARED
+    if (pool && pool->shared) {
+        buf->next = __atomic_load_n(&pool->returned, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(&pool->returned, &buf->next, buf,
+                                            1, __ATOMIC_RELEASE,
+                                            __ATOMIC_RELAXED)) {
+        }
+        return;
+    }
+#endif
+    if (pool && pool->count < pool->max) {
+        buf->next = pool->free;
+        pool->free = buf;
+        pool->count++;
+        return;
+    }
+    ccnl_free(buf);
+}
+
+#ifdef CCNL_BUFPOOL_SHARED
+// moves the buffers given back to a shared pool to its free list
+static void
+ccnl_bufpool_collect(struct ccnl_bufpool_s *pool)
+{
+    struct ccnl_buf_s *b = __atomic_exchange_n(&pool->returned, NULL,
+                                               __ATOMIC_ACQUIRE);
+
+    while (b) {
+        struct ccnl_buf_s *next = b->next;
+
+        if (pool->count < pool->max) {
+            b->next = pool->free;
+            pool->free = b;
+            pool->count++;
+        } else {
+            ccnl_free(b);
+        }
+        b = next;
+    }
+}
+#endif
+
+struct ccnl_buf_s*
+ccnl_bufpool_get(struct ccnl_bufpool_s *pool)
+{
+    struct ccnl_buf_s *b;
+
+#ifdef CCNL_BUFPOOL_SHARED
+    if (!pool->free && pool->shared) {
+        ccnl_bufpool_collect(pool);
+    }
+#endif
+    b = pool->free;
+    if (b) {
+        pool->free = b->next;
+        pool->count--;
+    } else {
+        b = (struct ccnl_buf_s*) ccnl_malloc(sizeof(*b) + pool->bufsize);
+        if (!b) {
+            return NULL;
+        }
+        b->pool = pool;
+    }
+    b->next = NULL;
+    b->refcnt = 1;
+    b->datalen = pool->bufsize;
+    return b;
+}
+
+void
+ccnl_bufpool_drain(struct ccnl_bufpool_s *pool)
+{
+#ifdef CCNL_BUFPOOL_SHARED
+    ccnl_bufpool_collect(pool);
+#endif
+    while (pool->free) {
+        struct ccnl_buf_s *b = pool->free;
+        pool->free = b->next;
+        ccnl_free(b);
+    }
+    pool->count = 0;
+}
+
+uint32_t
+ccnl_buf_hash(const struct ccnl_buf_s *buf)
+{
+    uint32_t h = ccnl_hash_uint(CCNL_HASH_INIT, (uint32_t) buf->datalen);
+
+    if (buf->datalen <= 2 * CCNL_BUF_HASH_SPAN) {
+        return ccnl_hash_bytes(h, buf->data, buf->datalen);
+    }
+    h = ccnl_hash_bytes(h, buf->data, CCNL_BUF_HASH_SPAN);
+    return ccnl_hash_bytes(h, buf->data + buf->datalen - CCNL_BUF_HASH_SPAN,
+                           CCNL_BUF_HASH_SPAN);
+}
+
+// the receive buffer of the frame being processed, see ccnl_buf_offer()
+static CCNL_THREAD_LOCAL struct ccnl_buf_s *offered;
+
+struct ccnl_buf_s*
+ccnl_buf_offer(struct ccnl_buf_s *buf)
+{
+    struct ccnl_buf_s *old = offered;
+
+    offered = buf;
+    return old;
+}
+
+struct ccnl_buf_s*
+ccnl_buf_adopt(void *data, size_t len)
+{
+    struct ccnl_buf_s *b = offered;
+
+    if (!b || (unsigned char*) data != b->data || len != b->datalen) {
+        return ccnl_buf_new(data, len);
+    }
+    // a small packet would pin a large buffer in the PIT or the cache
+    if (b->pool && len < b->pool->bufsize / CCNL_BUF_ADOPT_SHARE) {
+        return ccnl_buf_new(data, len);
+    }
+    offered = NULL;
+    // the buffer keeps its pool, and its place: pointers into it stay valid
+    return b;
+}
+
 void
 ccnl_core_cleanup(struct ccnl_relay_s *ccnl)
 {
@@ -64,21 +209,37 @@ ccnl_core_cleanup(struct ccnl_relay_s *ccnl)
 
     while (ccnl->pit)
         ccnl_interest_remove(ccnl, ccnl->pit);
+    ccnl_htable_free(&ccnl->pit_index);
+    ccnl_htable_free(&ccnl->pit_names);
+    ccnl_htable_free(&ccnl->pit_digests);
+    ccnl_wheel_free(&ccnl->pit_wheel);
     while (ccnl->faces)
         ccnl_face_remove(ccnl, ccnl->faces); // removes allmost all FWD entries
+    ccnl_htable_free(&ccnl->face_index);
+    ccnl_htable_free(&ccnl->face_ids);
+    ccnl_wheel_free(&ccnl->face_wheel);
     while (ccnl->fib) {
-        struct ccnl_forward_s *fwd = ccnl->fib->next;
-        ccnl_prefix_free(ccnl->fib->prefix);
-        ccnl_free(ccnl->fib);
-        ccnl->fib = fwd;
+        struct ccnl_forward_s *fwd = ccnl->fib;
+        ccnl_fib_unlink(ccnl, fwd);
+        ccnl_prefix_free(fwd->prefix);
+        ccnl_free(fwd);
     }
+    ccnl_htable_free(&ccnl->fib_index);
     while (ccnl->contents)
         ccnl_content_remove(ccnl, ccnl->contents);
-    while (ccnl->nonces) {
-        struct ccnl_buf_s *tmp = ccnl->nonces->next;
-        ccnl_free(ccnl->nonces);
-        ccnl->nonces = tmp;
-    }
+    ccnl_htable_free(&ccnl->cs_index);
+    ccnl_wheel_free(&ccnl->cs_wheel);
+    ccnl_htable_free(&ccnl->nonce_index);
+    ccnl_free(ccnl->nonces);
+    ccnl->nonces = NULL;
+    ccnl->noncecnt = 0;
+    ccnl->noncesize = 0;
+    ccnl->nonce_first = 0;
     for (k = 0; k < ccnl->ifcount; k++)
         ccnl_interface_cleanup(ccnl->ifs + k);
+    while (ccnl->app_queue) {
+        struct ccnl_buf_s *buf = ccnl->app_queue;
+        ccnl->app_queue = buf->next;
+        ccnl_buf_free(buf);
+    }
 }
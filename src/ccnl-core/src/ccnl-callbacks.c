@@ -49,7 +49,7 @@ ccnl_callback_rx_on_data(struct ccnl_relay_s *relay,
                          struct ccnl_face_s *from,
                          struct ccnl_pkt_s *pkt)
 {
-    if (_cb_rx_on_data) {
+    if (_cb_rx_on_data && !ccnl_pkt_decode_rest(pkt)) {
         return _cb_rx_on_data(relay, from, pkt);
     }
 
@@ -61,9 +61,25 @@ ccnl_callback_tx_on_data(struct ccnl_relay_s *relay,
                          struct ccnl_face_s *to,
                          struct ccnl_pkt_s *pkt)
 {
-    if (_cb_tx_on_data) {
+    if (_cb_tx_on_data && !ccnl_pkt_decode_rest(pkt)) {
         return _cb_tx_on_data(relay, to, pkt);
     }
 
     return 0;
 }
+
+int
+ccnl_callback_app_rx(struct ccnl_relay_s *relay, struct ccnl_content_s *c)
+{
+    if (relay->app_rx && !ccnl_pkt_decode_rest(c->pkt)) {
+        int rc;
+
+        // what the application sends meanwhile waits, see ccnl_app_send
+        relay->app_busy++;
+        rc = relay->app_rx(relay, c);
+        relay->app_busy--;
+        return rc;
+    }
+
+    return 0;
+}
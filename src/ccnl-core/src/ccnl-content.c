@@ -60,6 +60,7 @@ ccnl_content_new(struct ccnl_pkt_s **pkt)
     c->pkt = *pkt;
     *pkt = NULL;
     c->last_used = CCNL_NOW();
+    c->created = c->last_used;
     c->flags = CCNL_CONTENT_FLAGS_NOT_STALE;
 
     return c;
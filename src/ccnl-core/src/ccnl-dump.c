@@ -165,9 +165,12 @@ ccnl_dump(int lev, int typ, void *p)
                     ccnl_dump(lev + 2, CCNL_FRAG, fac->frag);
                 CONSOLE("\n");
                 if (fac->outq) {
+                    struct ccnl_outq_s *q;
                     INDENT(lev + 1);
                     CONSOLE("outq:\n");
-                    ccnl_dump(lev + 2, CCNL_BUF, fac->outq);
+                    for (q = fac->outq; q; q = q->next) {
+                        ccnl_dump(lev + 2, CCNL_BUF, q->buf);
+                    }
                 }
                 fac = fac->next;
             }
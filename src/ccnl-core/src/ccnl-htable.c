@@ -0,0 +1,161 @@
+/*
+ * @f ccnl-htable.c
+ * @b CCN lite, intrusive hash table used to index the relay's tables
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * File history:
+ * 2018-09-03 created
+ */
+
+#ifndef CCNL_LINUXKERNEL
+#include "ccnl-htable.h"
+#include "ccnl-malloc.h"
+#else
+#include <ccnl-htable.h>
+#include <ccnl-malloc.h>
+#endif
+
+#define CCNL_FNV_PRIME              16777619u
+
+uint32_t
+ccnl_hash_bytes(uint32_t hash, const void *data, size_t len)
+{
+    const uint8_t *p = (const uint8_t *) data;
+
+    while (len--) {
+        hash ^= *p++;
+        hash *= CCNL_FNV_PRIME;
+    }
+    return hash;
+}
+
+uint32_t
+ccnl_hash_uint(uint32_t hash, uint32_t value)
+{
+    int i;
+
+    for (i = 0; i < 4; i++) {
+        hash ^= value & 0xff;
+        hash *= CCNL_FNV_PRIME;
+        value >>= 8;
+    }
+    return hash;
+}
+
+/* rehash all elements into a bucket array of the given size; on allocation
+   failure the table keeps its old buckets and just gets longer chains */
+static int
+ccnl_htable_resize(struct ccnl_htable_s *table, uint32_t size)
+{
+    struct ccnl_hlink_s **buckets, *l, *next;
+    uint32_t i;
+
+    buckets = (struct ccnl_hlink_s **) ccnl_calloc(size, sizeof(*buckets));
+    if (!buckets) {
+        return -1;
+    }
+    for (i = 0; i < table->size; i++) {
+        for (l = table->buckets[i]; l; l = next) {
+            next = l->next;
+            l->next = buckets[l->hash & (size - 1)];
+            buckets[l->hash & (size - 1)] = l;
+        }
+    }
+    ccnl_free(table->buckets);
+    table->buckets = buckets;
+    table->size = size;
+    return 0;
+}
+
+int
+ccnl_htable_add(struct ccnl_htable_s *table, struct ccnl_hlink_s *link,
+                uint32_t hash)
+{
+    struct ccnl_hlink_s **bucket;
+
+    if (!table->buckets) {
+        if (ccnl_htable_resize(table, CCNL_HTABLE_MIN_SIZE)) {
+            return -1;
+        }
+    } else if (table->count >= table->size && (table->size << 1)) {
+        ccnl_htable_resize(table, table->size << 1);
+    }
+
+    link->hash = hash;
+    bucket = table->buckets + (hash & (table->size - 1));
+    link->next = *bucket;
+    *bucket = link;
+    table->count++;
+    return 0;
+}
+
+int
+ccnl_htable_remove(struct ccnl_htable_s *table, struct ccnl_hlink_s *link)
+{
+    struct ccnl_hlink_s **pp;
+
+    if (!table->buckets) {
+        return -1;
+    }
+    for (pp = table->buckets + (link->hash & (table->size - 1)); *pp;
+         pp = &(*pp)->next) {
+        if (*pp == link) {
+            *pp = link->next;
+            link->next = NULL;
+            table->count--;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+struct ccnl_hlink_s*
+ccnl_htable_first(struct ccnl_htable_s *table, uint32_t hash)
+{
+    struct ccnl_hlink_s *l;
+
+    if (!table->buckets) {
+        return NULL;
+    }
+    for (l = table->buckets[hash & (table->size - 1)]; l; l = l->next) {
+        if (l->hash == hash) {
+            return l;
+        }
+    }
+    return NULL;
+}
+
+struct ccnl_hlink_s*
+ccnl_htable_next(struct ccnl_hlink_s *link)
+{
+    struct ccnl_hlink_s *l;
+
+    for (l = link->next; l; l = l->next) {
+        if (l->hash == link->hash) {
+            return l;
+        }
+    }
+    return NULL;
+}
+
+void
+ccnl_htable_free(struct ccnl_htable_s *table)
+{
+    ccnl_free(table->buckets);
+    table->buckets = NULL;
+    table->size = 0;
+    table->count = 0;
+}
@@ -83,48 +83,46 @@ ccnl_http_cleanup(struct ccnl_http_s *http)
 
 
 int
-ccnl_http_anteselect(struct ccnl_relay_s *ccnl, struct ccnl_http_s *http,
-                     fd_set *readfs, fd_set *writefs, int *maxfd)
+ccnl_http_wants(struct ccnl_http_s *http, int *rd, int *wr)
 {
-    (void) ccnl;
     if (!http)
         return -1;
     if (!http->client) {
-        FD_SET(http->server, readfs);
-        if (*maxfd <= http->server)
-            *maxfd = http->server + 1;
-    } else {
-        if ((unsigned long)http->inlen < sizeof(http->in))
-            FD_SET(http->client, readfs);
-        if (http->outlen > 0)
-            FD_SET(http->client, writefs);
-        if (*maxfd <= http->client)
-            *maxfd = http->client + 1;
+        *rd = 1;
+        *wr = 0;
+        return http->server;
     }
-    return 0;
+    *rd = (unsigned long)http->inlen < sizeof(http->in);
+    *wr = http->outlen > 0;
+    return http->client;
 }
 
 
 int
-ccnl_http_postselect(struct ccnl_relay_s *ccnl, struct ccnl_http_s *http,
-                     fd_set *readfs, fd_set *writefs)
+ccnl_http_io(struct ccnl_relay_s *ccnl, struct ccnl_http_s *http,
+             int fd, int rd, int wr)
 {
     if (!http)
         return -1;
     // accept only one client at the time:
-    if (!http->client && FD_ISSET(http->server, readfs)) {
-        struct sockaddr_in peer;
-        socklen_t len = sizeof(peer);
-        http->client = accept(http->server, (struct sockaddr*) &peer, &len);
-        if (http->client < 0)
-            http->client = 0;
-        else {
-            DEBUGMSG(INFO, "accepted web server client %s\n",
-                     ccnl_addr2ascii((sockunion*)&peer));
-            http->inlen = http->outlen = http->inoffs = http->outoffs = 0;
+    if (!http->client) {
+        if (fd == http->server && rd) {
+            struct sockaddr_in peer;
+            socklen_t len = sizeof(peer);
+            http->client = accept(http->server, (struct sockaddr*) &peer, &len);
+            if (http->client < 0)
+                http->client = 0;
+            else {
+                DEBUGMSG(INFO, "accepted web server client %s\n",
+                         ccnl_addr2ascii((sockunion*)&peer));
+                http->inlen = http->outlen = http->inoffs = http->outoffs = 0;
+            }
         }
+        return 0;
     }
-    if (http->client && FD_ISSET(http->client, readfs)) {
+    if (fd != http->client)
+        return 0;
+    if (rd) {
         int len = sizeof(http->in) - http->inlen - 1;
         len = recv(http->client, http->in + http->inlen, len, 0);
         if (len == 0) {
@@ -136,7 +134,7 @@ ccnl_http_postselect(struct ccnl_relay_s *ccnl, struct ccnl_http_s *http,
             ccnl_http_status(ccnl, http);
         }
     }
-    if (http->client && FD_ISSET(http->client, writefs) && http->out) {
+    if (http->client && wr && http->out) {
         int len = send(http->client, http->out + http->outoffs,
                        http->outlen, 0);
         if (len > 0) {
@@ -151,6 +149,40 @@ ccnl_http_postselect(struct ccnl_relay_s *ccnl, struct ccnl_http_s *http,
     return 0;
 }
 
+
+int
+ccnl_http_anteselect(struct ccnl_relay_s *ccnl, struct ccnl_http_s *http,
+                     fd_set *readfs, fd_set *writefs, int *maxfd)
+{
+    int fd, rd, wr;
+    (void) ccnl;
+
+    fd = ccnl_http_wants(http, &rd, &wr);
+    if (fd < 0)
+        return -1;
+    if (rd)
+        FD_SET(fd, readfs);
+    if (wr)
+        FD_SET(fd, writefs);
+    if (*maxfd <= fd)
+        *maxfd = fd + 1;
+    return 0;
+}
+
+
+int
+ccnl_http_postselect(struct ccnl_relay_s *ccnl, struct ccnl_http_s *http,
+                     fd_set *readfs, fd_set *writefs)
+{
+    int fd;
+
+    if (!http)
+        return -1;
+    fd = http->client ? http->client : http->server;
+    return ccnl_http_io(ccnl, http, fd, FD_ISSET(fd, readfs),
+                        FD_ISSET(fd, writefs));
+}
+
 int
 ccnl_cmpfaceid(const void *a, const void *b)
 {
@@ -201,13 +233,12 @@ ccnl_http_status(struct ccnl_relay_s *ccnl, struct ccnl_http_s *http)
         "Content-Type: text/html; charset=utf-8\n\r"
         "Connection: close\n\r\n\r", *cp;
     size_t len = strlen(hdr);
-    int i, j, cnt;
+    int i, cnt;
     time_t t;
     //struct utsname uts;
     struct ccnl_face_s *f;
     struct ccnl_forward_s *fwd;
     struct ccnl_interest_s *ipt;
-    struct ccnl_buf_s *bpt;
     char s[CCNL_MAX_PREFIX_SIZE];
 
     strcpy(txt, hdr);
@@ -279,8 +310,12 @@ ccnl_http_status(struct ccnl_relay_s *ccnl, struct ccnl_http_s *http)
             else
                 len += sprintf(txt+len, "%.1fsec",
                         fa[i]->last_used + CCNL_FACE_TIMEOUT - CCNL_NOW());
-            for (j = 0, bpt = fa[i]->outq; bpt; bpt = bpt->next, j++);
-            len += sprintf(txt+len, " &nbsp;qlen=%d\n", j);
+            len += sprintf(txt+len, " &nbsp;qlen=%u",
+                           (unsigned) fa[i]->outq_index.count);
+#ifdef USE_STATS
+            len += sprintf(txt+len, " &nbsp;dups=%u", fa[i]->outq_dups);
+#endif
+            len += sprintf(txt+len, "\n");
         }
         ccnl_free(fa);
     }
@@ -294,10 +329,14 @@ ccnl_http_status(struct ccnl_relay_s *ccnl, struct ccnl_http_s *http)
                        "addr=<font face=courier>%s</font>&nbsp;&nbsp;"
                        "qlen=%zu/%d"
                        "&nbsp;&nbsp;rx=%u&nbsp;&nbsp;tx=%u"
+                       "&nbsp;&nbsp;rxbatch=%.1f"
                        "\n",
                        i, ccnl_addr2ascii(&ccnl->ifs[i].addr),
                        ccnl->ifs[i].qlen, CCNL_MAX_IF_QLEN,
-                       ccnl->ifs[i].rx_cnt, ccnl->ifs[i].tx_cnt);
+                       ccnl->ifs[i].rx_cnt, ccnl->ifs[i].tx_cnt,
+                       ccnl->ifs[i].rx_batches ?
+                           (double) ccnl->ifs[i].rx_batched /
+                           ccnl->ifs[i].rx_batches : 0.0);
 #else
         len += sprintf(txt+len, "<li><strong>i%d</strong>&nbsp;&nbsp;"
                        "addr=<font face=courier>%s</font>&nbsp;&nbsp;"
@@ -311,8 +350,7 @@ ccnl_http_status(struct ccnl_relay_s *ccnl, struct ccnl_http_s *http)
 
     len += sprintf(txt+len, "\n<p><table borders=0 width=100%% bgcolor=#e0e0ff>"
                    "<tr><td><em>Misc stats</em></table><ul>\n");
-    for (cnt = 0, bpt = ccnl->nonces; bpt; bpt = bpt->next, cnt++);
-    len += sprintf(txt+len, "<li>Nonces: %d\n", cnt);
+    len += sprintf(txt+len, "<li>Nonces: %d\n", ccnl->noncecnt);
     for (cnt = 0, ipt = ccnl->pit; ipt; ipt = ipt->next, cnt++);
     len += sprintf(txt+len, "<li>Pending interests: %d\n", cnt);
     len += sprintf(txt+len, "<li>Content chunks: %d (max=%d)\n",
@@ -327,10 +365,17 @@ ccnl_http_status(struct ccnl_relay_s *ccnl, struct ccnl_http_s *http)
                    "<td align=right> %d<td>\n", CCNL_FACE_TIMEOUT);
     len += sprintf(txt+len, "<tr><td>interest.maxretransmit:"
                    "<td align=right> %d<td>\n", CCNL_MAX_INTEREST_RETRANSMIT);
+    len += sprintf(txt+len, "<tr><td>interest.retransperiod:"
+                   "<td align=right> %d<td>\n", ccnl->retrans_period > 0 ?
+                   ccnl->retrans_period : CCNL_INTEREST_RETRANS_PERIOD);
     len += sprintf(txt+len, "<tr><td>interest.timeout:"
                    "<td align=right> %d<td>\n", CCNL_INTEREST_TIMEOUT);
     len += sprintf(txt+len, "<tr><td>nonces.max:"
-                   "<td align=right> %d<td>\n", CCNL_MAX_NONCES);
+                   "<td align=right> %d<td>\n", ccnl->max_nonces > 0 ?
+                   ccnl->max_nonces : CCNL_MAX_NONCES);
+    len += sprintf(txt+len, "<tr><td>nonces.timeout:"
+                   "<td align=right> %d<td>\n", ccnl->nonce_window > 0 ?
+                   ccnl->nonce_window : CCNL_NONCE_TIMEOUT);
 
     //len += sprintf(txt+len, "<tr><td>compile.featureset:<td><td> %s\n",
     //               compile_string);
@@ -23,6 +23,7 @@
 
 #ifndef CCNL_LINUXKERNEL
 #include "ccnl-if.h"
+#include "ccnl-buf.h"
 #include "ccnl-os-time.h"
 #include "ccnl-malloc.h"
 #include "ccnl-logging.h"
@@ -35,6 +36,7 @@
 #include <unistd.h>
 #else
 #include <ccnl-if.h>
+#include <ccnl-buf.h>
 #include <ccnl-os-time.h>
 #include <ccnl-malloc.h>
 #include <ccnl-logging.h>
@@ -49,7 +51,7 @@ ccnl_interface_cleanup(struct ccnl_if_s *i)
     ccnl_sched_destroy(i->sched);
     for (j = 0; j < i->qlen; j++) {
         struct ccnl_txrequest_s *r = i->queue + (i->qfront+j)%CCNL_MAX_IF_QLEN;
-        ccnl_free(r->buf);
+        ccnl_buf_free(r->buf);
     }
 #if !defined(CCNL_RIOT) && !defined(CCNL_ANDROID) && !defined(CCNL_LINUXKERNEL)
     ccnl_close_socket(i->sock);
@@ -43,11 +43,62 @@
 #include "ccn-lite-riot.h"
 #endif
 
+/* the PIT index key: everything ccnl_interest_isSame compares */
+static uint32_t
+ccnl_interest_hash(struct ccnl_pkt_s *pkt)
+{
+    uint32_t h = ccnl_prefix_hash(pkt->pfx, pkt->pfx->compcnt);
+    struct ccnl_buf_s *key = NULL;
+
+    if (pkt->pfx->chunknum) {
+        h = ccnl_hash_uint(h, *pkt->pfx->chunknum);
+    }
+    switch (pkt->pfx->suite) {
+#ifdef USE_SUITE_CCNB
+        case CCNL_SUITE_CCNB:
+            h = ccnl_hash_uint(h, (uint32_t) pkt->s.ccnb.minsuffix);
+            h = ccnl_hash_uint(h, (uint32_t) pkt->s.ccnb.maxsuffix);
+            key = pkt->s.ccnb.ppkd;
+            break;
+#endif
+#ifdef USE_SUITE_NDNTLV
+        case CCNL_SUITE_NDNTLV:
+            h = ccnl_hash_uint(h, (uint32_t) pkt->s.ndntlv.minsuffix);
+            h = ccnl_hash_uint(h, (uint32_t) pkt->s.ndntlv.maxsuffix);
+            key = pkt->s.ndntlv.ppkl;
+            break;
+#endif
+        default:
+            break;
+    }
+    if (key) {
+        h = ccnl_hash_bytes(h, key->data, key->datalen);
+    }
+    return h;
+}
+
+struct ccnl_interest_s*
+ccnl_interest_find(struct ccnl_relay_s *ccnl, struct ccnl_pkt_s *pkt)
+{
+    struct ccnl_hlink_s *l;
+
+    for (l = ccnl_htable_first(&ccnl->pit_index, ccnl_interest_hash(pkt)); l;
+         l = ccnl_htable_next(l)) {
+        struct ccnl_interest_s *i = CCNL_HTABLE_ENTRY(l, struct ccnl_interest_s,
+                                                      hlink);
+        if (ccnl_interest_isSame(i, pkt)) {
+            return i;
+        }
+    }
+    return NULL;
+}
+
 struct ccnl_interest_s*
 ccnl_interest_new(struct ccnl_relay_s *ccnl, struct ccnl_face_s *from,
                   struct ccnl_pkt_s **pkt)
 {
     char s[CCNL_MAX_PREFIX_SIZE];
+    uint32_t n;
     (void) s;
 
     struct ccnl_interest_s *i = (struct ccnl_interest_s *) ccnl_calloc(1,
@@ -67,22 +118,71 @@ ccnl_interest_new(struct ccnl_relay_s *ccnl, struct ccnl_face_s *from,
     i->from = from;
     i->last_used = CCNL_NOW();
 
-    if (ccnl->pitcnt >= ccnl->max_pit_entries) {
-        ccnl_pkt_free(i->pkt);
-        ccnl_free(i);
-        return NULL;
+    if ((ccnl->max_pit_entries >= 0 && ccnl->pitcnt >= ccnl->max_pit_entries) ||
+        i->pkt->pfx->compcnt > CCNL_MAX_NAME_COMP) {
+        goto Bail;
+    }
+    if (ccnl_htable_add(&ccnl->pit_index, &i->hlink, ccnl_interest_hash(i->pkt))) {
+        goto Bail;
+    }
+    if (ccnl_htable_add(&ccnl->pit_names, &i->nlink,
+                ccnl_prefix_hash(i->pkt->pfx, i->pkt->pfx->compcnt))) {
+        ccnl_htable_remove(&ccnl->pit_index, &i->hlink);
+        goto Bail;
     }
+    n = i->pkt->pfx->compcnt;
+    if (n > 0 && i->pkt->pfx->complen[n - 1] == CCNL_CCNX_DIGEST_LEN &&
+        ccnl_htable_add(&ccnl->pit_digests, &i->dlink,
+                        ccnl_prefix_hash(i->pkt->pfx, n - 1))) {
+        ccnl_htable_remove(&ccnl->pit_names, &i->nlink);
+        ccnl_htable_remove(&ccnl->pit_index, &i->hlink);
+        goto Bail;
+    }
+    ccnl->pit_lencnt[n]++;
+    ccnl_wheel_schedule(&ccnl->pit_wheel, &i->wlink,
+                        ccnl_interest_deadline(i, i->last_used,
+                            (uint32_t) (ccnl->retrans_period > 0 ?
+                            ccnl->retrans_period : CCNL_INTEREST_RETRANS_PERIOD)));
 
     DBL_LINKED_LIST_ADD(ccnl->pit, i);
 
     ccnl->pitcnt++;
 
+    if (from) {
+        i->from_next = from->origins;
+        if (from->origins) {
+            from->origins->from_pprev = &i->from_next;
+        }
+        from->origins = i;
+        i->from_pprev = &from->origins;
+    }
+
 #ifdef CCNL_RIOT
     ccnl_evtimer_reset_interest_retrans(i);
     ccnl_evtimer_reset_interest_timeout(i);
 #endif
 
     return i;
+
+Bail:
+    ccnl_pkt_free(i->pkt);
+    ccnl_free(i);
+    return NULL;
+}
+
+uint32_t
+ccnl_interest_deadline(struct ccnl_interest_s *i, uint32_t now,
+                       uint32_t period)
+{
+    // the name hash and the retry count pick the interest's share of the
+    // spread, within the second half of the period
+    uint32_t spread = (i->hlink.hash + (uint32_t) i->retries) % (period / 2 + 1);
+    uint32_t deadline = now + period - spread;
+
+    if ((int32_t) (i->last_used + i->lifetime - deadline) < 0) {
+        deadline = i->last_used + i->lifetime;
+    }
+    return deadline;
 }
 
 int
@@ -151,11 +251,17 @@ ccnl_interest_append_pending(struct ccnl_interest_s *i,  struct ccnl_face_s *fro
                             (void *) pi, ccnl_prefix_to_str(i->pkt->pfx,s,CCNL_MAX_PREFIX_SIZE),
                             (void *) i->pkt->pfx);
             pi->face = from;
+            pi->interest = i;
             pi->last_used = CCNL_NOW();
             if (last)
                     last->next = pi;
             else
                     i->pending = pi;
+            pi->face_next = from->pendints;
+            if (from->pendints)
+                    from->pendints->face_pprev = &pi->face_next;
+            from->pendints = pi;
+            pi->face_pprev = &from->pendints;
             return 0;
         }
 
@@ -178,31 +284,21 @@ ccnl_interest_remove_pending(struct ccnl_interest_s *interest, struct ccnl_face_
             char s[CCNL_MAX_PREFIX_SIZE];
             result = 0;
 
-            struct ccnl_pendint_s *prev = NULL;
             struct ccnl_pendint_s *pend = interest->pending; 
             
             DEBUGMSG_CORE(TRACE, "ccnl_interest_remove_pending\n"); 
             
-            while (pend) {  // TODO: is this really the most elegant solution?
+            while (pend) {
+                struct ccnl_pendint_s *next = pend->next;
                 if (face->faceid == pend->face->faceid) { 
                     DEBUGMSG_CFWD(INFO, "  removed face (%s) for interest %s\n",
                         ccnl_addr2ascii(&pend->face->peer), 
                         ccnl_prefix_to_str(interest->pkt->pfx,s,CCNL_MAX_PREFIX_SIZE)); 
                     
                     result++; 
-                    if (prev) { 
-                        prev->next = pend->next;
-                        ccnl_free(pend);
-                        pend = prev->next;
-                    } else {
-                        interest->pending = pend->next;
-                        ccnl_free(pend);
-                        pend = interest->pending;
-                    }
-                } else {
-                    prev = pend;
-                    pend = pend->next; 
+                    ccnl_pendint_free(pend);
                 }
+                pend = next;
             }
             return result;
         }
@@ -214,3 +310,25 @@ ccnl_interest_remove_pending(struct ccnl_interest_s *interest, struct ccnl_face_
     /** interest was NULL */
     return result;
 }
+
+void
+ccnl_pendint_free(struct ccnl_pendint_s *pi)
+{
+    struct ccnl_pendint_s **pp;
+
+    if (pi->interest) {
+        for (pp = &pi->interest->pending; *pp; pp = &(*pp)->next) {
+            if (*pp == pi) {
+                *pp = pi->next;
+                break;
+            }
+        }
+    }
+    if (pi->face_pprev) {
+        *pi->face_pprev = pi->face_next;
+        if (pi->face_next) {
+            pi->face_next->face_pprev = pi->face_pprev;
+        }
+    }
+    ccnl_free(pi);
+}
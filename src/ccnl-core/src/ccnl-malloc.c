@@ -26,6 +26,18 @@
 
 #ifdef USE_DEBUG_MALLOC
 
+#ifdef CCNL_UNIX
+#include <pthread.h>
+
+// forwarding threads (see ccnl-shard.h) share the list of allocated blocks
+static pthread_mutex_t mem_lock = PTHREAD_MUTEX_INITIALIZER;
+#  define MEM_LOCK()    pthread_mutex_lock(&mem_lock)
+#  define MEM_UNLOCK()  pthread_mutex_unlock(&mem_lock)
+#else
+#  define MEM_LOCK()    do {} while (0)
+#  define MEM_UNLOCK()  do {} while (0)
+#endif
+
 #ifdef CCNL_ARDUINO
 void* debug_malloc(size_t s, const char *fn, int lno, double tstamp)
 #else
@@ -45,8 +57,10 @@ void* debug_malloc(size_t s, const char *fn, int lno, char *tstamp)
             return NULL;
         }
 
+        MEM_LOCK();
         h->next = mem;
         mem = h;
+        MEM_UNLOCK();
         h->fname = (char *) fn;
         h->lineno = lno;
         h->size = s;
@@ -122,14 +136,17 @@ debug_unlink(struct mhdr *hdr)
 {
     struct mhdr **pp = &mem;
 
+    MEM_LOCK();
     for (pp = &mem; pp; pp = &((*pp)->next)) {
         if (*pp == hdr) {
             *pp = hdr->next;
+            MEM_UNLOCK();
             return 0;
         }
     if (!(*pp)->next)
             break;
     }
+    MEM_UNLOCK();
     return 1;
 }
 
@@ -168,13 +185,16 @@ debug_realloc(void *p, size_t s, const char *fn, int lno)
         if (!h) {
             return NULL;
         }
+        memset(h, 0, sizeof(struct mhdr)); // no timestamp for debug_free
     }
 
     h->fname = (char *) fn;
     h->lineno = lno;
     h->size = s;
+    MEM_LOCK();
     h->next = mem;
     mem = h;
+    MEM_UNLOCK();
     return ((unsigned char *)h) + sizeof(struct mhdr);
 }
 
@@ -1252,6 +1252,23 @@ Bail:
     return rc;
 }
 
+#if defined(USE_IPV4) || defined(USE_IPV6)
+/* the interface which reaches peers of family af over connections of their
+   own, for faces asked for with protocol 6 (TCP); -1 if there is none */
+static int
+ccnl_mgmt_stream_if(struct ccnl_relay_s *ccnl, int af)
+{
+    int i;
+
+    for (i = 0; i < ccnl->ifcount; i++) {
+        if (ccnl->ifs[i].stream && ccnl->ifs[i].addr.sa.sa_family == af) {
+            return i;
+        }
+    }
+    return -1;
+}
+#endif
+
 int8_t
 ccnl_mgmt_newface(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
                 struct ccnl_prefix_s *prefix, struct ccnl_face_s *from)
@@ -1354,10 +1371,15 @@ ccnl_mgmt_newface(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
     } else
 #endif
 #endif
-    if ( (proto && host && port && !strcmp("17", (const char*) proto)) ||
+    if ( (proto && host && port && (!strcmp("17", (const char*) proto) ||
+                                     !strcmp("6", (const char*) proto))) ||
                     (wpanaddr && wpanpanid) ) {
         sockunion su;
         unsigned long lport;
+        int tcp = proto && !strcmp("6", (const char*) proto);
+        int ifndx = -1; // by UDP, the interface is found for the address
+        (void) tcp;
+        (void) ifndx;
         errno = 0;
         lport = strtoul((const char*) port, NULL, 0);
         if (errno != 0 || lport > UINT16_MAX) {
@@ -1375,7 +1397,10 @@ ccnl_mgmt_newface(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
     #endif
             su.ip4.sin_port = htons((uint16_t) lport);
             // not implmented yet: honor the requested ip4src parameter
-            f = ccnl_get_face_or_create(ccnl, -1, // from->ifndx,
+            if (tcp && (ifndx = ccnl_mgmt_stream_if(ccnl, AF_INET)) < 0) {
+                goto SoftBail;
+            }
+            f = ccnl_get_face_or_create(ccnl, ifndx, // from->ifndx,
                                         &su.sa, sizeof(struct sockaddr_in));
         }
 #endif
@@ -1387,7 +1412,10 @@ ccnl_mgmt_newface(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
             su.sa.sa_family = AF_INET6;
             inet_pton(AF_INET6, (const char*)host, &su.ip6.sin6_addr.s6_addr);
             su.ip6.sin6_port = htons((uint16_t) lport);
-            f = ccnl_get_face_or_create(ccnl, -1, // from->ifndx,
+            if (tcp && (ifndx = ccnl_mgmt_stream_if(ccnl, AF_INET6)) < 0) {
+                goto SoftBail;
+            }
+            f = ccnl_get_face_or_create(ccnl, ifndx, // from->ifndx,
                                         &su.sa, sizeof(struct sockaddr_in6));
         }
 #endif //CCNL_LINUXKERNEL
@@ -1507,7 +1535,7 @@ SoftBail:
         if (ccnl_ccnb_mkStrBlob(faceinst_buf+len3, faceinst_buf + FACEINST_BUF_SIZE, CCNL_DTAG_IP4SRC, CCN_TT_DTAG, (char*) ip4src, &len3)) {
             goto Bail;
         }
-        if (ccnl_ccnb_mkStrBlob(faceinst_buf+len3, faceinst_buf + FACEINST_BUF_SIZE, CCN_DTAG_IPPROTO, CCN_TT_DTAG, "17", &len3)) {
+        if (ccnl_ccnb_mkStrBlob(faceinst_buf+len3, faceinst_buf + FACEINST_BUF_SIZE, CCN_DTAG_IPPROTO, CCN_TT_DTAG, proto ? (char*) proto : "17", &len3)) {
             goto Bail;
         }
     }
@@ -1515,7 +1543,7 @@ SoftBail:
         if (ccnl_ccnb_mkStrBlob(faceinst_buf+len3, faceinst_buf + FACEINST_BUF_SIZE, CCNL_DTAG_IP6SRC, CCN_TT_DTAG, (char*) ip6src, &len3)) {
             goto Bail;
         }
-        if (ccnl_ccnb_mkStrBlob(faceinst_buf+len3, faceinst_buf + FACEINST_BUF_SIZE, CCN_DTAG_IPPROTO, CCN_TT_DTAG, "17", &len3)) {
+        if (ccnl_ccnb_mkStrBlob(faceinst_buf+len3, faceinst_buf + FACEINST_BUF_SIZE, CCN_DTAG_IPPROTO, CCN_TT_DTAG, proto ? (char*) proto : "17", &len3)) {
             goto Bail;
         }
     }
@@ -1650,7 +1678,7 @@ ccnl_mgmt_setfrag(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
         long lmtu = 0;
         (void) lmtu;
 
-        for (f = ccnl->faces; f && f->faceid != fi; f = f->next);
+        f = fi == (int) fi ? ccnl_face_find(ccnl, (int) fi) : NULL;
         if (!f) {
             goto Error;
         }
@@ -1822,7 +1850,7 @@ ccnl_mgmt_destroyface(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
             goto SoftBail;
         }
         fi = (int) lfi;
-        for (f = ccnl->faces; f && f->faceid != fi; f = f->next);
+        f = ccnl_face_find(ccnl, fi);
         if (!f) {
             DEBUGMSG(TRACE, "  could not find face=%s\n", faceid);
             goto SoftBail;
@@ -2560,7 +2588,6 @@ ccnl_mgmt_prefixreg(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
     // should (re)verify that action=="prefixreg"
     if (faceid && p->compcnt > 0) {
         struct ccnl_face_s *f = NULL;
-        struct ccnl_forward_s **fwd2 = NULL;
         long faceid_l;
 
         errno = 0;
@@ -2576,7 +2603,7 @@ ccnl_mgmt_prefixreg(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
         DEBUGMSG(TRACE, "mgmt: adding prefix %s to faceid=%s, suite=%s\n",
                  ccnl_prefix_to_str(p,s,CCNL_MAX_PREFIX_SIZE), faceid, ccnl_suite2str(suite[0]));
 
-        for (f = ccnl->faces; f && f->faceid != fi; f = f->next);
+        f = ccnl_face_find(ccnl, fi);
         if (!f) {
             goto SoftBail;
         }
@@ -2592,11 +2619,13 @@ ccnl_mgmt_prefixreg(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *orig,
             fwd->suite = suite[0];
         }
 
-        fwd2 = &ccnl->fib;
-        while (*fwd2) {
-            fwd2 = &((*fwd2)->next);
+        if (ccnl_fib_link(ccnl, fwd)) {
+            ccnl_prefix_free(fwd->prefix);
+            ccnl_free(fwd);
+            fwd = NULL;
+            goto SoftBail;
         }
-        *fwd2 = fwd;
+        fwd = NULL; // now owned by the FIB
         cp = "prefixreg cmd worked";
     } else {
         DEBUGMSG(TRACE, "mgmt: ignored prefixreg faceid=%s\n", faceid);
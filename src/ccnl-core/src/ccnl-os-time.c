@@ -23,18 +23,20 @@
 #ifndef CCNL_LINUXKERNEL
 #include "ccnl-os-time.h"
 #include "ccnl-malloc.h"
+#include "ccnl-defs.h"
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
 #else
 #include <ccnl-os-time.h>
 #include <ccnl-malloc.h>
+#include <ccnl-defs.h>
 #endif
 
 
 
 
-struct ccnl_timer_s *eventqueue;
+struct ccnl_timer_s *eventqueue; // the timer which expires next, NULL if none
 
 
 #if defined(CCNL_RIOT) && !(defined(__FreeBSD__) || defined(__APPLE__) || defined(__linux__))
@@ -98,7 +100,7 @@ current_time(void)
 char*
 timestamp(void)
 {
-    static char ts[16], *cp;
+    static CCNL_THREAD_LOCAL char ts[16], *cp;
 
     sprintf(ts, "%.4g", CCNL_NOW());
     cp = strchr(ts, '.');
@@ -129,14 +131,165 @@ ccnl_get_timeval(struct timeval *tv)
     gettimeofday(tv, NULL);
 }
 
+// pending timers are kept in a 4-ary min-heap, ordered by their timeout
+// and (for equal timeouts) the order in which they were set
+#define CCNL_TIMER_ARITY        4
+
+static struct ccnl_timer_s **timer_heap;
+static int timer_cnt, timer_max;
+static struct ccnl_timer_s *timer_pool; // unused timers, linked by next
+static uint32_t timer_seq;
+
+// a handle is a timer's index and its generation: the pool hands out the
+// most recently used timer first, the generation tells a handle which
+// outlived its timer from the handle of the timer's next use
+#define CCNL_TIMER_IDX_BITS     (sizeof(uintptr_t) * 4)
+#define CCNL_TIMER_IDX_MAX      (((uintptr_t) 1 << CCNL_TIMER_IDX_BITS) - 1)
+
+static struct ccnl_timer_s **timer_all; // all timers, by idx
+static uint32_t timer_all_cnt, timer_all_max;
+
+static void*
+ccnl_timer_handle(struct ccnl_timer_s *t)
+{
+    return (void *) ((t->gen << CCNL_TIMER_IDX_BITS) | (t->idx + 1));
+}
+
+static int
+ccnl_timer_before(struct ccnl_timer_s *a, struct ccnl_timer_s *b)
+{
+    if (a->timeout.tv_sec != b->timeout.tv_sec)
+        return a->timeout.tv_sec < b->timeout.tv_sec;
+    if (a->timeout.tv_usec != b->timeout.tv_usec)
+        return a->timeout.tv_usec < b->timeout.tv_usec;
+    return (int32_t) (a->seq - b->seq) < 0;
+}
+
+static void
+ccnl_timer_place(struct ccnl_timer_s *t, int pos)
+{
+    timer_heap[pos] = t;
+    t->heapidx = pos;
+}
+
+static void
+ccnl_timer_sift(int pos)
+{
+    struct ccnl_timer_s *t = timer_heap[pos];
+    int parent, child, c, last;
+
+    while (pos > 0) {
+        parent = (pos - 1) / CCNL_TIMER_ARITY;
+        if (!ccnl_timer_before(t, timer_heap[parent]))
+            break;
+        ccnl_timer_place(timer_heap[parent], pos);
+        pos = parent;
+    }
+    for (;;) {
+        child = pos * CCNL_TIMER_ARITY + 1;
+        if (child >= timer_cnt)
+            break;
+        last = child + CCNL_TIMER_ARITY < timer_cnt ?
+                                child + CCNL_TIMER_ARITY : timer_cnt;
+        for (c = child + 1; c < last; c++)
+            if (ccnl_timer_before(timer_heap[c], timer_heap[child]))
+                child = c;
+        if (!ccnl_timer_before(timer_heap[child], t))
+            break;
+        ccnl_timer_place(timer_heap[child], pos);
+        pos = child;
+    }
+    ccnl_timer_place(t, pos);
+}
+
+static struct ccnl_timer_s*
+ccnl_timer_new(void)
+{
+    struct ccnl_timer_s *t = timer_pool;
+    uint32_t idx;
+    uintptr_t gen;
+
+    if (t) {
+        timer_pool = t->next;
+        idx = t->idx;
+        gen = t->gen;
+    } else {
+        if (timer_all_cnt == timer_all_max) {
+            uintptr_t max = timer_all_max ? 2 * (uintptr_t) timer_all_max : 16;
+            struct ccnl_timer_s **all;
+
+            if (max > CCNL_TIMER_IDX_MAX)
+                return NULL;
+            all = (struct ccnl_timer_s **)
+                    ccnl_realloc(timer_all, max * sizeof(*all));
+            if (!all)
+                return NULL;
+            timer_all = all;
+            timer_all_max = (uint32_t) max;
+        }
+        if (!(t = (struct ccnl_timer_s *) ccnl_malloc(sizeof(*t))))
+            return NULL;
+        idx = timer_all_cnt;
+        gen = 0;
+        timer_all[timer_all_cnt++] = t;
+    }
+    memset(t, 0, sizeof(*t));
+    t->heapidx = -1;
+    t->idx = idx;
+    t->gen = gen;
+    return t;
+}
+
+static void
+ccnl_timer_release(struct ccnl_timer_s *t)
+{
+    t->heapidx = -1;
+    t->gen++;
+    t->next = timer_pool;
+    timer_pool = t;
+}
+
+static void*
+ccnl_timer_enqueue(struct ccnl_timer_s *t)
+{
+    if (timer_cnt == timer_max) {
+        int max = timer_max ? 2 * timer_max : 16;
+        struct ccnl_timer_s **heap = (struct ccnl_timer_s **)
+                ccnl_realloc(timer_heap, max * sizeof(*heap));
+        if (!heap) {
+            ccnl_timer_release(t);
+            return NULL;
+        }
+        timer_heap = heap;
+        timer_max = max;
+    }
+    t->seq = timer_seq++;
+    ccnl_timer_place(t, timer_cnt++);
+    ccnl_timer_sift(t->heapidx);
+    eventqueue = timer_heap[0];
+    return ccnl_timer_handle(t);
+}
+
+static void
+ccnl_timer_dequeue(struct ccnl_timer_s *t)
+{
+    int pos = t->heapidx;
+
+    t->heapidx = -1;
+    if (pos != --timer_cnt) {
+        ccnl_timer_place(timer_heap[timer_cnt], pos);
+        ccnl_timer_sift(pos);
+    }
+    eventqueue = timer_cnt ? timer_heap[0] : NULL;
+}
+
 void*
 ccnl_set_timer(uint64_t usec, void (*fct)(void *aux1, void *aux2),
                  void *aux1, void *aux2)
 {
-    struct ccnl_timer_s *t, **pp;
-    //    static int handlercnt;
+    struct ccnl_timer_s *t;
 
-    t = (struct ccnl_timer_s *) ccnl_calloc(1, sizeof(*t));
+    t = ccnl_timer_new();
     if (!t)
         return 0;
     t->fct2 = fct;
@@ -147,32 +300,53 @@ ccnl_set_timer(uint64_t usec, void (*fct)(void *aux1, void *aux2),
     t->aux1 = aux1;
     t->aux2 = aux2;
 
-    for (pp = &eventqueue; ; pp = &((*pp)->next)) {
-    if (!*pp || (*pp)->timeout.tv_sec > t->timeout.tv_sec ||
-        ((*pp)->timeout.tv_sec == t->timeout.tv_sec &&
-         (*pp)->timeout.tv_usec > t->timeout.tv_usec)) {
-        t->next = *pp;
-        //        t->handler = handlercnt++;
-        *pp = t;
-        return t;
-    }
-    }
-    return NULL; // ?
+    return ccnl_timer_enqueue(t);
 }
 
 void
 ccnl_rem_timer(void *h)
 {
-    struct ccnl_timer_s **pp;
+    uintptr_t idx = ((uintptr_t) h & CCNL_TIMER_IDX_MAX) - 1;
+    struct ccnl_timer_s *t;
 
-    for (pp = &eventqueue; *pp; pp = &((*pp)->next)) {
-        if ((void*)*pp == h) {
-            struct ccnl_timer_s *e = *pp;
-            *pp = e->next;
-            ccnl_free(e);
-            break;
-        }
+    // handles of expired or removed timers are ignored
+    if (!h || idx >= timer_all_cnt)
+        return;
+    t = timer_all[idx];
+    if (ccnl_timer_handle(t) != h || t->heapidx < 0)
+        return;
+    ccnl_timer_dequeue(t);
+    ccnl_timer_release(t);
+}
+
+void
+ccnl_timer_cleanup(void)
+{
+    uint32_t k;
+
+    while (eventqueue) {
+        struct ccnl_timer_s *t = eventqueue;
+        ccnl_timer_dequeue(t);
+        ccnl_timer_release(t);
     }
+    for (k = 0; k < timer_all_cnt; k++)
+        ccnl_free(timer_all[k]);
+    ccnl_free(timer_all);
+    timer_all = NULL;
+    timer_all_cnt = timer_all_max = 0;
+    timer_pool = NULL;
+    ccnl_free(timer_heap);
+    timer_heap = NULL;
+    timer_max = 0;
+}
+
+int
+ccnl_timer_next(struct timeval *tv)
+{
+    if (!eventqueue)
+        return -1;
+    *tv = eventqueue->timeout;
+    return 0;
 }
 
 #endif
@@ -264,12 +438,13 @@ ccnl_run_events(void)
         if (usec >= 0)
             return usec;
 
+        // the callback may set new timers or remove (other) pending ones
+        ccnl_timer_dequeue(t);
         if (t->fct)
             (t->fct)(t->node, t->intarg);
         else if (t->fct2)
             (t->fct2)(t->aux1, t->aux2);
-        eventqueue = t->next;
-        ccnl_free(t);
+        ccnl_timer_release(t);
     }
 
     return -1;
@@ -285,28 +460,17 @@ void*
 ccnl_set_absolute_timer(struct timeval abstime, void (*fct)(void *aux1, void *aux2),
          void *aux1, void *aux2)
 {
-    struct ccnl_timer_s *t, **pp;
-    //    static int handlercnt;
+    struct ccnl_timer_s *t;
 
-    t = (struct ccnl_timer_s *) ccnl_calloc(1, sizeof(*t));
+    t = ccnl_timer_new();
     if (!t)
-    return 0;
+        return 0;
     t->fct2 = fct;
     t->timeout = abstime;
     t->aux1 = aux1;
     t->aux2 = aux2;
 
-    for (pp = &eventqueue; ; pp = &((*pp)->next)) {
-    if (!*pp || (*pp)->timeout.tv_sec > t->timeout.tv_sec ||
-        ((*pp)->timeout.tv_sec == t->timeout.tv_sec &&
-         (*pp)->timeout.tv_usec > t->timeout.tv_usec)) {
-        t->next = *pp;
-        //        t->handler = handlercnt++;
-        *pp = t;
-        return t;
-    }
-    }
-    return NULL; // ?
+    return ccnl_timer_enqueue(t);
 }
 
 #endif
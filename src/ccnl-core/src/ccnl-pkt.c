@@ -35,6 +35,12 @@ void
 ccnl_pkt_free(struct ccnl_pkt_s *pkt)
 {
     if (pkt) {
+        if (pkt->flags & CCNL_PKT_ARENA) {
+            // prefix, nonce and chunk number are part of the pkt's allocation
+            ccnl_buf_free(pkt->buf);
+            ccnl_free(pkt);
+            return;
+        }
         if (pkt->pfx) {
             switch (pkt->pfx->suite) {
 #ifdef USE_SUITE_CCNB
@@ -63,12 +69,39 @@ ccnl_pkt_free(struct ccnl_pkt_s *pkt)
             ccnl_prefix_free(pkt->pfx);
         }
         if(pkt->buf){
-            ccnl_free(pkt->buf);
+            ccnl_buf_free(pkt->buf);
         }
         ccnl_free(pkt);
     }
 }
 
+int8_t
+ccnl_pkt_decode_rest(struct ccnl_pkt_s *pkt)
+{
+    int8_t rc = 0;
+
+    if (!(pkt->flags & CCNL_PKT_LAZY)) {
+        return 0;
+    }
+    switch (pkt->suite) {
+#ifdef USE_SUITE_CCNTLV
+    case CCNL_SUITE_CCNTLV:
+        rc = ccnl_ccntlv_decode_rest(pkt);
+        break;
+#endif
+#ifdef USE_SUITE_NDNTLV
+    case CCNL_SUITE_NDNTLV:
+        rc = ccnl_ndntlv_decode_rest(pkt);
+        break;
+#endif
+    default:
+        break;
+    }
+    if (rc) {
+        DEBUGMSG(WARNING, "  malformed metadata or signature\n");
+    }
+    return rc;
+}
 
 struct ccnl_pkt_s *
 ccnl_pkt_dup(struct ccnl_pkt_s *pkt){
@@ -82,6 +115,9 @@ ccnl_pkt_dup(struct ccnl_pkt_s *pkt){
     if(!ret){
         return NULL;
     }
+    // the copy gets allocations of its own
+    ret->flags = pkt->flags & ~CCNL_PKT_ARENA;
+    ret->lazyoffs = pkt->lazyoffs;
     if (pkt->pfx) {
         ret->s = pkt->s;
         switch (pkt->pfx->suite) {
@@ -116,7 +152,7 @@ ccnl_pkt_dup(struct ccnl_pkt_s *pkt){
         }
         ret->pfx->suite = pkt->pfx->suite;
         ret->suite = pkt->suite;
-        ret->buf = buf_dup(pkt->buf);
+        ret->buf = ccnl_buf_ref(pkt->buf);
         ret->content = ret->buf->data + (pkt->content - pkt->buf->data);
         ret->contlen = pkt->contlen;
     }
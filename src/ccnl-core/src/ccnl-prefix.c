@@ -23,6 +23,7 @@
 
 #ifndef CCNL_LINUXKERNEL
 #include "ccnl-prefix.h"
+#include "ccnl-htable.h"
 #include "ccnl-pkt-ndntlv.h"
 #include "ccnl-pkt-ccntlv.h"
 #include <string.h>
@@ -33,6 +34,7 @@
 #endif // !defined(CCNL_RIOT) && !defined(CCNL_ANDROID)
 #else //CCNL_LINUXKERNEL
 #include <ccnl-prefix.h>
+#include <ccnl-htable.h>
 #include <ccnl-pkt-ndntlv.h>
 #include <ccnl-pkt-ccntlv.h>
 #endif //CCNL_LINUXKERNEL
@@ -240,6 +242,42 @@ ccnl_prefix_addChunkNum(struct ccnl_prefix_s *prefix, uint32_t chunknum)
     return 0;
 }
 
+static uint32_t
+ccnl_prefix_hash_comp(uint32_t h, struct ccnl_prefix_s *prefix, uint32_t i)
+{
+    h = ccnl_hash_uint(h, (uint32_t) prefix->complen[i]);
+    return ccnl_hash_bytes(h, prefix->comp[i], prefix->complen[i]);
+}
+
+uint32_t
+ccnl_prefix_hash(struct ccnl_prefix_s *prefix, uint32_t cnt)
+{
+    uint32_t i, h = ccnl_hash_uint(CCNL_HASH_INIT, (uint8_t) prefix->suite);
+
+    if (cnt > prefix->compcnt) {
+        cnt = prefix->compcnt;
+    }
+    for (i = 0; i < cnt; i++) {
+        h = ccnl_prefix_hash_comp(h, prefix, i);
+    }
+    return h;
+}
+
+uint32_t
+ccnl_prefix_hashes(struct ccnl_prefix_s *prefix, uint32_t *hashes, uint32_t cnt)
+{
+    uint32_t i;
+
+    if (cnt > prefix->compcnt) {
+        cnt = prefix->compcnt;
+    }
+    hashes[0] = ccnl_hash_uint(CCNL_HASH_INIT, (uint8_t) prefix->suite);
+    for (i = 0; i < cnt; i++) {
+        hashes[i + 1] = ccnl_prefix_hash_comp(hashes[i], prefix, i);
+    }
+    return cnt;
+}
+
 // TODO: move to a util file?
 uint8_t
 hex2int(char c)
@@ -459,10 +497,10 @@ ccnl_i_prefixof_c(struct ccnl_prefix_s *prefix,
         return -2;
     }
 
-    unsigned char *md = NULL;
+    unsigned char *md = NULL, digest[CCNL_CCNX_DIGEST_LEN];
 
     if ((prefix->compcnt - p->compcnt) == 1) {
-        md = compute_ccnx_digest(c->pkt->buf);
+        md = compute_ccnx_digest(c->pkt->buf, digest);
 
         /* computing the ccnx digest failed */
         if (!md) {
@@ -596,7 +634,7 @@ ccnl_prefix_to_str_detailed(struct ccnl_prefix_s *pr, int ccntlv_skip, int escap
 char*
 ccnl_prefix_to_path(struct ccnl_prefix_s *pr)
 {
-    static char prefix_buf[4096];
+    static CCNL_THREAD_LOCAL char prefix_buf[4096];
     int len= 0, i;
     int result;
 
@@ -25,16 +25,46 @@
 #include <stdio.h>
 #include <inttypes.h>
 #include <assert.h>
+#if !defined(CCNL_RIOT) && !defined(CCNL_ANDROID)
+#include <openssl/sha.h>
+#endif // !defined(CCNL_RIOT) && !defined(CCNL_ANDROID)
 #else //CCNL_LINUXKERNEL
 #include <ccnl-core.h>
 #endif //CCNL_LINUXKERNEL
 
+#include "ccnl-callbacks.h"
+
 #ifdef CCNL_RIOT
 #include "ccn-lite-riot.h"
 #endif
 
 
 
+/* the face index key: the interface and, unless a local client, the peer */
+static uint32_t
+ccnl_face_hash(int ifndx, sockunion *peer)
+{
+    uint32_t h = ccnl_hash_uint(CCNL_HASH_INIT, (uint32_t) ifndx);
+
+    return peer ? ccnl_addr_hash(h, peer) : h;
+}
+
+struct ccnl_face_s*
+ccnl_face_find(struct ccnl_relay_s *ccnl, int faceid)
+{
+    struct ccnl_hlink_s *l;
+
+    for (l = ccnl_htable_first(&ccnl->face_ids,
+                               ccnl_hash_uint(CCNL_HASH_INIT, (uint32_t) faceid));
+         l; l = ccnl_htable_next(l)) {
+        struct ccnl_face_s *f = CCNL_HTABLE_ENTRY(l, struct ccnl_face_s, idlink);
+        if (f->faceid == faceid) {
+            return f;
+        }
+    }
+    return NULL;
+}
+
 struct ccnl_face_s*
 ccnl_get_face_or_create(struct ccnl_relay_s *ccnl, int ifndx,
                         struct sockaddr *sa, size_t addrlen)
@@ -42,32 +72,42 @@ ccnl_get_face_or_create(struct ccnl_relay_s *ccnl, int ifndx,
 // sa!=NULL && ifndx==-1: search suitable interface for given sa_family
 // sa!=NULL && ifndx!=-1: use this (incoming) interface for outgoing
 {
-    static int seqno;
+    static CCNL_THREAD_LOCAL int seqno; // each forwarding thread numbers its own faces
     int i;
     struct ccnl_face_s *f;
+    struct ccnl_hlink_s *l;
 
     DEBUGMSG_CORE(TRACE, "ccnl_get_face_or_create src=%s\n",
              ccnl_addr2ascii((sockunion*)sa));
 
-    for (f = ccnl->faces; f; f = f->next) {
-        if (!sa) {
+    if (!sa) {
+        for (l = ccnl_htable_first(&ccnl->face_index, ccnl_face_hash(-1, NULL));
+             l; l = ccnl_htable_next(l)) {
+            f = CCNL_HTABLE_ENTRY(l, struct ccnl_face_s, hlink);
             if (f->ifndx == -1)
                 return f;
-            continue;
         }
-        if (ifndx != -1 && (f->ifndx == ifndx) &&
-            !ccnl_addr_cmp(&f->peer, (sockunion*)sa)) {
-            f->last_used = CCNL_NOW();
+    } else if (ifndx != -1) {
+        for (l = ccnl_htable_first(&ccnl->face_index,
+                                   ccnl_face_hash(ifndx, (sockunion*)sa));
+             l; l = ccnl_htable_next(l)) {
+            f = CCNL_HTABLE_ENTRY(l, struct ccnl_face_s, hlink);
+            if ((f->ifndx == ifndx) &&
+                !ccnl_addr_cmp(&f->peer, (sockunion*)sa)) {
+                f->last_used = CCNL_NOW();
 #ifdef CCNL_RIOT
-            ccnl_evtimer_reset_face_timeout(f);
+                ccnl_evtimer_reset_face_timeout(f);
 #endif
-            return f;
+                return f;
+            }
         }
     }
 
     if (sa && ifndx == -1) {
         for (i = 0; i < ccnl->ifcount; i++) {
-            if (sa->sa_family != ccnl->ifs[i].addr.sa.sa_family) {
+            // stream interfaces only get the faces asked for explicitly
+            if (sa->sa_family != ccnl->ifs[i].addr.sa.sa_family ||
+                ccnl->ifs[i].stream) {
                 continue;
             }
             ifndx = i;
@@ -106,7 +146,18 @@ ccnl_get_face_or_create(struct ccnl_relay_s *ccnl, int ifndx,
     } else {  // local client
         f->ifndx = -1;
     }
+    if (ccnl_htable_add(&ccnl->face_index, &f->hlink,
+                        ccnl_face_hash(f->ifndx, sa ? &f->peer : NULL))) {
+        goto Bail;
+    }
+    if (ccnl_htable_add(&ccnl->face_ids, &f->idlink,
+                        ccnl_hash_uint(CCNL_HASH_INIT, (uint32_t) f->faceid))) {
+        ccnl_htable_remove(&ccnl->face_index, &f->hlink);
+        goto Bail;
+    }
     f->last_used = CCNL_NOW();
+    ccnl_wheel_schedule(&ccnl->face_wheel, &f->wlink,
+                        f->last_used + CCNL_FACE_TIMEOUT);
     DBL_LINKED_LIST_ADD(ccnl->faces, f);
 
     TRACEOUT();
@@ -116,6 +167,12 @@ ccnl_get_face_or_create(struct ccnl_relay_s *ccnl, int ifndx,
 #endif
 
     return f;
+
+Bail:
+    DEBUGMSG_CORE(VERBOSE, "  no memory for the face index\n");
+    ccnl_sched_destroy(f->sched);
+    ccnl_free(f);
+    return NULL;
 }
 
 struct ccnl_face_s*
@@ -123,7 +180,8 @@ ccnl_face_remove(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
 {
     struct ccnl_face_s *f2;
     struct ccnl_interest_s *pit;
-    struct ccnl_forward_s **ppfwd;
+    struct ccnl_pendint_s *pend, *pend2;
+    struct ccnl_forward_s *fwd;
 
     DEBUGMSG_CORE(DEBUG, "face_remove relay=%p face=%p\n",
              (void*)ccnl, (void*)f);
@@ -133,50 +191,49 @@ ccnl_face_remove(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
     ccnl_frag_destroy(f->frag);
 #endif
     DEBUGMSG_CORE(TRACE, "face_remove: cleaning PIT\n");
-    for (pit = ccnl->pit; pit; ) {
-        struct ccnl_pendint_s **ppend, *pend;
-        if (pit->from == f) {
-            pit->from = NULL;
-        }
-        for (ppend = &pit->pending; *ppend;) {
-            if ((*ppend)->face == f) {
-                pend = *ppend;
-                *ppend = pend->next;
-                ccnl_free(pend);
-            } else {
-                ppend = &(*ppend)->next;
-            }
-        }
-        if (pit->pending) {
-            pit = pit->next;
-        } else {
+    while ((pit = f->origins)) {
+        f->origins = pit->from_next;
+        pit->from = NULL;
+        pit->from_next = NULL;
+        pit->from_pprev = NULL;
+    }
+    // an interest has at most one pending entry per face, so removing an
+    // interest below never frees the next entry of this face's list
+    for (pend = f->pendints; pend; pend = pend2) {
+        pend2 = pend->face_next;
+        pit = pend->interest;
+        ccnl_pendint_free(pend);
+        if (!pit->pending) {
             DEBUGMSG_CORE(TRACE, "before interest_remove 0x%p\n",
                           (void*)pit);
-            pit = ccnl_interest_remove(ccnl, pit);
+            ccnl_interest_remove(ccnl, pit);
         }
     }
     DEBUGMSG_CORE(TRACE, "face_remove: cleaning fwd table\n");
-    for (ppfwd = &ccnl->fib; *ppfwd;) {
-        if ((*ppfwd)->face == f) {
-            struct ccnl_forward_s *pfwd = *ppfwd;
-            ccnl_prefix_free(pfwd->prefix);
-            *ppfwd = pfwd->next;
-            ccnl_free(pfwd);
-        } else {
-            ppfwd = &(*ppfwd)->next;
-        }
+    while ((fwd = f->fwds)) {
+        ccnl_fib_unlink(ccnl, fwd);
+        ccnl_prefix_free(fwd->prefix);
+        ccnl_free(fwd);
     }
     DEBUGMSG_CORE(TRACE, "face_remove: cleaning pkt queue\n");
     while (f->outq) {
-        struct ccnl_buf_s *tmp = f->outq->next;
+        struct ccnl_outq_s *tmp = f->outq->next;
+        ccnl_buf_free(f->outq->buf);
         ccnl_free(f->outq);
         f->outq = tmp;
     }
+    ccnl_htable_free(&f->outq_index);
     DEBUGMSG_CORE(TRACE, "face_remove: unlinking1 %p %p\n",
              (void*)f->next, (void*)f->prev);
     f2 = f->next;
     DEBUGMSG_CORE(TRACE, "face_remove: unlinking2\n");
     DBL_LINKED_LIST_REMOVE(ccnl->faces, f);
+    ccnl_htable_remove(&ccnl->face_index, &f->hlink);
+    ccnl_htable_remove(&ccnl->face_ids, &f->idlink);
+    ccnl_wheel_cancel(&f->wlink);
+    if (ccnl->app_face == f) {
+        ccnl->app_face = NULL;
+    }
     DEBUGMSG_CORE(TRACE, "face_remove: unlinking3\n");
     ccnl_free(f);
 
@@ -198,10 +255,20 @@ ccnl_interface_enqueue(void (tx_done)(void*, int, int), struct ccnl_face_s *f,
                   buf ? buf->datalen : 0, ifc ? ifc->qlen : 0);
         }
 
+        if (ifc->qlen >= CCNL_MAX_IF_QLEN && ccnl->tx_deferred) {
+            // a full queue is sent now rather than at the end of the loop
+            // iteration; what the socket refuses goes as without deferral
+            if (ccnl->tx_flush) {
+                ccnl->tx_flush(ccnl, ifc);
+            }
+            if (ifc->qlen >= CCNL_MAX_IF_QLEN) {
+                ccnl_interface_CTS(ccnl, ifc);
+            }
+        }
         if (ifc->qlen >= CCNL_MAX_IF_QLEN) {
             if (buf) {
                 DEBUGMSG_CORE(WARNING, "  DROPPING buf=%p\n", (void*)buf); 
-                ccnl_free(buf); 
+                ccnl_buf_free(buf); 
                 return;
             }
         }
@@ -216,7 +283,9 @@ ccnl_interface_enqueue(void (tx_done)(void*, int, int), struct ccnl_face_s *f,
 #ifdef USE_SCHEDULER
         ccnl_sched_RTS(ifc->sched, 1, buf->datalen, ccnl, ifc);
 #else 
-        ccnl_interface_CTS(ccnl, ifc);
+        if (!ccnl->tx_deferred) {
+            ccnl_interface_CTS(ccnl, ifc);
+        }
 #endif
     }
 }
@@ -224,6 +293,7 @@ ccnl_interface_enqueue(void (tx_done)(void*, int, int), struct ccnl_face_s *f,
 struct ccnl_buf_s*
 ccnl_face_dequeue(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
 {
+    struct ccnl_outq_s *q;
     struct ccnl_buf_s *pkt;
     DEBUGMSG_CORE(TRACE, "dequeue face=%p (id=%d.%d)\n",
              (void *) f, ccnl->id, f->faceid);
@@ -231,12 +301,14 @@ ccnl_face_dequeue(struct ccnl_relay_s *ccnl, struct ccnl_face_s *f)
     if (!f->outq) {
         return NULL;
     }
-    pkt = f->outq;
-    f->outq = pkt->next;
-    if (!pkt->next) {
+    q = f->outq;
+    f->outq = q->next;
+    if (!q->next) {
         f->outqend = NULL;
     }
-    pkt->next = NULL;
+    ccnl_htable_remove(&f->outq_index, &q->hlink);
+    pkt = q->buf;
+    ccnl_free(q);
     return pkt;
 }
 
@@ -289,14 +361,16 @@ int
 ccnl_send_pkt(struct ccnl_relay_s *ccnl, struct ccnl_face_s *to,
                 struct ccnl_pkt_s *pkt)
 {
-    return ccnl_face_enqueue(ccnl, to, buf_dup(pkt->buf));
+    return ccnl_face_enqueue(ccnl, to, ccnl_buf_ref(pkt->buf));
 }
 
 int
 ccnl_face_enqueue(struct ccnl_relay_s *ccnl, struct ccnl_face_s *to,
                  struct ccnl_buf_s *buf)
 {
-    struct ccnl_buf_s *msg;
+    struct ccnl_outq_s *msg;
+    struct ccnl_hlink_s *l;
+    uint32_t hash;
     if (buf == NULL) {
         DEBUGMSG_CORE(ERROR, "enqueue face: buf most not be NULL\n");
         return -1;
@@ -304,20 +378,48 @@ ccnl_face_enqueue(struct ccnl_relay_s *ccnl, struct ccnl_face_s *to,
     DEBUGMSG_CORE(TRACE, "enqueue face=%p (id=%d.%d) buf=%p len=%zd\n",
              (void*) to, ccnl->id, to->faceid, (void*) buf, buf ? buf->datalen : 0);
 
-    for (msg = to->outq; msg; msg = msg->next) { // already in the queue?
-        if (buf_equal(msg, buf)) {
+    if (!to->outq && (!to->frag || to->frag->protocol == CCNL_FRAG_NONE)
+#ifdef USE_SCHEDULER
+        && !to->sched
+#endif
+        ) {
+        // ccnl_face_CTS() would dequeue it right away
+        ccnl_interface_enqueue(ccnl_face_CTS_done, to,
+                               ccnl, ccnl->ifs + to->ifndx, buf, &to->peer);
+        return 0;
+    }
+
+    hash = ccnl_buf_hash(buf);
+    for (l = ccnl_htable_first(&to->outq_index, hash); l;
+                                            l = ccnl_htable_next(l)) {
+        msg = CCNL_HTABLE_ENTRY(l, struct ccnl_outq_s, hlink);
+        if (msg->buf == buf || buf_equal(msg->buf, buf)) {
             DEBUGMSG_CORE(VERBOSE, "    not enqueued because already there\n");
-            ccnl_free(buf);
+#ifdef USE_STATS
+            to->outq_dups++;
+#endif
+            ccnl_buf_free(buf);
             return -1;
         }
     }
-    buf->next = NULL;
+    msg = (struct ccnl_outq_s *) ccnl_malloc(sizeof(*msg));
+    if (!msg) {
+        ccnl_buf_free(buf);
+        return -1;
+    }
+    msg->next = NULL;
+    msg->buf = buf;
+    if (ccnl_htable_add(&to->outq_index, &msg->hlink, hash)) {
+        ccnl_free(msg);
+        ccnl_buf_free(buf);
+        return -1;
+    }
     if (to->outqend) {
-        to->outqend->next = buf;
+        to->outqend->next = msg;
     } else {
-        to->outq = buf;
+        to->outq = msg;
     }
-    to->outqend = buf;
+    to->outqend = msg;
 #ifdef USE_SCHEDULER
     if (to->sched) {
 #ifdef USE_FRAG
@@ -352,15 +454,25 @@ ccnl_interest_remove(struct ccnl_relay_s *ccnl, struct ccnl_interest_s *i)
 #endif
 
     while (i->pending) {
-        struct ccnl_pendint_s *tmp = i->pending->next;          \
-        ccnl_free(i->pending);
-        i->pending = tmp;
+        ccnl_pendint_free(i->pending);
+    }
+    if (i->from_pprev) {
+        *i->from_pprev = i->from_next;
+        if (i->from_next) {
+            i->from_next->from_pprev = i->from_pprev;
+        }
     }
     i2 = i->next;
 
     ccnl->pitcnt--;
 
     DBL_LINKED_LIST_REMOVE(ccnl->pit, i);
+    ccnl_htable_remove(&ccnl->pit_index, &i->hlink);
+    ccnl_wheel_cancel(&i->wlink);
+    if (!ccnl_htable_remove(&ccnl->pit_names, &i->nlink)) {
+        ccnl->pit_lencnt[i->pkt->pfx->compcnt]--;
+    }
+    ccnl_htable_remove(&ccnl->pit_digests, &i->dlink);
 
     if (i->pkt) {
         ccnl_pkt_free(i->pkt);
@@ -375,7 +487,9 @@ void
 ccnl_interest_propagate(struct ccnl_relay_s *ccnl, struct ccnl_interest_s *i)
 {
     struct ccnl_forward_s *fwd;
-    int rc = 0;
+    struct ccnl_hlink_s *l;
+    uint32_t hashes[CCNL_MAX_NAME_COMP + 1];
+    int32_t len, fwdlen = -1;
     char s[CCNL_MAX_PREFIX_SIZE];
     (void) s;
 
@@ -383,63 +497,67 @@ ccnl_interest_propagate(struct ccnl_relay_s *ccnl, struct ccnl_interest_s *i)
     int matching_face = 0;
 #endif
 
-    if (!i) {
+    if (!i || !i->pkt->pfx) {
         return;
     }
     DEBUGMSG_CORE(DEBUG, "ccnl_interest_propagate\n");
 
     // CONFORM: "A node MUST implement some strategy rule, even if it is only to
     // transmit an Interest Message on all listed dest faces in sequence."
-    // CCNL strategy: we forward on all FWD entries with a prefix match
-
-    for (fwd = ccnl->fib; fwd; fwd = fwd->next) {
-        if (!fwd->prefix) {
-            continue;
-        }
-
-        //Only for matching suite
-        if (!i->pkt->pfx || fwd->suite != i->pkt->pfx->suite) {
-            DEBUGMSG_CORE(VERBOSE, "  not same suite (%d/%d)\n",
-                     fwd->suite, i->pkt->pfx ? i->pkt->pfx->suite : -1);
-            continue;
-        }
+    // CCNL strategy: we forward on all faces of the longest matching prefix,
+    // taps see the interest for every matching prefix
 
-        rc = ccnl_prefix_cmp(fwd->prefix, NULL, i->pkt->pfx, CMP_LONGEST);
-
-        DEBUGMSG_CORE(DEBUG, "  ccnl_interest_propagate, rc=%ld/%ld\n",
-                 (long) rc, (long) fwd->prefix->compcnt);
-        if (rc < (signed) fwd->prefix->compcnt) {
+    len = (int32_t) ccnl_prefix_hashes(i->pkt->pfx, hashes, CCNL_MAX_NAME_COMP);
+    for (; len >= 0; len--) {
+        if (!ccnl->fib_lencnt[len]) {
             continue;
         }
+        for (l = ccnl_htable_first(&ccnl->fib_index, hashes[len]); l;
+             l = ccnl_htable_next(l)) {
+            fwd = CCNL_HTABLE_ENTRY(l, struct ccnl_forward_s, hlink);
+
+            //Only for matching suite
+            if (fwd->suite != i->pkt->pfx->suite ||
+                fwd->prefix->compcnt != (uint32_t) len ||
+                ccnl_prefix_cmp(fwd->prefix, NULL, i->pkt->pfx, CMP_LONGEST) < len) {
+                continue;
+            }
+            // shorter prefixes are only of interest to taps
+            if (!fwd->tap && fwdlen > len) {
+                continue;
+            }
 
-        DEBUGMSG_CORE(DEBUG, "  ccnl_interest_propagate, fwd==%p\n", (void*)fwd);
-        // suppress forwarding to origin of interest, except wireless
-        if (!i->from || fwd->face != i->from ||
-                                (i->from->flags & CCNL_FACE_FLAGS_REFLECT)) {
-            int nonce = 0;
-            if (i->pkt != NULL && i->pkt->s.ndntlv.nonce != NULL) {
-                if (i->pkt->s.ndntlv.nonce->datalen == 4) {
-                    memcpy(&nonce, i->pkt->s.ndntlv.nonce->data, 4);
+            DEBUGMSG_CORE(DEBUG, "  ccnl_interest_propagate, fwd==%p\n", (void*)fwd);
+            // suppress forwarding to origin of interest, except wireless
+            if (!i->from || fwd->face != i->from ||
+                                    (i->from->flags & CCNL_FACE_FLAGS_REFLECT)) {
+                int nonce = 0;
+                if (i->pkt != NULL && i->pkt->s.ndntlv.nonce != NULL) {
+                    if (i->pkt->s.ndntlv.nonce->datalen == 4) {
+                        memcpy(&nonce, i->pkt->s.ndntlv.nonce->data, 4);
+                    }
                 }
-            }
 
-            DEBUGMSG_CFWD(INFO, "  outgoing interest=<%s> nonce=%i to=%s\n",
-                          ccnl_prefix_to_str(i->pkt->pfx,s,CCNL_MAX_PREFIX_SIZE), nonce,
-                          fwd->face ? ccnl_addr2ascii(&fwd->face->peer)
-                                    : "<tap>");
+                DEBUGMSG_CFWD(INFO, "  outgoing interest=<%s> nonce=%i to=%s\n",
+                              ccnl_prefix_to_str(i->pkt->pfx,s,CCNL_MAX_PREFIX_SIZE), nonce,
+                              fwd->face ? ccnl_addr2ascii(&fwd->face->peer)
+                                        : "<tap>");
 
-            // DEBUGMSG(DEBUG, "%p %p %p\n", (void*)i, (void*)i->pkt, (void*)i->pkt->buf);
-            if (fwd->tap) {
-                (fwd->tap)(ccnl, i->from, i->pkt->pfx, i->pkt->buf);
-            }
-            if (fwd->face) {
-                ccnl_send_pkt(ccnl, fwd->face, i->pkt);
-            }
+                if (fwd->tap) {
+                    (fwd->tap)(ccnl, i->from, i->pkt->pfx, i->pkt->buf);
+                }
+                if (fwd->face && fwdlen <= len) {
+                    ccnl_send_pkt(ccnl, fwd->face, i->pkt);
 #if defined(USE_RONR)
-            matching_face = 1;
+                    matching_face = 1;
 #endif
-        } else {
-            DEBUGMSG_CORE(DEBUG, "  no matching fib entry found\n");
+                }
+            } else {
+                DEBUGMSG_CORE(DEBUG, "  not forwarding to the origin of the interest\n");
+            }
+            if (fwd->face && fwdlen < 0) {
+                fwdlen = len;
+            }
         }
     }
 
@@ -514,6 +632,97 @@ ccnl_interest_broadcast(struct ccnl_relay_s *ccnl, struct ccnl_interest_s *inter
     }
 }
 
+/* the CS index key: suite, all name components and the chunk number */
+static uint32_t
+ccnl_content_hash(struct ccnl_prefix_s *pfx)
+{
+    uint32_t h = ccnl_prefix_hash(pfx, pfx->compcnt);
+
+    if (pfx->chunknum) {
+        h = ccnl_hash_uint(h, *pfx->chunknum);
+    }
+    return h;
+}
+
+struct ccnl_content_s*
+ccnl_content_find(struct ccnl_relay_s *ccnl, struct ccnl_prefix_s *pfx)
+{
+    struct ccnl_hlink_s *l;
+
+    for (l = ccnl_htable_first(&ccnl->cs_index, ccnl_content_hash(pfx)); l;
+         l = ccnl_htable_next(l)) {
+        struct ccnl_content_s *c = CCNL_HTABLE_ENTRY(l, struct ccnl_content_s,
+                                                     hlink);
+        if (c->pkt->pfx->suite == pfx->suite &&
+            !ccnl_prefix_cmp(c->pkt->pfx, NULL, pfx, CMP_EXACT)) {
+            return c;
+        }
+    }
+    return NULL;
+}
+
+/* static content is never evicted and hence not kept in the recency list */
+/* the earliest time the ageing has to look at c: when it times out, or
+   becomes stale before that */
+static uint32_t
+ccnl_content_deadline(struct ccnl_content_s *c)
+{
+    uint32_t deadline = c->last_used + CCNL_CONTENT_TIMEOUT;
+
+#ifdef USE_SUITE_NDNTLV
+    if (c->pkt->suite == CCNL_SUITE_NDNTLV &&
+            !(c->flags & CCNL_CONTENT_FLAGS_STALE)) {
+        uint32_t fresh = c->created + c->pkt->s.ndntlv.freshnessperiod / 1000;
+        if (fresh < deadline) {
+            deadline = fresh;
+        }
+    }
+#endif
+    return deadline;
+}
+
+static void
+ccnl_content_lru_unlink(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
+{
+    if (c->lru_prev) {
+        c->lru_prev->lru_next = c->lru_next;
+    } else if (ccnl->lru_head == c) {
+        ccnl->lru_head = c->lru_next;
+    } else {
+        return; // not in the list
+    }
+    if (c->lru_next) {
+        c->lru_next->lru_prev = c->lru_prev;
+    } else {
+        ccnl->lru_tail = c->lru_prev;
+    }
+    c->lru_prev = c->lru_next = NULL;
+}
+
+static void
+ccnl_content_lru_push(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
+{
+    c->lru_prev = NULL;
+    c->lru_next = ccnl->lru_head;
+    if (ccnl->lru_head) {
+        ccnl->lru_head->lru_prev = c;
+    } else {
+        ccnl->lru_tail = c;
+    }
+    ccnl->lru_head = c;
+}
+
+void
+ccnl_content_touch(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
+{
+    c->last_used = CCNL_NOW();
+    if (ccnl->lru_head == c || (c->flags & CCNL_CONTENT_FLAGS_STATIC)) {
+        return;
+    }
+    ccnl_content_lru_unlink(ccnl, c);
+    ccnl_content_lru_push(ccnl, c);
+}
+
 struct ccnl_content_s*
 ccnl_content_remove(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
 {
@@ -522,12 +731,13 @@ ccnl_content_remove(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
 
     c2 = c->next;
     DBL_LINKED_LIST_REMOVE(ccnl->contents, c);
+    ccnl_htable_remove(&ccnl->cs_index, &c->hlink);
+    ccnl_content_lru_unlink(ccnl, c);
+    ccnl_wheel_cancel(&c->wlink);
 
 //    free_content(c);
     if (c->pkt) {
-        ccnl_prefix_free(c->pkt->pfx);
-        ccnl_free(c->pkt->buf);
-        ccnl_free(c->pkt);
+        ccnl_pkt_free(c->pkt);
     }
     //    ccnl_prefix_free(c->name);
     ccnl_free(c);
@@ -542,7 +752,6 @@ ccnl_content_remove(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
 struct ccnl_content_s*
 ccnl_content_add2cache(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
 {
-    struct ccnl_content_s *cit;
     char s[CCNL_MAX_PREFIX_SIZE];
     (void) s;
 
@@ -550,33 +759,37 @@ ccnl_content_add2cache(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
                   ccnl->contentcnt, ccnl->max_cache_entries,
                   (void*)c, ccnl_prefix_to_str(c->pkt->pfx,s,CCNL_MAX_PREFIX_SIZE), (c->pkt->pfx->chunknum)? (signed) *(c->pkt->pfx->chunknum) : -1);
 
-    for (cit = ccnl->contents; cit; cit = cit->next) {
-        if (ccnl_prefix_cmp(c->pkt->pfx, NULL, cit->pkt->pfx, CMP_EXACT) == 0) {
-            DEBUGMSG_CORE(DEBUG, "--- Already in cache ---\n");
-            return NULL;
-        }
+    if (ccnl_content_find(ccnl, c->pkt->pfx)) {
+        DEBUGMSG_CORE(DEBUG, "--- Already in cache ---\n");
+        return NULL;
     }
 
     if (ccnl->max_cache_entries > 0 &&
-        ccnl->contentcnt >= ccnl->max_cache_entries) { // remove oldest content
-        struct ccnl_content_s *c2, *oldest = NULL;
-        uint32_t age = 0;
-        for (c2 = ccnl->contents; c2; c2 = c2->next) {
-             if (!(c2->flags & CCNL_CONTENT_FLAGS_STATIC)) {
-                 if ((age == 0) || c2->last_used < age) {
-                     age = c2->last_used;
-                     oldest = c2;
-                 }
-             }
-         }
-         if (oldest) {
-             DEBUGMSG_CORE(DEBUG, " remove old entry from cache\n");
-             ccnl_content_remove(ccnl, oldest);
-         }
+        ccnl->contentcnt >= ccnl->max_cache_entries) { // remove least recently used content
+        struct ccnl_content_s *oldest;
+        // content may have been marked static after it was cached
+        while ((oldest = ccnl->lru_tail) &&
+               (oldest->flags & CCNL_CONTENT_FLAGS_STATIC)) {
+            ccnl_content_lru_unlink(ccnl, oldest);
+        }
+        if (oldest) {
+            DEBUGMSG_CORE(DEBUG, " remove old entry from cache\n");
+            ccnl_content_remove(ccnl, oldest);
+        }
     }
     if ((ccnl->max_cache_entries <= 0) ||
          (ccnl->contentcnt <= ccnl->max_cache_entries)) {
+            if (ccnl_htable_add(&ccnl->cs_index, &c->hlink,
+                                ccnl_content_hash(c->pkt->pfx))) {
+                DEBUGMSG_CORE(WARNING, "  no memory for the CS index\n");
+                return NULL;
+            }
             DBL_LINKED_LIST_ADD(ccnl->contents, c);
+            if (!(c->flags & CCNL_CONTENT_FLAGS_STATIC)) {
+                ccnl_content_lru_push(ccnl, c);
+                ccnl_wheel_schedule(&ccnl->cs_wheel, &c->wlink,
+                                    ccnl_content_deadline(c));
+            }
             ccnl->contentcnt++;
 #ifdef CCNL_RIOT
             /* set cache timeout timer if content is not static */
@@ -589,113 +802,147 @@ ccnl_content_add2cache(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
     return c;
 }
 
+/* does the (index candidate) interest i match the content c */
+static int
+ccnl_interest_matches_c(struct ccnl_interest_s *i, struct ccnl_content_s *c)
+{
+    if (i->pkt->pfx->suite != c->pkt->pfx->suite) {
+        return 0;
+    }
+    switch (i->pkt->pfx->suite) {
+#ifdef USE_SUITE_CCNB
+    case CCNL_SUITE_CCNB:
+        // XX must also check i->ppkd
+        return ccnl_i_prefixof_c(i->pkt->pfx, i->pkt->s.ccnb.minsuffix,
+                                 i->pkt->s.ccnb.maxsuffix, c) > 0;
+#endif
+#ifdef USE_SUITE_CCNTLV
+    case CCNL_SUITE_CCNTLV:
+        // XX must also check keyid
+        return !ccnl_prefix_cmp(c->pkt->pfx, NULL, i->pkt->pfx, CMP_EXACT);
+#endif
+#ifdef USE_SUITE_NDNTLV
+    case CCNL_SUITE_NDNTLV:
+        // XX must also check i->ppkl,
+        return ccnl_i_prefixof_c(i->pkt->pfx, i->pkt->s.ndntlv.minsuffix,
+                                 i->pkt->s.ndntlv.maxsuffix, c) > 0;
+#endif
+    default:
+        return 0;
+    }
+}
+
 int
 ccnl_content_serve_pending(struct ccnl_relay_s *ccnl, struct ccnl_content_s *c)
 {
     struct ccnl_interest_s *i;
     struct ccnl_face_s *f;
+    struct ccnl_hlink_s *l, *next;
+    uint32_t hashes[CCNL_MAX_NAME_COMP + 1], len, n;
+    unsigned char *md, digest[CCNL_CCNX_DIGEST_LEN];
     int cnt = 0;
     DEBUGMSG_CORE(TRACE, "ccnl_content_serve_pending\n");
     char s[CCNL_MAX_PREFIX_SIZE];
 
-    for (f = ccnl->faces; f; f = f->next){
-                f->flags &= ~CCNL_FACE_FLAGS_SERVED; // reply on a face only once
-    }
-    for (i = ccnl->pit; i;) {
-        struct ccnl_pendint_s *pi;
-        if (!i->pkt->pfx) {
-            continue;
+    // reply on a face only once: a face which was served this content
+    // carries the current epoch
+    if (++ccnl->serve_epoch == 0) {
+        for (f = ccnl->faces; f; f = f->next) {
+            f->served_epoch = 0;
         }
+        ccnl->serve_epoch = 1;
+    }
 
-        switch (i->pkt->pfx->suite) {
-#ifdef USE_SUITE_CCNB
-        case CCNL_SUITE_CCNB:
-            if (!ccnl_i_prefixof_c(i->pkt->pfx, i->pkt->s.ccnb.minsuffix,
-                       i->pkt->s.ccnb.maxsuffix, c)) {
-                // XX must also check i->ppkd
-                i = i->next;
-                continue;
-            }
-            break;
-#endif
-#ifdef USE_SUITE_CCNTLV
-        case CCNL_SUITE_CCNTLV:
-            if (ccnl_prefix_cmp(c->pkt->pfx, NULL, i->pkt->pfx, CMP_EXACT)) {
-                // XX must also check keyid
-                i = i->next;
-                continue;
-            }
-            break;
-#endif
-#ifdef USE_SUITE_NDNTLV
-        case CCNL_SUITE_NDNTLV:
-            if (!ccnl_i_prefixof_c(i->pkt->pfx, i->pkt->s.ndntlv.minsuffix,
-                       i->pkt->s.ndntlv.maxsuffix, c)) {
-                // XX must also check i->ppkl,
-                i = i->next;
-                continue;
+    // only interests whose name is a prefix of the content name can match,
+    // or the content name plus its digest as last component: the digest is
+    // computed only if an interest extends the content name by a component
+    // of a digest's length
+    n = ccnl_prefix_hashes(c->pkt->pfx, hashes, CCNL_MAX_NAME_COMP);
+    if (n < CCNL_MAX_NAME_COMP && ccnl->pit_lencnt[n + 1]) {
+        for (l = ccnl_htable_first(&ccnl->pit_digests, hashes[n]); l;
+             l = ccnl_htable_next(l)) {
+            i = CCNL_HTABLE_ENTRY(l, struct ccnl_interest_s, dlink);
+            if (i->pkt->pfx->compcnt == n + 1) {
+                break;
             }
-            break;
-#endif
-        default:
-            i = i->next;
-            continue;
         }
+        md = l ? compute_ccnx_digest(c->pkt->buf, digest) : NULL;
+        if (md) {
+            // same layout as a name component in ccnl_prefix_hash
+            hashes[n + 1] = ccnl_hash_bytes(ccnl_hash_uint(hashes[n],
+                                            CCNL_CCNX_DIGEST_LEN),
+                                            md, CCNL_CCNX_DIGEST_LEN);
+            n++;
+        }
+    }
 
-        //Hook for add content to cache by callback:
-        if(i && ! i->pending){
-            DEBUGMSG_CORE(WARNING, "releasing interest 0x%p OK?\n", (void*)i);
-            c->flags |= CCNL_CONTENT_FLAGS_STATIC;
-            i = ccnl_interest_remove(ccnl, i);
-
-            c->served_cnt++;
-            cnt++;
+    for (len = 0; len <= n; len++) {
+        if (!ccnl->pit_lencnt[len]) {
             continue;
-            //return 1;
-
         }
+        // served interests are removed, the next candidate is taken first
+        for (l = ccnl_htable_first(&ccnl->pit_names, hashes[len]); l; l = next) {
+            struct ccnl_pendint_s *pi;
+            i = CCNL_HTABLE_ENTRY(l, struct ccnl_interest_s, nlink);
+            next = ccnl_htable_next(l);
 
-        // CONFORM: "Data MUST only be transmitted in response to
-        // an Interest that matches the Data."
-        for (pi = i->pending; pi; pi = pi->next) {
-            if (pi->face->flags & CCNL_FACE_FLAGS_SERVED) {
+            if (i->pkt->pfx->compcnt != len || !ccnl_interest_matches_c(i, c)) {
                 continue;
             }
-            pi->face->flags |= CCNL_FACE_FLAGS_SERVED;
-            if (pi->face->ifndx >= 0) {
-                int32_t nonce = 0;
-                if (i->pkt != NULL && i->pkt->s.ndntlv.nonce != NULL) {
-                    if (i->pkt->s.ndntlv.nonce->datalen == 4) {
-                        memcpy(&nonce, i->pkt->s.ndntlv.nonce->data, 4);
-                    }
+
+            //Hook for add content to cache by callback:
+            if (!i->pending) {
+                DEBUGMSG_CORE(WARNING, "releasing interest 0x%p OK?\n", (void*)i);
+                c->flags |= CCNL_CONTENT_FLAGS_STATIC;
+                ccnl_interest_remove(ccnl, i);
+
+                c->served_cnt++;
+                cnt++;
+                continue;
+            }
+
+            // CONFORM: "Data MUST only be transmitted in response to
+            // an Interest that matches the Data."
+            for (pi = i->pending; pi; pi = pi->next) {
+                if (pi->face->served_epoch == ccnl->serve_epoch) {
+                    continue;
                 }
+                pi->face->served_epoch = ccnl->serve_epoch;
+                if (pi->face->ifndx >= 0) {
+                    int32_t nonce = 0;
+                    if (i->pkt != NULL && i->pkt->s.ndntlv.nonce != NULL) {
+                        if (i->pkt->s.ndntlv.nonce->datalen == 4) {
+                            memcpy(&nonce, i->pkt->s.ndntlv.nonce->data, 4);
+                        }
+                    }
 
 #ifndef CCNL_LINUXKERNEL
-                DEBUGMSG_CFWD(INFO, "  outgoing data=<%s>%s nonce=%"PRIi32" to=%s\n",
-                          ccnl_prefix_to_str(i->pkt->pfx,s,CCNL_MAX_PREFIX_SIZE),
-                          ccnl_suite2str(i->pkt->pfx->suite), nonce,
-                          ccnl_addr2ascii(&pi->face->peer));
+                    DEBUGMSG_CFWD(INFO, "  outgoing data=<%s>%s nonce=%"PRIi32" to=%s\n",
+                              ccnl_prefix_to_str(i->pkt->pfx,s,CCNL_MAX_PREFIX_SIZE),
+                              ccnl_suite2str(i->pkt->pfx->suite), nonce,
+                              ccnl_addr2ascii(&pi->face->peer));
 #else
-                DEBUGMSG_CFWD(INFO, "  outgoing data=<%s>%s nonce=%d to=%s\n",
-                          ccnl_prefix_to_str(i->pkt->pfx,s,CCNL_MAX_PREFIX_SIZE),
-                          ccnl_suite2str(i->pkt->pfx->suite), nonce,
-                          ccnl_addr2ascii(&pi->face->peer));
+                    DEBUGMSG_CFWD(INFO, "  outgoing data=<%s>%s nonce=%d to=%s\n",
+                              ccnl_prefix_to_str(i->pkt->pfx,s,CCNL_MAX_PREFIX_SIZE),
+                              ccnl_suite2str(i->pkt->pfx->suite), nonce,
+                              ccnl_addr2ascii(&pi->face->peer));
 #endif
-                DEBUGMSG_CORE(VERBOSE, "    Serve to face: %d (pkt=%p)\n",
-                         pi->face->faceid, (void*) c->pkt);
-
-                ccnl_send_pkt(ccnl, pi->face, c->pkt);
+                    DEBUGMSG_CORE(VERBOSE, "    Serve to face: %d (pkt=%p)\n",
+                             pi->face->faceid, (void*) c->pkt);
 
-
-            } else {// upcall to deliver content to local client
+                    ccnl_send_pkt(ccnl, pi->face, c->pkt);
+                } else {// upcall to deliver content to local client
 #ifdef CCNL_APP_RX
-                ccnl_app_RX(ccnl, c);
+                    ccnl_app_RX(ccnl, c);
+#else
+                    ccnl_callback_app_rx(ccnl, c);
 #endif
+                }
+                c->served_cnt++;
+                cnt++;
             }
-            c->served_cnt++;
-            cnt++;
+            ccnl_interest_remove(ccnl, i);
         }
-        i = ccnl_interest_remove(ccnl, i);
     }
 
     return cnt;
@@ -712,40 +959,48 @@ ccnl_do_ageing(void *ptr, void *dummy)
 {
 
     struct ccnl_relay_s *relay = (struct ccnl_relay_s*) ptr;
-    struct ccnl_content_s *c = relay->contents;
-    struct ccnl_interest_s *i = relay->pit;
-    struct ccnl_face_s *f = relay->faces;
-    time_t t = CCNL_NOW();
+    struct ccnl_content_s *c;
+    struct ccnl_interest_s *i;
+    struct ccnl_face_s *f;
+    struct ccnl_wlink_s *l;
+    uint32_t t = CCNL_NOW();
+    uint32_t period = (uint32_t) (relay->retrans_period > 0 ?
+                        relay->retrans_period : CCNL_INTEREST_RETRANS_PERIOD);
     DEBUGMSG_CORE(VERBOSE, "ageing t=%d\n", (int)t);
     (void) dummy;
     char s[CCNL_MAX_PREFIX_SIZE];
     (void) s;
 
-    while (c) {
-        if ((c->last_used + CCNL_CONTENT_TIMEOUT) <= (uint32_t) t &&
-                                !(c->flags & CCNL_CONTENT_FLAGS_STATIC)){
+    // entries are scheduled for the earliest time they can time out (or
+    // become stale), and rescheduled if they were used in the meantime
+    while ((l = ccnl_wheel_expire(&relay->cs_wheel, t))) {
+        c = CCNL_WHEEL_ENTRY(l, struct ccnl_content_s, wlink);
+        if (c->flags & CCNL_CONTENT_FLAGS_STATIC) {
+            continue;
+        }
+        if ((c->last_used + CCNL_CONTENT_TIMEOUT) <= t) {
             DEBUGMSG_CORE(TRACE, "AGING: CONTENT REMOVE %p\n", (void*) c);
-            c = ccnl_content_remove(relay, c);
+            ccnl_content_remove(relay, c);
+            continue;
         }
-        else {
 #ifdef USE_SUITE_NDNTLV
-            if (c->pkt->suite == CCNL_SUITE_NDNTLV) {
-                // Mark content as stale if its freshness period expired and it is not static
-                if ((c->last_used + (c->pkt->s.ndntlv.freshnessperiod / 1000)) <= (uint32_t) t &&
-                        !(c->flags & CCNL_CONTENT_FLAGS_STATIC)) {
-                    c->flags |= CCNL_CONTENT_FLAGS_STALE;
-                }
+        if (c->pkt->suite == CCNL_SUITE_NDNTLV) {
+            // Mark content as stale if its freshness period expired and it is not static
+            if ((c->created + (c->pkt->s.ndntlv.freshnessperiod / 1000)) <= t) {
+                c->flags |= CCNL_CONTENT_FLAGS_STALE;
             }
-#endif
-            c = c->next;
         }
+#endif
+        ccnl_wheel_schedule(&relay->cs_wheel, l, ccnl_content_deadline(c));
     }
-    while (i) { // CONFORM: "Entries in the PIT MUST timeout rather
-                // than being held indefinitely."
-        if ((i->last_used + i->lifetime) <= (uint32_t) t ||
+    while ((l = ccnl_wheel_expire(&relay->pit_wheel, t))) {
+        // CONFORM: "Entries in the PIT MUST timeout rather
+        // than being held indefinitely."
+        i = CCNL_WHEEL_ENTRY(l, struct ccnl_interest_s, wlink);
+        if ((i->last_used + i->lifetime) <= t ||
                                 i->retries >= CCNL_MAX_INTEREST_RETRANSMIT) {
                 DEBUGMSG_AGEING("AGING: REMOVE INTEREST", "timeout: remove interest", s, CCNL_MAX_PREFIX_SIZE);
-                i = ccnl_interest_remove(relay, i);
+                ccnl_interest_remove(relay, i);
         } else {
             // CONFORM: "A node MUST retransmit Interest Messages
             // periodically for pending PIT entries."
@@ -755,44 +1010,115 @@ ccnl_do_ageing(void *ptr, void *dummy)
                 ccnl_interest_propagate(relay, i);
 
             i->retries++;
-            i = i->next;
+            ccnl_wheel_schedule(&relay->pit_wheel, l,
+                                ccnl_interest_deadline(i, t, period));
         }
     }
-    while (f) {
-        if (!(f->flags & CCNL_FACE_FLAGS_STATIC) &&
-                (f->last_used + CCNL_FACE_TIMEOUT) <= t){
+    while ((l = ccnl_wheel_expire(&relay->face_wheel, t))) {
+        f = CCNL_WHEEL_ENTRY(l, struct ccnl_face_s, wlink);
+        if (f->flags & CCNL_FACE_FLAGS_STATIC) {
+            continue;
+        }
+        if ((uint32_t) (f->last_used + CCNL_FACE_TIMEOUT) <= t) {
             DEBUGMSG_CORE(TRACE, "AGING: FACE REMOVE %p\n", (void*) f);
-            f = ccnl_face_remove(relay, f);
+            ccnl_face_remove(relay, f);
         } else {
-            f = f->next;
+            ccnl_wheel_schedule(&relay->face_wheel, l,
+                                f->last_used + CCNL_FACE_TIMEOUT);
         }
     }
 }
 
+static void
+ccnl_nonce_forget_oldest(struct ccnl_relay_s *ccnl)
+{
+    ccnl_htable_remove(&ccnl->nonce_index,
+                       &ccnl->nonces[ccnl->nonce_first].hlink);
+    ccnl->nonce_first = (ccnl->nonce_first + 1) % ccnl->noncesize;
+    ccnl->noncecnt--;
+}
+
+/* doubles the nonce ring, within the relay's bound; the nonces keep their
+   order and start at slot 0 */
+static int
+ccnl_nonce_grow(struct ccnl_relay_s *ccnl)
+{
+    int max = ccnl->max_nonces > 0 ? ccnl->max_nonces : CCNL_MAX_NONCES;
+    int size = ccnl->noncesize ? 2 * ccnl->noncesize : CCNL_NONCE_RING_MIN;
+    struct ccnl_nonce_s *ring;
+    int k;
+
+    if (ccnl->noncesize >= max) {
+        return -1;
+    }
+    if (size > max) {
+        size = max;
+    }
+    ring = (struct ccnl_nonce_s *) ccnl_calloc(size, sizeof(*ring));
+    if (!ring) {
+        return -1;
+    }
+    for (k = 0; k < ccnl->noncecnt; k++) {
+        struct ccnl_nonce_s *n = ccnl->nonces +
+                                 (ccnl->nonce_first + k) % ccnl->noncesize;
+
+        ccnl_htable_remove(&ccnl->nonce_index, &n->hlink);
+        ring[k] = *n;
+        // does not fail: the table had room for the nonce before
+        ccnl_htable_add(&ccnl->nonce_index, &ring[k].hlink, n->hlink.hash);
+    }
+    ccnl_free(ccnl->nonces);
+    ccnl->nonces = ring;
+    ccnl->noncesize = size;
+    ccnl->nonce_first = 0;
+    return 0;
+}
+
 int
 ccnl_nonce_find_or_append(struct ccnl_relay_s *ccnl, struct ccnl_buf_s *nonce)
 {
-    struct ccnl_buf_s *n, *n2 = 0;
-    int i;
+    struct ccnl_nonce_s *n;
+    struct ccnl_hlink_s *l;
+    size_t len = nonce->datalen < CCNL_NONCE_MAXLEN ? nonce->datalen
+                                                    : CCNL_NONCE_MAXLEN;
+    uint32_t h = ccnl_hash_bytes(CCNL_HASH_INIT, nonce->data, nonce->datalen);
+    int t = CCNL_NOW();
+    int window = ccnl->nonce_window > 0 ? ccnl->nonce_window
+                                        : CCNL_NONCE_TIMEOUT;
     DEBUGMSG_CORE(TRACE, "ccnl_nonce_find_or_append\n");
 
-    for (n = ccnl->nonces, i = 0; n; n = n->next, i++) {
-        if (buf_equal(n, nonce)) {
+    if (CCNL_MAX_NONCES <= 0) {
+        return 0;
+    }
+    if (!ccnl->nonces && ccnl_nonce_grow(ccnl)) {
+        return 0;
+    }
+
+    // the ring is in arrival order: nonces which left the window are in front
+    while (ccnl->noncecnt &&
+           ccnl->nonces[ccnl->nonce_first].last_used + window <= t) {
+        ccnl_nonce_forget_oldest(ccnl);
+    }
+
+    for (l = ccnl_htable_first(&ccnl->nonce_index, h); l; l = ccnl_htable_next(l)) {
+        n = CCNL_HTABLE_ENTRY(l, struct ccnl_nonce_s, hlink);
+        if (n->len == len && !memcmp(n->data, nonce->data, len)) {
             return -1;
         }
-        if (n->next) {
-            n2 = n;
-        }
     }
-    n = ccnl_buf_new(nonce->data, nonce->datalen);
-    if (n) {
-        n->next = ccnl->nonces;
-        ccnl->nonces = n;
-        if (i >= CCNL_MAX_NONCES && n2) {
-            ccnl_free(n2->next);
-            n2->next = 0;
-        }
+
+    // more nonces arrive in a window than the ring holds
+    if (ccnl->noncecnt == ccnl->noncesize && ccnl_nonce_grow(ccnl)) {
+        ccnl_nonce_forget_oldest(ccnl);
     }
+    n = ccnl->nonces + (ccnl->nonce_first + ccnl->noncecnt) % ccnl->noncesize;
+    if (ccnl_htable_add(&ccnl->nonce_index, &n->hlink, h)) {
+        return 0;
+    }
+    n->last_used = t;
+    n->len = (uint8_t) len;
+    memcpy(n->data, nonce->data, len);
+    ccnl->noncecnt++;
     return 0;
 }
 
@@ -825,6 +1151,98 @@ ccnl_nonce_isDup(struct ccnl_relay_s *relay, struct ccnl_pkt_s *pkt)
     return 0;
 }
 
+/* keep the face's list of FIB entries pointing at it */
+static void
+ccnl_fib_link_face(struct ccnl_forward_s *fwd)
+{
+    if (fwd->face) {
+        fwd->face_next = fwd->face->fwds;
+        if (fwd->face->fwds) {
+            fwd->face->fwds->face_pprev = &fwd->face_next;
+        }
+        fwd->face->fwds = fwd;
+        fwd->face_pprev = &fwd->face->fwds;
+    }
+}
+
+static void
+ccnl_fib_unlink_face(struct ccnl_forward_s *fwd)
+{
+    if (fwd->face_pprev) {
+        *fwd->face_pprev = fwd->face_next;
+        if (fwd->face_next) {
+            fwd->face_next->face_pprev = fwd->face_pprev;
+        }
+        fwd->face_next = NULL;
+        fwd->face_pprev = NULL;
+    }
+}
+
+/* whether the FIB may point at face */
+static int
+ccnl_fib_face_ok(struct ccnl_relay_s *relay, struct ccnl_face_s *face)
+{
+    if (face && face->ifndx < 0 && relay->fib_ifaces_only) {
+        DEBUGMSG_CORE(ERROR, "no route over face %d, which has no interface\n",
+                      face->faceid);
+        return 0;
+    }
+    return 1;
+}
+
+int
+ccnl_fib_link(struct ccnl_relay_s *relay, struct ccnl_forward_s *fwd)
+{
+    if (!ccnl_fib_face_ok(relay, fwd->face)) {
+        return -1;
+    }
+    if (fwd->prefix) {
+        if (fwd->prefix->compcnt > CCNL_MAX_NAME_COMP) {
+            return -1;
+        }
+        if (ccnl_htable_add(&relay->fib_index, &fwd->hlink,
+                    ccnl_prefix_hash(fwd->prefix, fwd->prefix->compcnt))) {
+            return -1;
+        }
+        relay->fib_lencnt[fwd->prefix->compcnt]++;
+    }
+    fwd->prev = NULL;
+    DBL_LINKED_LIST_ADD(relay->fib, fwd);
+    ccnl_fib_link_face(fwd);
+    relay->fib_epoch++;
+    return 0;
+}
+
+void
+ccnl_fib_unlink(struct ccnl_relay_s *relay, struct ccnl_forward_s *fwd)
+{
+    if (fwd->prefix && !ccnl_htable_remove(&relay->fib_index, &fwd->hlink)) {
+        relay->fib_lencnt[fwd->prefix->compcnt]--;
+    }
+    DBL_LINKED_LIST_REMOVE(relay->fib, fwd);
+    fwd->next = fwd->prev = NULL;
+    ccnl_fib_unlink_face(fwd);
+    relay->fib_epoch++;
+}
+
+struct ccnl_forward_s*
+ccnl_fib_find(struct ccnl_relay_s *relay, struct ccnl_prefix_s *pfx)
+{
+    struct ccnl_hlink_s *l;
+
+    for (l = ccnl_htable_first(&relay->fib_index,
+                               ccnl_prefix_hash(pfx, pfx->compcnt));
+         l; l = ccnl_htable_next(l)) {
+        struct ccnl_forward_s *fwd = CCNL_HTABLE_ENTRY(l, struct ccnl_forward_s,
+                                                       hlink);
+        if (fwd->suite == pfx->suite &&
+                        !ccnl_prefix_cmp(fwd->prefix, NULL, pfx, CMP_EXACT)) {
+            return fwd;
+        }
+    }
+    return NULL;
+}
+
 #ifdef NEEDS_PREFIX_MATCHING
 
 /* add a new entry to the FIB */
@@ -832,35 +1250,38 @@ int
 ccnl_fib_add_entry(struct ccnl_relay_s *relay, struct ccnl_prefix_s *pfx,
                    struct ccnl_face_s *face)
 {
-    struct ccnl_forward_s *fwd, **fwd2;
+    struct ccnl_forward_s *fwd;
     char s[CCNL_MAX_PREFIX_SIZE];
     (void) s;
 
     DEBUGMSG_CUTL(INFO, "adding FIB for <%s>, suite %s\n",
              ccnl_prefix_to_str(pfx,s,CCNL_MAX_PREFIX_SIZE), ccnl_suite2str(pfx->suite));
 
-    for (fwd = relay->fib; fwd; fwd = fwd->next) {
-        if (fwd->suite == pfx->suite &&
-                        !ccnl_prefix_cmp(fwd->prefix, NULL, pfx, CMP_EXACT)) {
-            ccnl_prefix_free(fwd->prefix);
-            fwd->prefix = NULL;
-            break;
+    fwd = ccnl_fib_find(relay, pfx);
+    if (fwd) {
+        if (!ccnl_fib_face_ok(relay, face)) {
+            return -1;
         }
-    }
-    if (!fwd) {
+        // same key, the entry stays where it is in the index
+        ccnl_prefix_free(fwd->prefix);
+        fwd->prefix = pfx;
+        ccnl_fib_unlink_face(fwd);
+        fwd->face = face;
+        ccnl_fib_link_face(fwd);
+        relay->fib_epoch++;
+    } else {
         fwd = (struct ccnl_forward_s *) ccnl_calloc(1, sizeof(*fwd));
         if (!fwd) {
             return -1;
         }
-        fwd2 = &relay->fib;
-        while (*fwd2) {
-            fwd2 = &((*fwd2)->next);
-        }
-        *fwd2 = fwd;
+        fwd->prefix = pfx;
         fwd->suite = pfx->suite;
+        fwd->face = face;
+        if (ccnl_fib_link(relay, fwd)) {
+            ccnl_free(fwd);
+            return -1;
+        }
     }
-    fwd->prefix = pfx;
-    fwd->face = face;
     DEBUGMSG_CUTL(DEBUG, "added FIB via %s\n", ccnl_addr2ascii(&fwd->face->peer));
 
     return 0;
@@ -873,37 +1294,39 @@ ccnl_fib_rem_entry(struct ccnl_relay_s *relay, struct ccnl_prefix_s *pfx,
 {
     struct ccnl_forward_s *fwd;
     int res = -1;
-    struct ccnl_forward_s *last = NULL;
     char s[CCNL_MAX_PREFIX_SIZE];
     (void) s;
 
     if (pfx != NULL) {
-        char *s = NULL;
+        struct ccnl_hlink_s *l;
+
         DEBUGMSG_CUTL(INFO, "removing FIB for <%s>, suite %s\n",
                       ccnl_prefix_to_str(pfx,s,CCNL_MAX_PREFIX_SIZE), ccnl_suite2str(pfx->suite));
-    }
 
-    for (fwd = relay->fib; fwd; last = fwd, fwd = fwd->next) {
-        if (((pfx == NULL) || (fwd->suite == pfx->suite)) &&
-            ((pfx == NULL) || !ccnl_prefix_cmp(fwd->prefix, NULL, pfx, CMP_EXACT)) &&
-            ((face == NULL) || (fwd->face == face))) {
-            res = 0;
-            if (!last) {
-                relay->fib = fwd->next;
-            }
-            else {
-                last->next = fwd->next;
+        fwd = NULL;
+        for (l = ccnl_htable_first(&relay->fib_index,
+                                   ccnl_prefix_hash(pfx, pfx->compcnt));
+             l; l = ccnl_htable_next(l)) {
+            fwd = CCNL_HTABLE_ENTRY(l, struct ccnl_forward_s, hlink);
+            if ((fwd->suite == pfx->suite) &&
+                !ccnl_prefix_cmp(fwd->prefix, NULL, pfx, CMP_EXACT) &&
+                ((face == NULL) || (fwd->face == face))) {
+                break;
             }
-            ccnl_prefix_free(fwd->prefix);
-            ccnl_free(fwd);
-            break;
+            fwd = NULL;
         }
+    } else {
+        fwd = face ? face->fwds : relay->fib;
     }
 
     if (fwd) {
+        res = 0;
         if (fwd->face) {
-            DEBUGMSG_CUTL(DEBUG, "added FIB via %s\n", ccnl_addr2ascii(&fwd->face->peer));
+            DEBUGMSG_CUTL(DEBUG, "removed FIB via %s\n", ccnl_addr2ascii(&fwd->face->peer));
         }
+        ccnl_fib_unlink(relay, fwd);
+        ccnl_prefix_free(fwd->prefix);
+        ccnl_free(fwd);
     }
 
     return res;
@@ -961,38 +1384,52 @@ ccnl_cs_dump(struct ccnl_relay_s *ccnl)
 #endif
 }
 
+int
+ccnl_interface_dequeue(struct ccnl_if_s *ifc, struct ccnl_txrequest_s *req)
+{
+    if (ifc->qlen <= 0) {
+        return -1;
+    }
+    memcpy(req, ifc->queue + ifc->qfront, sizeof(*req));
+    ifc->qfront = (ifc->qfront + 1) % CCNL_MAX_IF_QLEN;
+    ifc->qlen--;
+    return 0;
+}
+
+void
+ccnl_interface_tx_done(struct ccnl_if_s *ifc, struct ccnl_txrequest_s *req)
+{
+#ifdef USE_STATS
+    ifc->tx_cnt++;
+#endif
+#ifdef USE_SCHEDULER
+    ccnl_sched_CTS_done(ifc->sched, 1, req->buf->datalen);
+    if (req->txdone)
+        req->txdone(req->txdone_face, 1, req->buf->datalen);
+#else
+    (void) ifc;
+#endif
+    ccnl_buf_free(req->buf);
+}
+
 void
 ccnl_interface_CTS(void *aux1, void *aux2)
 {
     struct ccnl_relay_s *ccnl = (struct ccnl_relay_s *)aux1;
     struct ccnl_if_s *ifc = (struct ccnl_if_s *)aux2;
-    struct ccnl_txrequest_s *r, req;
+    struct ccnl_txrequest_s req;
 
     DEBUGMSG_CORE(TRACE, "interface_CTS interface=%p, qlen=%zu, sched=%p\n",
              (void*)ifc, ifc->qlen, (void*)ifc->sched);
 
-    if (ifc->qlen <= 0) {
+    if (ccnl_interface_dequeue(ifc, &req)) {
         return;
     }
-
-#ifdef USE_STATS
-    ifc->tx_cnt++;
-#endif
-
-    r = ifc->queue + ifc->qfront;
-    memcpy(&req, r, sizeof(req));
-    ifc->qfront = (ifc->qfront + 1) % CCNL_MAX_IF_QLEN;
-    ifc->qlen--;
 #ifndef CCNL_LINUXKERNEL
     assert(ccnl->ccnl_ll_TX_ptr != 0);
 #endif
     ccnl->ccnl_ll_TX_ptr(ccnl, ifc, &req.dst, req.buf);
-#ifdef USE_SCHEDULER
-    ccnl_sched_CTS_done(ifc->sched, 1, req.buf->datalen);
-    if (req.txdone)
-        req.txdone(req.txdone_face, 1, req.buf->datalen);
-#endif
-    ccnl_free(req.buf);
+    ccnl_interface_tx_done(ifc, &req);
 }
 
 int
@@ -22,6 +22,7 @@
 
 #ifndef CCNL_LINUXKERNEL
 #include "ccnl-sockunion.h"
+#include "ccnl-htable.h"
 #include <stdio.h>
 #include <arpa/inet.h>
 #include <string.h>
@@ -29,6 +30,7 @@
 #else
 #include <ccnl-logging.h>
 #include <ccnl-sockunion.h>
+#include <ccnl-htable.h>
 #endif
 
 int
@@ -62,10 +64,10 @@ char*
 ccnl_addr2ascii(sockunion *su)
 {
 #ifdef USE_UNIXSOCKET
-    static char result[256];
+    static CCNL_THREAD_LOCAL char result[256];
 #else
     /* each byte requires 2 chars + 1 for the colon/slash + 6 for the protocol + 1 for \0 */
-    static char result[(CCNL_MAX_ADDRESS_LEN * 3) + 7];
+    static CCNL_THREAD_LOCAL char result[(CCNL_MAX_ADDRESS_LEN * 3) + 7];
 #endif
 
     if (!su)
@@ -192,12 +194,60 @@ ccnl_addr_cmp(sockunion *s1, sockunion *s2)
     return -1;
 }
 
+uint32_t
+ccnl_addr_hash(uint32_t h, sockunion *su)
+{
+    h = ccnl_hash_uint(h, (uint32_t) su->sa.sa_family);
+    switch (su->sa.sa_family) {
+
+#if defined(USE_LINKLAYER) && \
+    ((!defined(__FreeBSD__) && !defined(__APPLE__)) || \
+    (defined(CCNL_RIOT) && defined(__FreeBSD__)) ||  \
+    (defined(CCNL_RIOT) && defined(__APPLE__)) )
+        case AF_PACKET:
+            return ccnl_hash_bytes(h, su->linklayer.sll_addr,
+                                   su->linklayer.sll_halen);
+#endif
+#ifdef USE_WPAN
+        case AF_IEEE802154:
+            h = ccnl_hash_uint(h, (uint32_t) su->wpan.addr.addr_type);
+            h = ccnl_hash_uint(h, su->wpan.addr.pan_id);
+            switch (su->wpan.addr.addr_type) {
+                case IEEE802154_ADDR_SHORT:
+                    return ccnl_hash_uint(h, su->wpan.addr.addr.short_addr);
+                case IEEE802154_ADDR_LONG:
+                    return ccnl_hash_bytes(h, su->wpan.addr.addr.hwaddr,
+                                           sizeof(su->wpan.addr.addr.hwaddr));
+            }
+            return h;
+#endif
+#ifdef USE_IPV4
+        case AF_INET:
+            h = ccnl_hash_bytes(h, &su->ip4.sin_addr.s_addr,
+                                sizeof(su->ip4.sin_addr.s_addr));
+            return ccnl_hash_bytes(h, &su->ip4.sin_port, sizeof(su->ip4.sin_port));
+#endif
+#ifdef USE_IPV6
+        case AF_INET6:
+            h = ccnl_hash_bytes(h, su->ip6.sin6_addr.s6_addr, 16);
+            return ccnl_hash_bytes(h, &su->ip6.sin6_port, sizeof(su->ip6.sin6_port));
+#endif
+#ifdef USE_UNIXSOCKET
+        case AF_UNIX:
+            return ccnl_hash_bytes(h, su->ux.sun_path, strlen(su->ux.sun_path));
+#endif
+        default:
+            break;
+    }
+    return h;
+}
+
 char*
 ll2ascii(unsigned char *addr, size_t len)
 {
     if ((len <= CCNL_LLADDR_STR_MAX_LEN) && (addr)) {
         size_t i;
-        static char out[CCNL_LLADDR_STR_MAX_LEN + 1] = { 0 };
+        static CCNL_THREAD_LOCAL char out[CCNL_LLADDR_STR_MAX_LEN + 1] = { 0 };
 
         out[0] = '\0';
 
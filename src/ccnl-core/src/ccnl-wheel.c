@@ -0,0 +1,112 @@
+/*
+ * @f ccnl-wheel.c
+ * @b CCN lite, hashed timing wheel for the relay's timeouts
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * File history:
+ * 2018-09-05 created
+ */
+
+#ifndef CCNL_LINUXKERNEL
+#include "ccnl-wheel.h"
+#include "ccnl-malloc.h"
+#else
+#include <ccnl-wheel.h>
+#include <ccnl-malloc.h>
+#endif
+
+#define CCNL_WHEEL_MASK             (CCNL_WHEEL_SIZE - 1)
+
+/* wrap-around safe "a is before b" */
+#define CCNL_WHEEL_BEFORE(a, b)     ((int32_t) ((a) - (b)) < 0)
+
+int
+ccnl_wheel_schedule(struct ccnl_wheel_s *wheel, struct ccnl_wlink_s *link,
+                    uint32_t deadline)
+{
+    struct ccnl_wlink_s **slot;
+
+    if (!wheel->slots) {
+        wheel->slots = (struct ccnl_wlink_s **) ccnl_calloc(CCNL_WHEEL_SIZE,
+                                                   sizeof(*wheel->slots));
+        if (!wheel->slots) {
+            return -1;
+        }
+    }
+    ccnl_wheel_cancel(link);
+
+    link->deadline = deadline;
+    if (CCNL_WHEEL_BEFORE(deadline, wheel->cursor)) {
+        deadline = wheel->cursor;
+    }
+    slot = wheel->slots + (deadline & CCNL_WHEEL_MASK);
+    link->next = *slot;
+    if (*slot) {
+        (*slot)->pprev = &link->next;
+    }
+    link->pprev = slot;
+    *slot = link;
+    return 0;
+}
+
+void
+ccnl_wheel_cancel(struct ccnl_wlink_s *link)
+{
+    if (!link->pprev) {
+        return;
+    }
+    *link->pprev = link->next;
+    if (link->next) {
+        link->next->pprev = link->pprev;
+    }
+    link->next = NULL;
+    link->pprev = NULL;
+}
+
+struct ccnl_wlink_s*
+ccnl_wheel_expire(struct ccnl_wheel_s *wheel, uint32_t now)
+{
+    struct ccnl_wlink_s *l;
+
+    if (!wheel->slots) {
+        wheel->cursor = now;
+        return NULL;
+    }
+    /* after a long pause every slot has to be visited, but only once */
+    if ((uint32_t) (now - wheel->cursor) >= CCNL_WHEEL_SIZE &&
+        CCNL_WHEEL_BEFORE(wheel->cursor, now)) {
+        wheel->cursor = now - CCNL_WHEEL_MASK;
+    }
+    for (;;) {
+        for (l = wheel->slots[wheel->cursor & CCNL_WHEEL_MASK]; l; l = l->next) {
+            if (!CCNL_WHEEL_BEFORE(now, l->deadline)) {
+                ccnl_wheel_cancel(l);
+                return l;
+            }
+        }
+        if (!CCNL_WHEEL_BEFORE(wheel->cursor, now)) {
+            return NULL;
+        }
+        wheel->cursor++;
+    }
+}
+
+void
+ccnl_wheel_free(struct ccnl_wheel_s *wheel)
+{
+    ccnl_free(wheel->slots);
+    wheel->slots = NULL;
+}
@@ -48,5 +48,21 @@ void
 ccnl_core_RX(struct ccnl_relay_s *relay, int ifndx, uint8_t *data,
              size_t datalen, struct sockaddr *sa, size_t addrlen);
 
+/**
+ * @brief       Like \ref ccnl_core_RX, for a frame in a buffer of its own
+ *
+ * If the frame is a single packet, the packet keeps the buffer instead of
+ * a copy of it. Either way, the buffer belongs to the relay afterwards.
+ *
+ * @param[in] relay     pointer to current ccnl relay
+ * @param[in] ifndx     index of the interface from which the data were received
+ * @param[in] buf       the received frame
+ * @param[in] sa        socketaddress from which the packet was received
+ * @param[in] addrlen   length of the socketaddress
+ */
+void
+ccnl_core_RX_buf(struct ccnl_relay_s *relay, int ifndx, struct ccnl_buf_s *buf,
+                 struct sockaddr *sa, size_t addrlen);
+
 #endif
 /** @} */
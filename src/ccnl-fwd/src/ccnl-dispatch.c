@@ -101,6 +101,17 @@ ccnl_core_RX(struct ccnl_relay_s *relay, int ifndx, uint8_t *data,
     }
 }
 
+void
+ccnl_core_RX_buf(struct ccnl_relay_s *relay, int ifndx, struct ccnl_buf_s *buf,
+                 struct sockaddr *sa, size_t addrlen)
+{
+    ccnl_buf_offer(buf);
+    ccnl_core_RX(relay, ifndx, buf->data, buf->datalen, sa, addrlen);
+    if (ccnl_buf_offer(NULL)) { // not adopted by a packet
+        ccnl_buf_free(buf);
+    }
+}
+
 // ----------------------------------------------------------------------
 
 void
@@ -92,6 +92,7 @@ ccnl_echo_cleanup(struct ccnl_relay_s *relay)
     for (fwd = relay->fib; fwd; fwd = fwd->next) {
         if (fwd->tap == ccnl_echo_request) {
             fwd->tap = NULL;
+            relay->fib_epoch++;
 /*
             if (fwd->face == NULL) { // remove this entry
                 ccnl_prefix_free(fwd->prefix);
@@ -90,11 +90,9 @@ ccnl_fwd_handleContent(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
     }
 
     // CONFORM: Step 1:
-    for (c = relay->contents; c; c = c->next) {
-        if (ccnl_prefix_cmp(c->pkt->pfx, NULL, (*pkt)->pfx, CMP_EXACT) == 0) {
-            DEBUGMSG_CFWD(TRACE, "  content is duplicate, ignoring\n");
-            return 0; // content is dup, do nothing
-        }
+    if (ccnl_content_find(relay, (*pkt)->pfx)) {
+        DEBUGMSG_CFWD(TRACE, "  content is duplicate, ignoring\n");
+        return 0; // content is dup, do nothing
     }
 
     c = ccnl_content_new(pkt);
@@ -102,16 +100,24 @@ ccnl_fwd_handleContent(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
         return 0;
     }
 
-    if (!ccnl_content_serve_pending(relay, c)) { // unsolicited content
+    if (!ccnl_content_serve_pending(relay, c) &&
+        !(from && (from->flags & CCNL_FACE_FLAGS_APP))) { // unsolicited content
         // CONFORM: "A node MUST NOT forward unsolicited data [...]"
+        // (what the local application produces is cached nevertheless)
         DEBUGMSG_CFWD(DEBUG, "  removed because no matching interest\n");
         ccnl_content_free(c);
         return 0;
     }
 
-    if (relay->max_cache_entries != 0) { // it's set to -1 or a limit
+    // the Content Store looks at the freshness: decode what was left
+    if (relay->max_cache_entries != 0 && // it's set to -1 or a limit
+        !ccnl_pkt_decode_rest(c->pkt)) {
         DEBUGMSG_CFWD(DEBUG, "  adding content to cache\n");
-        ccnl_content_add2cache(relay, c);
+        if (!ccnl_content_add2cache(relay, c)) {
+            DEBUGMSG_CFWD(DEBUG, "  content not added to cache\n");
+            ccnl_content_free(c);
+            return 0;
+        }
         int contlen = (int) (c->pkt->contlen > INT_MAX ? INT_MAX : c->pkt->contlen);
         DEBUGMSG_CFWD(INFO, "data after creating packet %.*s\n", contlen, c->pkt->content);
     } else {
@@ -183,7 +189,7 @@ ccnl_fwd_handleInterest(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
 {
     struct ccnl_interest_s *i;
     struct ccnl_content_s *c;
-    int propagate= 0;
+    int propagate= 0, exact_only = 0;
     char s[CCNL_MAX_PREFIX_SIZE];
     (void) s;
     int32_t nonce = 0;
@@ -245,21 +251,39 @@ ccnl_fwd_handleInterest(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
             // Step 1: search in content store
     DEBUGMSG_CFWD(DEBUG, "  searching in CS\n");
 
-    for (c = relay->contents; c; c = c->next) {
-        if (c->pkt->pfx->suite != (*pkt)->pfx->suite)
-            continue;
-        if (cMatch(*pkt, c))
-            continue;
+    // try the content with exactly the interest's name first
+    c = ccnl_content_find(relay, (*pkt)->pfx);
+    if (c && cMatch(*pkt, c)) {
+        c = NULL;
+    }
+#ifdef USE_SUITE_CCNTLV
+    // CCNx only matches exact names, the other suites can select longer ones
+    if ((*pkt)->pfx->suite == CCNL_SUITE_CCNTLV) {
+        exact_only = 1;
+    }
+#endif
+    if (!c && !exact_only) {
+        for (c = relay->contents; c; c = c->next) {
+            if (c->pkt->pfx->suite != (*pkt)->pfx->suite)
+                continue;
+            if (!cMatch(*pkt, c))
+                break;
+        }
+    }
 
+    if (c) {
         DEBUGMSG_CFWD(DEBUG, "  found matching content %p\n", (void *) c);
+        ccnl_content_touch(relay, c);
 
         if (from) {
             if (from->ifndx >= 0) {
                 ccnl_send_pkt(relay, from, c->pkt);
             } else {
-#ifdef CCNL_APP_RX 
+#ifdef CCNL_APP_RX
                 ccnl_app_RX(relay, c);
-#endif 
+#else
+                ccnl_callback_app_rx(relay, c);
+#endif
             }
         }
 
@@ -267,9 +291,7 @@ ccnl_fwd_handleInterest(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
     }
 
     // CONFORM: Step 2: check whether interest is already known
-    for (i = relay->pit; i; i = i->next)
-        if (ccnl_interest_isSame(i, *pkt))
-            break;
+    i = ccnl_interest_find(relay, *pkt);
 
     if (!i) { // this is a new/unknown I request: create and propagate
         propagate = 1;
@@ -406,7 +428,7 @@ ccnl_ccntlv_forwarder(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
     size_t payloadlen;
     size_t hdrlen;
     struct ccnx_tlvhdr_ccnx2015_s *hp;
-    uint8_t *start = *data;
+    uint8_t *start = *data, pkttype;
     struct ccnl_pkt_s *pkt;
 
     DEBUGMSG_CFWD(DEBUG, "ccnl_ccntlv_forwarder: %zuB from face=%p (id=%d.%d)\n",
@@ -418,6 +440,9 @@ ccnl_ccntlv_forwarder(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
     }
 
     hp = (struct ccnx_tlvhdr_ccnx2015_s*) *data;
+    // the receive buffer, with the header in it, may be handed to the pkt:
+    // what is needed after decoding is read now
+    pkttype = hp->pkttype;
     hdrlen = hp->hdrlen; // ntohs(hp->hdrlen);
     if (hdrlen > *datalen) { // not enough bytes for a full header
         DEBUGMSG_CFWD(DEBUG, "  hdrlen too large (%zu > %zu)\n",
@@ -436,11 +461,11 @@ ccnl_ccntlv_forwarder(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
     *data += hdrlen;
     *datalen -= hdrlen;
 
-    if (hp->pkttype == CCNX_PT_Interest ||
+    if (pkttype == CCNX_PT_Interest ||
 #ifdef USE_FRAG
-        hp->pkttype == CCNX_PT_Fragment ||
+        pkttype == CCNX_PT_Fragment ||
 #endif
-        hp->pkttype == CCNX_PT_NACK) {
+        pkttype == CCNX_PT_NACK) {
         hp->hoplimit--;
         if (hp->hoplimit <= 0) { // drop it
             DEBUGMSG_CFWD(DEBUG, "  pkt dropped because of hop limit\n");
@@ -454,7 +479,7 @@ ccnl_ccntlv_forwarder(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
                   *datalen, hdrlen);
 
 #ifdef USE_FRAG
-    if (hp->pkttype == CCNX_PT_Fragment) {
+    if (pkttype == CCNX_PT_Fragment) {
         uint16_t *sp = (uint16_t*) *data;
         int fraglen = ntohs(*(sp+1));
 
@@ -490,7 +515,7 @@ ccnl_ccntlv_forwarder(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
         DEBUGMSG_CFWD(TRACE, "  local data, datalen=%zu\n", *datalen);
     }
 
-    pkt = ccnl_ccntlv_bytes2pkt(start, data, datalen);
+    pkt = ccnl_ccntlv_decode(start, data, datalen, CCNL_DECODE_LAZY);
     if (!pkt) {
         DEBUGMSG_CFWD(WARNING, "  parsing error or no prefix\n");
         goto Done;
@@ -501,7 +526,7 @@ ccnl_ccntlv_forwarder(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
     }
 
 
-    if (hp->pkttype == CCNX_PT_Interest) {
+    if (pkttype == CCNX_PT_Interest) {
         if (pkt->type == CCNX_TLV_TL_Interest) {
             pkt->flags |= CCNL_PKT_REQUEST;
             // DEBUGMSG_CFWD(DEBUG, "  interest=<%s>\n", ccnl_prefix_to_path(pkt->pfx));
@@ -509,15 +534,15 @@ ccnl_ccntlv_forwarder(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
                 goto Done;
         } else {
             DEBUGMSG_CFWD(WARNING, "  ccntlv: interest pkt type mismatch %d %lld\n",
-                          hp->pkttype, (unsigned long long) pkt->type);
+                          pkttype, (unsigned long long) pkt->type);
         }
-    } else if (hp->pkttype == CCNX_PT_Data) {
+    } else if (pkttype == CCNX_PT_Data) {
         if (pkt->type == CCNX_TLV_TL_Object) {
             pkt->flags |= CCNL_PKT_REPLY;
             ccnl_fwd_handleContent(relay, from, &pkt);
         } else {
             DEBUGMSG_CFWD(WARNING, "  ccntlv: data pkt type mismatch %d %lld\n",
-                     hp->pkttype, (unsigned long long) pkt->type);
+                     pkttype, (unsigned long long) pkt->type);
         }
     } // else ignore
     rc = 0;
@@ -551,7 +576,8 @@ ccnl_ndntlv_forwarder(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
         DEBUGMSG_CFWD(TRACE, "  invalid packet format\n");
         return -1;
     }
-    pkt = ccnl_ndntlv_bytes2pkt(typ, start, data, datalen);
+    pkt = ccnl_ndntlv_decode(typ, start, data, datalen,
+                             CCNL_DECODE_ARENA | CCNL_DECODE_LAZY);
     if (!pkt) {
         DEBUGMSG_CFWD(INFO, "  ndntlv packet coding problem\n");
         goto Done;
@@ -594,7 +620,7 @@ int
 ccnl_set_tap(struct ccnl_relay_s *relay, struct ccnl_prefix_s *pfx,
              tapCallback callback)
 {
-    struct ccnl_forward_s *fwd, **fwd2;
+    struct ccnl_forward_s *fwd;
     char s[CCNL_MAX_PREFIX_SIZE];
     (void) s;
 
@@ -602,25 +628,23 @@ ccnl_set_tap(struct ccnl_relay_s *relay, struct ccnl_prefix_s *pfx,
              ccnl_prefix_to_str(pfx,s,CCNL_MAX_PREFIX_SIZE),
              ccnl_suite2str(pfx->suite));
 
-    for (fwd = relay->fib; fwd; fwd = fwd->next) {
-        if (fwd->suite == pfx->suite &&
-                        !ccnl_prefix_cmp(fwd->prefix, NULL, pfx, CMP_EXACT)) {
-            ccnl_prefix_free(fwd->prefix);
-            fwd->prefix = NULL;
-            break;
-        }
-    }
-    if (!fwd) {
+    fwd = ccnl_fib_find(relay, pfx);
+    if (fwd) {
+        // same key, the entry stays where it is in the index
+        ccnl_prefix_free(fwd->prefix);
+        fwd->prefix = pfx;
+        relay->fib_epoch++;
+    } else {
         fwd = (struct ccnl_forward_s *) ccnl_calloc(1, sizeof(*fwd));
         if (!fwd)
             return -1;
-        fwd2 = &relay->fib;
-        while (*fwd2)
-            fwd2 = &((*fwd2)->next);
-        *fwd2 = fwd;
+        fwd->prefix = pfx;
         fwd->suite = pfx->suite;
+        if (ccnl_fib_link(relay, fwd)) {
+            ccnl_free(fwd);
+            return -1;
+        }
     }
-    fwd->prefix = pfx;
     fwd->tap = callback;
     return 0;
 }
@@ -179,6 +179,48 @@ ccnl_ccntlv_dehead(uint8_t **buf, size_t *len,
 struct ccnl_pkt_s*
 ccnl_ccntlv_bytes2pkt(uint8_t *start, uint8_t **data, size_t *datalen);
 
+/**
+ * @brief Decodes a packet as \ref ccnl_ccntlv_bytes2pkt does, with options
+ *
+ * With CCNL_DECODE_LAZY, the end chunk and the validation TLVs are left to
+ * \ref ccnl_pkt_decode_rest.
+ *
+ * @param[in] start     the start of the packet, with its fixed header
+ * @param[in,out] data  the message, advanced past the packet
+ * @param[in,out] datalen length of the message, 0 after the packet
+ * @param[in] opts      CCNL_DECODE_* options, other than CCNL_DECODE_ARENA
+ *
+ * @return the decoded packet, NULL if it is malformed or out of memory
+ */
+struct ccnl_pkt_s*
+ccnl_ccntlv_decode(uint8_t *start, uint8_t **data, size_t *datalen,
+                   unsigned int opts);
+
+/**
+ * @brief Decodes what \ref ccnl_ccntlv_decode left with CCNL_DECODE_LAZY,
+ *        see \ref ccnl_pkt_decode_rest
+ */
+int8_t
+ccnl_ccntlv_decode_rest(struct ccnl_pkt_s *pkt);
+
+/**
+ * @brief Hashes the name of a packet (with its fixed header) without parsing it
+ *
+ * Like \ref ccnl_ndntlv_name_hashes, for Interests, Content Objects and
+ * Interest Returns.
+ *
+ * @param[in] data      the packet, which must fill the buffer exactly
+ * @param[in] datalen   length of the packet
+ * @param[out] hashes   at least @p cnt + 1 hashes, of the first k components in hashes[k]
+ * @param[in] cnt       hash at most this many components
+ *
+ * @return the number of components hashed, -1 if the packet is not a
+ *         single packet whose message starts with its name
+ */
+int
+ccnl_ccntlv_name_hashes(uint8_t *data, size_t datalen,
+                        uint32_t *hashes, uint32_t cnt);
+
 int8_t
 ccnl_ccntlv_cMatch(struct ccnl_pkt_s *p, struct ccnl_content_s *c);
 
@@ -165,6 +165,54 @@ struct ccnl_pkt_s*
 ccnl_ndntlv_bytes2pkt(uint64_t pkttype, uint8_t *start,
                       uint8_t **data, size_t *datalen);
 
+/**
+ * @brief Decodes a packet as \ref ccnl_ndntlv_bytes2pkt does, with options
+ *
+ * With CCNL_DECODE_ARENA, the pkt, its prefix (with room for the name's
+ * components only), the nonce and the chunk number are carved from a single
+ * allocation, and the pkt is flagged CCNL_PKT_ARENA. Such a pkt is freed with
+ * \ref ccnl_pkt_free as any other, but its prefix and nonce cannot be freed,
+ * kept or grown on their own: duplicate them first. With CCNL_DECODE_LAZY,
+ * MetaInfo and the signature are left to \ref ccnl_pkt_decode_rest.
+ *
+ * @param[in] pkttype   the outermost type, already read from the packet
+ * @param[in] start     the start of the packet
+ * @param[in,out] data  the packet's value, advanced past the packet
+ * @param[in,out] datalen length of the value, 0 after the packet
+ * @param[in] opts      CCNL_DECODE_* options
+ *
+ * @return the decoded packet, NULL if it is malformed or out of memory
+ */
+struct ccnl_pkt_s*
+ccnl_ndntlv_decode(uint64_t pkttype, uint8_t *start,
+                   uint8_t **data, size_t *datalen, unsigned int opts);
+
+/**
+ * @brief Decodes what \ref ccnl_ndntlv_decode left with CCNL_DECODE_LAZY,
+ *        see \ref ccnl_pkt_decode_rest
+ */
+int8_t
+ccnl_ndntlv_decode_rest(struct ccnl_pkt_s *pkt);
+
+/**
+ * @brief Hashes the name of an Interest or Data packet without parsing it
+ *
+ * Fills in what \ref ccnl_prefix_hashes returns for the packet's prefix,
+ * so that a packet can be mapped to a hash table slot (or a thread) before
+ * it is decoded.
+ *
+ * @param[in] data      the packet, which must fill the buffer exactly
+ * @param[in] datalen   length of the packet
+ * @param[out] hashes   at least @p cnt + 1 hashes, of the first k components in hashes[k]
+ * @param[in] cnt       hash at most this many components
+ *
+ * @return the number of components hashed, -1 if the packet is not a
+ *         single Interest or Data packet starting with its name
+ */
+int
+ccnl_ndntlv_name_hashes(uint8_t *data, size_t datalen,
+                        uint32_t *hashes, uint32_t cnt);
+
 int8_t
 ccnl_ndntlv_cMatch(struct ccnl_pkt_s *p, struct ccnl_content_s *c);
 
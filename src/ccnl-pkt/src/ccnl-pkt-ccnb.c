@@ -290,7 +290,7 @@ ccnl_ccnb_bytes2pkt(uint8_t *start, uint8_t **data, size_t *datalen)
         oldpos = *data - start;
     }
     pkt->pfx = p;
-    pkt->buf = ccnl_buf_new(start, *data - start);
+    pkt->buf = ccnl_buf_adopt(start, *data - start);
     // carefully rebase ptrs to new buf because of 64bit pointers:
     if (pkt->content) {
         pkt->content = pkt->buf->data + (pkt->content - start);
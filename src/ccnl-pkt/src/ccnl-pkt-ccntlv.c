@@ -109,10 +109,60 @@ ccnl_ccntlv_dehead(uint8_t **buf, size_t *len,
     return 0;
 }
 
+// decodes the end chunk and the validation TLVs, which CCNL_DECODE_LAZY
+// leaves for ccnl_ccntlv_decode_rest()
+static int8_t
+ccnl_ccntlv_decode_meta(struct ccnl_pkt_s *pkt, uint16_t typ,
+                        uint8_t *cp, size_t len, int *hmac)
+{
+    size_t len3;
+
+    (void) len3;
+    (void) hmac;
+    switch (typ) {
+    case CCNX_TLV_M_ENDChunk: {
+        uint32_t final_block_id;
+        if (ccnl_ccnltv_extractNetworkVarInt(cp, len, &final_block_id) < 0) {
+            DEBUGMSG_PCNX(WARNING, "error when extracting CCNX_TLV_M_ENDChunk\n");
+            return -1;
+        }
+        pkt->val.final_block_id = final_block_id;
+        break;
+    }
+#ifdef USE_HMAC256
+    case CCNX_TLV_TL_ValidationAlgo:
+        if (ccnl_ccntlv_dehead(&cp, &len, &typ, &len3)) {
+            return -1;
+        }
+        if (typ == CCNX_VALIDALGO_HMAC_SHA256) {
+            // ignore keyId and other algo dependent data ... && len3 == 0)
+            *hmac = 1;
+        }
+        break;
+    case CCNX_TLV_TL_ValidationPayload:
+        if (pkt->hmacStart && *hmac && len == 32) {
+            pkt->hmacLen = cp - pkt->hmacStart - 4;
+            pkt->hmacSignature = cp;
+        }
+        break;
+#endif
+    default:
+        break;
+    }
+    return 0;
+}
+
 // We use one extraction procedure for both interest and data pkts.
 // This proc assumes that the packet header was already processed and consumed
 struct ccnl_pkt_s*
 ccnl_ccntlv_bytes2pkt(uint8_t *start, uint8_t **data, size_t *datalen)
+{
+    return ccnl_ccntlv_decode(start, data, datalen, 0);
+}
+
+struct ccnl_pkt_s*
+ccnl_ccntlv_decode(uint8_t *start, uint8_t **data, size_t *datalen,
+                   unsigned int opts)
 {
     struct ccnl_pkt_s *pkt;
     struct ccnl_prefix_s *p;
@@ -120,9 +170,7 @@ ccnl_ccntlv_bytes2pkt(uint8_t *start, uint8_t **data, size_t *datalen)
     size_t len;
     size_t oldpos;
     uint16_t typ;
-#ifdef USE_HMAC256
-    uint8_t validAlgoIsHmac256 = 0;
-#endif
+    int hmac = 0;
 
     DEBUGMSG_PCNX(TRACE, "ccnl_ccntlv_bytes2pkt len=%zu\n", *datalen);
 
@@ -212,38 +260,26 @@ ccnl_ccntlv_bytes2pkt(uint8_t *start, uint8_t **data, size_t *datalen)
             }
             p->namelen = *data - p->nameptr;
             break;
-        case CCNX_TLV_M_ENDChunk: {
-            uint32_t final_block_id;
-            if (ccnl_ccnltv_extractNetworkVarInt(cp, len, &final_block_id) < 0) {
-                DEBUGMSG_PCNX(WARNING, "error when extracting CCNX_TLV_M_ENDChunk\n");
-                goto Bail;
-            }
-            pkt->val.final_block_id = final_block_id;
-            break;
-        }
         case CCNX_TLV_M_Payload:
             pkt->content = *data;
             pkt->contlen = len;
             break;
+        case CCNX_TLV_M_ENDChunk:
 #ifdef USE_HMAC256
         case CCNX_TLV_TL_ValidationAlgo:
-            cp = *data;
-            len2 = len;
-            if (ccnl_ccntlv_dehead(&cp, &len2, &typ, &len3) || len > *datalen) {
-                goto Bail;
-            }
-            if (typ == CCNX_VALIDALGO_HMAC_SHA256) {
-                // ignore keyId and other algo dependent data ... && len3 == 0)
-                validAlgoIsHmac256 = 1;
-            }
-            break;
         case CCNX_TLV_TL_ValidationPayload:
-            if (pkt->hmacStart && validAlgoIsHmac256 && len == 32) {
-                pkt->hmacLen = *data - pkt->hmacStart - 4;
-                pkt->hmacSignature = *data;
+#endif
+            if (opts & CCNL_DECODE_LAZY) {
+                if (!(pkt->flags & CCNL_PKT_LAZY)) {
+                    pkt->flags |= CCNL_PKT_LAZY;
+                    pkt->lazyoffs = oldpos;
+                }
+                break;
+            }
+            if (ccnl_ccntlv_decode_meta(pkt, typ, *data, len, &hmac)) {
+                goto Bail;
             }
             break;
-#endif
         default:
             break;
         }
@@ -256,7 +292,7 @@ ccnl_ccntlv_bytes2pkt(uint8_t *start, uint8_t **data, size_t *datalen)
     }
 
     pkt->pfx = p;
-    pkt->buf = ccnl_buf_new(start, *data - start);
+    pkt->buf = ccnl_buf_adopt(start, *data - start);
     if (!pkt->buf) {
         goto Bail;
     }
@@ -272,7 +308,9 @@ ccnl_ccntlv_bytes2pkt(uint8_t *start, uint8_t **data, size_t *datalen)
     }
 #ifdef USE_HMAC256
     pkt->hmacStart = pkt->buf->data + (pkt->hmacStart - start);
-    pkt->hmacSignature = pkt->buf->data + (pkt->hmacSignature - start);
+    if (pkt->hmacSignature) {
+        pkt->hmacSignature = pkt->buf->data + (pkt->hmacSignature - start);
+    }
 #endif
 
     return pkt;
@@ -281,6 +319,83 @@ Bail:
     return NULL;
 }
 
+int8_t
+ccnl_ccntlv_decode_rest(struct ccnl_pkt_s *pkt)
+{
+    uint8_t *data;
+    size_t datalen, len;
+    uint16_t typ;
+    int hmac = 0;
+
+    if (!(pkt->flags & CCNL_PKT_LAZY)) {
+        return 0;
+    }
+    data = pkt->buf->data + pkt->lazyoffs;
+    datalen = pkt->buf->datalen - pkt->lazyoffs;
+    while (datalen > 0) {
+        if (ccnl_ccntlv_dehead(&data, &datalen, &typ, &len) || len > datalen) {
+            return -1;
+        }
+        if (ccnl_ccntlv_decode_meta(pkt, typ, data, len, &hmac)) {
+            return -1;
+        }
+        data += len;
+        datalen -= len;
+    }
+    pkt->flags &= ~CCNL_PKT_LAZY;
+    return 0;
+}
+
+int
+ccnl_ccntlv_name_hashes(uint8_t *data, size_t datalen,
+                        uint32_t *hashes, uint32_t cnt)
+{
+    struct ccnx_tlvhdr_ccnx2015_s *hp = (struct ccnx_tlvhdr_ccnx2015_s*) data;
+    size_t len, complen;
+    uint16_t typ;
+    uint8_t *comp;
+    uint32_t n = 0;
+
+    // a single Interest, Content Object or Interest Return
+    if (datalen < sizeof(*hp) || hp->version != CCNX_TLV_V1 ||
+        (hp->pkttype != CCNX_PT_Interest && hp->pkttype != CCNX_PT_Data &&
+         hp->pkttype != CCNX_PT_NACK) ||
+        ntohs(hp->pktlen) != datalen || hp->hdrlen > datalen) {
+        return -1;
+    }
+    data += hp->hdrlen;
+    datalen -= hp->hdrlen;
+    if (ccnl_ccntlv_dehead(&data, &datalen, &typ, &len) || len > datalen ||
+        (typ != CCNX_TLV_TL_Interest && typ != CCNX_TLV_TL_Object)) {
+        return -1;
+    }
+    if (ccnl_ccntlv_dehead(&data, &datalen, &typ, &len) || len > datalen ||
+                                                typ != CCNX_TLV_M_Name) {
+        return -1;
+    }
+    if (cnt > CCNL_MAX_NAME_COMP) {
+        cnt = CCNL_MAX_NAME_COMP;
+    }
+    // like in ccnl_ccntlv_bytes2pkt(), components include their TL header
+    hashes[0] = ccnl_hash_uint(CCNL_HASH_INIT, (uint8_t) CCNL_SUITE_CCNTLV);
+    while (len > 0 && n < cnt) {
+        comp = data;
+        if (ccnl_ccntlv_dehead(&data, &len, &typ, &complen) || complen > len) {
+            return -1;
+        }
+        if (typ == CCNX_TLV_N_NameSegment || typ == CCNX_TLV_N_Chunk) {
+            size_t l = (size_t) (data - comp) + complen;
+
+            hashes[n + 1] = ccnl_hash_bytes(ccnl_hash_uint(hashes[n],
+                                            (uint32_t) l), comp, l);
+            n++;
+        }
+        data += complen;
+        len -= complen;
+    }
+    return (int) n;
+}
+
 // ----------------------------------------------------------------------
 
 #ifdef NEEDS_PREFIX_MATCHING
@@ -45,7 +45,10 @@
 int8_t
 ccnl_ndntlv_varlenint(uint8_t **buf, size_t *len, uint64_t *val)
 {
-    if (**buf < 253 && *len >= 1) {
+    if (*len < 1) {
+        return -1;
+    }
+    if (**buf < 253) {
         *val = **buf;
         *buf += 1;
         *len -= 1;
@@ -101,25 +104,203 @@ ccnl_ndntlv_dehead(uint8_t **buf, size_t *len,
     return 0;
 }
 
+// the parts of a pkt decoded with CCNL_DECODE_ARENA, in one allocation
+struct ccnl_ndntlv_arena_s {
+    struct ccnl_pkt_s *pkt;
+    struct ccnl_prefix_s *prefix;   // with room for maxcomp components
+    uint32_t maxcomp;
+    uint32_t *chunknum;
+    struct ccnl_buf_s *nonce;       // with room for noncelen bytes, or NULL
+    size_t noncelen;
+};
+
+#define CCNL_ARENA_ALIGN(n)  (((n) + sizeof(uint64_t) - 1) & \
+                              ~(sizeof(uint64_t) - 1))
+
+// sizes the arena for a packet's value: counts the name components and
+// finds the longest nonce, without decoding anything
+static void
+ccnl_ndntlv_arena_size(uint8_t *data, size_t datalen,
+                       uint32_t *compcnt, size_t *noncelen)
+{
+    uint64_t typ;
+    size_t len, len2, i;
+    uint8_t *cp;
+
+    *compcnt = 0;
+    *noncelen = 0;
+    while (ccnl_ndntlv_dehead(&data, &datalen, &typ, &len) == 0 &&
+                                                        len <= datalen) {
+        if (typ == NDN_TLV_Name) {
+            cp = data;
+            len2 = len;
+            while (len2 > 0 && *compcnt < CCNL_MAX_NAME_COMP &&
+                   ccnl_ndntlv_dehead(&cp, &len2, &typ, &i) == 0 && i <= len2) {
+                if (typ == NDN_TLV_NameComponent) {
+                    (*compcnt)++;
+                }
+                cp += i;
+                len2 -= i;
+            }
+        } else if (typ == NDN_TLV_Nonce && len > *noncelen) {
+            *noncelen = len;
+        }
+        data += len;
+        datalen -= len;
+    }
+}
+
+static int
+ccnl_ndntlv_arena_new(struct ccnl_ndntlv_arena_s *arena,
+                      uint8_t *data, size_t datalen)
+{
+    size_t size;
+    uint8_t *a;
+
+    ccnl_ndntlv_arena_size(data, datalen, &arena->maxcomp, &arena->noncelen);
+    size = CCNL_ARENA_ALIGN(sizeof(struct ccnl_pkt_s)) +
+           CCNL_ARENA_ALIGN(sizeof(struct ccnl_prefix_s)) +
+           CCNL_ARENA_ALIGN(arena->maxcomp * sizeof(uint8_t*)) +
+           CCNL_ARENA_ALIGN(arena->maxcomp * sizeof(size_t)) +
+           CCNL_ARENA_ALIGN(sizeof(uint32_t));
+    if (arena->noncelen) {
+        size += offsetof(struct ccnl_buf_s, data) + arena->noncelen;
+    }
+    a = (uint8_t*) ccnl_malloc(size);
+    if (!a) {
+        return -1;
+    }
+
+    arena->pkt = (struct ccnl_pkt_s*) a;
+    memset(arena->pkt, 0, sizeof(struct ccnl_pkt_s));
+    arena->pkt->flags = CCNL_PKT_ARENA;
+    a += CCNL_ARENA_ALIGN(sizeof(struct ccnl_pkt_s));
+
+    arena->prefix = (struct ccnl_prefix_s*) a;
+    memset(arena->prefix, 0, sizeof(struct ccnl_prefix_s));
+    arena->prefix->suite = CCNL_SUITE_NDNTLV;
+    a += CCNL_ARENA_ALIGN(sizeof(struct ccnl_prefix_s));
+    arena->prefix->comp = (uint8_t**) a;
+    a += CCNL_ARENA_ALIGN(arena->maxcomp * sizeof(uint8_t*));
+    arena->prefix->complen = (size_t*) a;
+    a += CCNL_ARENA_ALIGN(arena->maxcomp * sizeof(size_t));
+
+    arena->chunknum = (uint32_t*) a;
+    a += CCNL_ARENA_ALIGN(sizeof(uint32_t));
+
+    arena->nonce = NULL;
+    if (arena->noncelen) {
+        arena->nonce = (struct ccnl_buf_s*) a;
+        arena->nonce->next = NULL;
+        arena->nonce->pool = NULL;
+        arena->nonce->refcnt = 1;
+    }
+    return 0;
+}
+
+// decodes MetaInfo and the signature, the TLVs which CCNL_DECODE_LAZY leaves
+// for ccnl_ndntlv_decode_rest(); pos is the offset of the TLV in the packet
+static int8_t
+ccnl_ndntlv_decode_meta(struct ccnl_pkt_s *pkt, uint64_t typ,
+                        uint8_t *cp, size_t len, size_t pos, int *hmac)
+{
+    size_t i;
+
+    (void) pos;
+    (void) hmac;
+    switch (typ) {
+    case NDN_TLV_MetaInfo:
+        while (len > 0) {
+            if (ccnl_ndntlv_dehead(&cp, &len, &typ, &i)) {
+                return -1;
+            }
+            if (typ == NDN_TLV_ContentType) {
+                // Not used
+                // = ccnl_ndntlv_nonNegInt(cp, i);
+                DEBUGMSG(WARNING, "'ContentType' field ignored\n");
+            }
+            if (typ == NDN_TLV_FreshnessPeriod) {
+                pkt->s.ndntlv.freshnessperiod = ccnl_ndntlv_nonNegInt(cp, i);
+            }
+            if (typ == NDN_TLV_FinalBlockId) {
+                if (ccnl_ndntlv_dehead(&cp, &len, &typ, &i)) {
+                    return -1;
+                }
+                if (typ == NDN_TLV_NameComponent) {
+                    // TODO: again, includedNonNeg not yet implemented
+                    pkt->val.final_block_id = ccnl_ndntlv_nonNegInt(cp + 1, i - 1);
+                    if (pkt->val.final_block_id < 0) { // TODO: Is this check ok?
+                        return -1;
+                    }
+                }
+            }
+            cp += i;
+            len -= i;
+        }
+        break;
+#ifdef USE_HMAC256
+    case NDN_TLV_SignatureInfo:
+        while (len > 0) {
+            if (ccnl_ndntlv_dehead(&cp, &len, &typ, &i)) {
+                return -1;
+            }
+            if (typ == NDN_TLV_SignatureType && i == 1 &&
+                                      *cp == NDN_VAL_SIGTYPE_HMAC256) {
+                *hmac = 1;
+                break;
+            }
+            cp += i;
+            len -= i;
+        }
+        break;
+    case NDN_TLV_SignatureValue:
+        if (pkt->hmacStart && *hmac && len == 32) {
+            pkt->hmacLen = pos;
+            pkt->hmacSignature = cp;
+        }
+        break;
+#endif
+    default:
+        break;
+    }
+    return 0;
+}
+
 // we use one extraction routine for each of interest, data and fragment pkts
 struct ccnl_pkt_s*
 ccnl_ndntlv_bytes2pkt(uint64_t pkttype, uint8_t *start,
                       uint8_t **data, size_t *datalen)
+{
+    return ccnl_ndntlv_decode(pkttype, start, data, datalen, 0);
+}
+
+struct ccnl_pkt_s*
+ccnl_ndntlv_decode(uint64_t pkttype, uint8_t *start,
+                   uint8_t **data, size_t *datalen, unsigned int opts)
 {
     struct ccnl_pkt_s *pkt;
     size_t oldpos, len, i;
     uint64_t typ;
     struct ccnl_prefix_s *prefix = 0;
-#ifdef USE_HMAC256
-    int validAlgoIsHmac256 = 0;
-#endif
+    struct ccnl_ndntlv_arena_s arena, *ap = NULL;
+    uint32_t maxcomp = CCNL_MAX_NAME_COMP;
+    int hmac = 0;
 
 
     DEBUGMSG(DEBUG, "ccnl_ndntlv_bytes2pkt len=%zu\n", *datalen);
 
-    pkt = (struct ccnl_pkt_s*) ccnl_calloc(1, sizeof(struct ccnl_pkt_s));
-    if (!pkt) {
-        return NULL;
+    if (opts & CCNL_DECODE_ARENA) {
+        if (ccnl_ndntlv_arena_new(&arena, *data, *datalen)) {
+            return NULL;
+        }
+        ap = &arena;
+        pkt = arena.pkt;
+        maxcomp = arena.maxcomp;
+    } else {
+        pkt = (struct ccnl_pkt_s*) ccnl_calloc(1, sizeof(struct ccnl_pkt_s));
+        if (!pkt) {
+            return NULL;
+        }
     }
     pkt->type = pkttype;
 
@@ -155,13 +336,18 @@ ccnl_ndntlv_bytes2pkt(uint64_t pkttype, uint8_t *start,
         uint8_t *cp = *data;
         size_t len2 = len;
 
+        if (len > *datalen) {
+            goto Bail;
+        }
+
         switch (typ) {
         case NDN_TLV_Name:
             if (prefix) {
                 DEBUGMSG(WARNING, " ndntlv: name already defined\n");
                 goto Bail;
             }
-            prefix = ccnl_prefix_new(CCNL_SUITE_NDNTLV, CCNL_MAX_NAME_COMP);
+            prefix = ap ? ap->prefix
+                        : ccnl_prefix_new(CCNL_SUITE_NDNTLV, CCNL_MAX_NAME_COMP);
             if (!prefix) {
                 goto Bail;
             }
@@ -175,10 +361,16 @@ ccnl_ndntlv_bytes2pkt(uint64_t pkttype, uint8_t *start,
                     goto Bail;
                 }
                 if (typ == NDN_TLV_NameComponent &&
-                            prefix->compcnt < CCNL_MAX_NAME_COMP) {
+                            prefix->compcnt < maxcomp) {
                     if(cp[0] == NDN_Marker_SegmentNumber) {
                         uint64_t chunknum;
-                        prefix->chunknum = (uint32_t *) ccnl_malloc(sizeof(uint32_t));
+                        if (!prefix->chunknum) {
+                            prefix->chunknum = ap ? ap->chunknum
+                                : (uint32_t *) ccnl_malloc(sizeof(uint32_t));
+                            if (!prefix->chunknum) {
+                                goto Bail;
+                            }
+                        }
                         // TODO: requires ccnl_ndntlv_includedNonNegInt which includes the length of the marker
                         // it is implemented for encode, the decode is not yet implemented
                         chunknum = ccnl_ndntlv_nonNegInt(cp + 1, i - 1);
@@ -224,6 +416,16 @@ ccnl_ndntlv_bytes2pkt(uint64_t pkttype, uint8_t *start,
             }
             break;
         case NDN_TLV_Nonce:
+            if (ap) {
+                // sized for the longest nonce, see ccnl_ndntlv_arena_size()
+                if (!ap->nonce || len > ap->noncelen) {
+                    goto Bail;
+                }
+                ap->nonce->datalen = len;
+                memcpy(ap->nonce->data, *data, len);
+                pkt->s.ndntlv.nonce = ap->nonce;
+                break;
+            }
             pkt->s.ndntlv.nonce = ccnl_buf_new(*data, len);
             break;
         case NDN_TLV_Scope:
@@ -235,32 +437,19 @@ ccnl_ndntlv_bytes2pkt(uint64_t pkttype, uint8_t *start,
             pkt->contlen = len;
             break;
         case NDN_TLV_MetaInfo:
-            while (len2 > 0) {
-                if (ccnl_ndntlv_dehead(&cp, &len2, &typ, &i)) {
-                    goto Bail;
-                }
-                if (typ == NDN_TLV_ContentType) {
-                    // Not used
-                    // = ccnl_ndntlv_nonNegInt(cp, i);
-                    DEBUGMSG(WARNING, "'ContentType' field ignored\n");
-                }
-                if (typ == NDN_TLV_FreshnessPeriod) {
-                    pkt->s.ndntlv.freshnessperiod = ccnl_ndntlv_nonNegInt(cp, i);
-                }
-                if (typ == NDN_TLV_FinalBlockId) {
-                    if (ccnl_ndntlv_dehead(&cp, &len2, &typ, &i)) {
-                        goto Bail;
-                    }
-                    if (typ == NDN_TLV_NameComponent) {
-                        // TODO: again, includedNonNeg not yet implemented
-                        pkt->val.final_block_id = ccnl_ndntlv_nonNegInt(cp + 1, i - 1);
-                        if (pkt->val.final_block_id < 0) { // TODO: Is this check ok?
-                            goto Bail;
-                        }
-                    }
+#ifdef USE_HMAC256
+        case NDN_TLV_SignatureInfo:
+        case NDN_TLV_SignatureValue:
+#endif
+            if (opts & CCNL_DECODE_LAZY) {
+                if (!(pkt->flags & CCNL_PKT_LAZY)) {
+                    pkt->flags |= CCNL_PKT_LAZY;
+                    pkt->lazyoffs = oldpos;
                 }
-                cp += i;
-                len2 -= i;
+                break;
+            }
+            if (ccnl_ndntlv_decode_meta(pkt, typ, *data, len, oldpos, &hmac)) {
+                goto Bail;
             }
             break;
         case NDN_TLV_InterestLifetime:
@@ -277,28 +466,6 @@ ccnl_ndntlv_bytes2pkt(uint64_t pkttype, uint8_t *start,
             }
             pkt->val.seqno &= 0x3fff;
             break;
-#ifdef USE_HMAC256
-        case NDN_TLV_SignatureInfo:
-            while (len2 > 0) {
-                if (ccnl_ndntlv_dehead(&cp, &len2, &typ, &i)) {
-                    goto Bail;
-                }
-                if (typ == NDN_TLV_SignatureType && i == 1 &&
-                                          *cp == NDN_VAL_SIGTYPE_HMAC256) {
-                    validAlgoIsHmac256 = 1;
-                    break;
-                }
-                cp += i;
-                len2 -= i;
-            }
-            break;
-        case NDN_TLV_SignatureValue:
-            if (pkt->hmacStart && validAlgoIsHmac256 && len == 32) {
-                pkt->hmacLen = oldpos;
-                pkt->hmacSignature = *data;
-            }
-            break;
-#endif
         default:
             break;
         }
@@ -311,7 +478,7 @@ ccnl_ndntlv_bytes2pkt(uint64_t pkttype, uint8_t *start,
     }
 
     pkt->pfx = prefix;
-    pkt->buf = ccnl_buf_new(start, *data - start);
+    pkt->buf = ccnl_buf_adopt(start, *data - start);
     if (!pkt->buf) {
         goto Bail;
     }
@@ -327,6 +494,12 @@ ccnl_ndntlv_bytes2pkt(uint64_t pkttype, uint8_t *start,
             prefix->nameptr = pkt->buf->data + (prefix->nameptr - start);
         }
     }
+#ifdef USE_HMAC256
+    pkt->hmacStart = pkt->buf->data;
+    if (pkt->hmacSignature) {
+        pkt->hmacSignature = pkt->buf->data + (pkt->hmacSignature - start);
+    }
+#endif
 
     return pkt;
 Bail:
@@ -334,6 +507,72 @@ Bail:
     return NULL;
 }
 
+int8_t
+ccnl_ndntlv_decode_rest(struct ccnl_pkt_s *pkt)
+{
+    uint8_t *data;
+    size_t datalen, len, pos;
+    uint64_t typ;
+    int hmac = 0;
+
+    if (!(pkt->flags & CCNL_PKT_LAZY)) {
+        return 0;
+    }
+    data = pkt->buf->data + pkt->lazyoffs;
+    datalen = pkt->buf->datalen - pkt->lazyoffs;
+    while (datalen > 0) {
+        pos = data - pkt->buf->data;
+        if (ccnl_ndntlv_dehead(&data, &datalen, &typ, &len) || len > datalen) {
+            return -1;
+        }
+        if (ccnl_ndntlv_decode_meta(pkt, typ, data, len, pos, &hmac)) {
+            return -1;
+        }
+        data += len;
+        datalen -= len;
+    }
+    pkt->flags &= ~CCNL_PKT_LAZY;
+    return 0;
+}
+
+int
+ccnl_ndntlv_name_hashes(uint8_t *data, size_t datalen,
+                        uint32_t *hashes, uint32_t cnt)
+{
+    uint64_t typ;
+    size_t len, complen;
+    uint32_t n = 0;
+
+    // a single Interest or Data packet, starting with its name
+    if (ccnl_ndntlv_dehead(&data, &datalen, &typ, &len) || len != datalen ||
+                        (typ != NDN_TLV_Interest && typ != NDN_TLV_Data)) {
+        return -1;
+    }
+    if (ccnl_ndntlv_dehead(&data, &datalen, &typ, &len) || len > datalen ||
+                                                    typ != NDN_TLV_Name) {
+        return -1;
+    }
+    if (cnt > CCNL_MAX_NAME_COMP) {
+        cnt = CCNL_MAX_NAME_COMP;
+    }
+    // the same components, and the same hashes, as ccnl_prefix_hashes()
+    // for the prefix that ccnl_ndntlv_bytes2pkt() extracts
+    hashes[0] = ccnl_hash_uint(CCNL_HASH_INIT, (uint8_t) CCNL_SUITE_NDNTLV);
+    while (len > 0 && n < cnt) {
+        if (ccnl_ndntlv_dehead(&data, &len, &typ, &complen) || complen > len) {
+            return -1;
+        }
+        if (typ == NDN_TLV_NameComponent) {
+            hashes[n + 1] = ccnl_hash_bytes(ccnl_hash_uint(hashes[n],
+                                            (uint32_t) complen), data, complen);
+            n++;
+        }
+        data += complen;
+        len -= complen;
+    }
+    return (int) n;
+}
+
 // ----------------------------------------------------------------------
 
 #ifdef NEEDS_PREFIX_MATCHING
@@ -68,6 +68,7 @@
 
 #include "ccn-lite-relay.h"
 #include "ccnl-unix.h"
+#include "ccnl-shard.h"
 
 static int lasthour = -1;
 static int inter_ccn_interval = 0; // in usec
@@ -148,6 +149,8 @@ main(int argc, char **argv)
     int opt, max_cache_entries = -1, httpport = -1;
     int udpport1 = -1, udpport2 = -1;
     int udp6port1 = -1, udp6port2 = -1;
+    int tcpport = -1;
+    char *uxstreampath = NULL;
     char *datadir = NULL, *ethdev = NULL, *crypto_sock_path = NULL;
     char *wpandev = NULL;
     int suite = CCNL_SUITE_DEFAULT;
@@ -169,8 +172,18 @@ main(int argc, char **argv)
     srandom(seed);
 #endif
 
-    while ((opt = getopt(argc, argv, "hc:d:e:g:i:o:p:s:t:u:6:v:w:x:")) != -1) {
+    while ((opt = getopt(argc, argv, "hb:c:d:e:g:i:l:n:Oo:p:R:rS:s:T:t:u:6:v:w:X:x:")) != -1) {
         switch (opt) {
+        case 'b': {
+            long rx_batch_l;
+            errno = 0;
+            rx_batch_l = strtol(optarg, (char **) NULL, 10);
+            if (errno || rx_batch_l < 1 || rx_batch_l > CCNL_MAX_RX_BATCH ||
+                ccnl_io_set_rx_batch((int) rx_batch_l)) {
+                goto usage;
+            }
+            break;
+        }
         case 'c': {
             long max_cache_entries_l;
             errno = 0;
@@ -207,6 +220,16 @@ main(int argc, char **argv)
             inter_ccn_interval = (int) inter_ccn_interval_l;
             break;
         }
+        case 'l':
+            if (ccnl_io_set_backend(optarg)) {
+                goto usage;
+            }
+            break;
+        case 'O':
+            if (ccnl_io_use_udp_offload(1)) {
+                goto usage;
+            }
+            break;
 #ifdef USE_ECHO
         case 'o':
             echopfx = optarg;
@@ -215,6 +238,53 @@ main(int argc, char **argv)
         case 'p':
             crypto_sock_path = optarg;
             break;
+        case 'R': {
+            long period_l;
+            char *end;
+            errno = 0;
+            period_l = strtol(optarg, &end, 10);
+            if (errno || *end || period_l < 1 || period_l > INT_MAX) {
+                goto usage;
+            }
+            theRelay->retrans_period = (int) period_l;
+            break;
+        }
+        case 'r':
+            if (ccnl_io_use_packet_rings(1)) {
+                goto usage;
+            }
+            break;
+        case 'n': {
+            long window_l, max_l = 0;
+            char *end;
+            errno = 0;
+            window_l = strtol(optarg, &end, 10);
+            if (*end == ':') {
+                max_l = strtol(end + 1, &end, 10);
+            }
+            if (errno || *end || window_l < 1 || window_l > INT_MAX ||
+                max_l < 0 || max_l > INT_MAX) {
+                goto usage;
+            }
+            theRelay->nonce_window = (int) window_l;
+            theRelay->max_nonces = (int) max_l;
+            break;
+        }
+        case 'S': {
+            long threads_l, comps_l = CCNL_SHARD_COMPS;
+            char *end;
+            errno = 0;
+            threads_l = strtol(optarg, &end, 10);
+            if (*end == ':') {
+                comps_l = strtol(end + 1, &end, 10);
+            }
+            if (errno || *end || threads_l < 0 || threads_l > INT_MAX ||
+                comps_l < 1 || comps_l > INT_MAX ||
+                ccnl_io_set_shards((int) threads_l, (int) comps_l)) {
+                goto usage;
+            }
+            break;
+        }
         case 's':
             suite = ccnl_str2suite(optarg);
             if (!ccnl_isSuite(suite))
@@ -230,6 +300,16 @@ main(int argc, char **argv)
             httpport = (int) httpport_l;
             break;
         }
+        case 'T': {
+            long tcpport_l;
+            errno = 0;
+            tcpport_l = strtol(optarg, (char **) NULL, 10);
+            if (errno || tcpport_l < 0 || tcpport_l > UINT16_MAX) {
+                goto usage;
+            }
+            tcpport = (int) tcpport_l;
+            break;
+        }
         case 'u':
             if (udpport1 == -1) {
                 long udpport1_l;
@@ -288,6 +368,9 @@ main(int argc, char **argv)
             wpandev = optarg;
             break;
 #endif
+        case 'X':
+            uxstreampath = optarg;
+            break;
         case 'x':
             uxpath = optarg;
             break;
@@ -296,17 +379,25 @@ main(int argc, char **argv)
 usage:
             fprintf(stderr,
                     "usage: %s [options]\n"
+                    "  -b RX_BATCH (datagrams read per wakeup, default %d)\n"
                     "  -c MAX_CONTENT_ENTRIES\n"
                     "  -d databasedir\n"
                     "  -e ethdev\n"
                     "  -g MIN_INTER_PACKET_INTERVAL\n"
                     "  -h\n"
                     "  -i MIN_INTER_CCNMSG_INTERVAL\n"
+                    "  -l IO_BACKEND (select, epoll, uring)\n"
+                    "  -n NONCE_WINDOW[:MAX_NONCES] (seconds a nonce is a duplicate for, default %d)\n"
+                    "  -O (UDP segmentation offload)\n"
 #ifdef USE_ECHO
                     "  -o echo_prefix\n"
 #endif
                     "  -p crypto_face_ux_socket\n"
+                    "  -R RETRANS_PERIOD (seconds between interest retransmissions, default %d)\n"
+                    "  -r (mmap'ed packet rings on ethdev)\n"
+                    "  -S THREADS[:NAME_COMPONENTS] (forwarding threads, PIT and CS sharded by name)\n"
                     "  -s SUITE (ccnb, ccnx2015, ndn2013)\n"
+                    "  -T tcpport (faces over TCP connections)\n"
                     "  -t tcpport (for HTML status page)\n"
                     "  -u udpport (can be specified twice)\n"
                     "  -6 udp6port (can be specified twice)\n"
@@ -318,9 +409,11 @@ usage:
                     "  -w wpandev\n"
 #endif
 #ifdef USE_UNIXSOCKET
+                    "  -X unixpath (faces over UNIX stream connections)\n"
                     "  -x unixpath\n"
 #endif
-                    , argv[0]);
+                    , argv[0], CCNL_RX_BATCH, CCNL_NONCE_TIMEOUT,
+                    CCNL_INTEREST_RETRANS_PERIOD);
             exit(EXIT_FAILURE);
         }
     }
@@ -346,6 +439,7 @@ usage:
     ccnl_relay_config(theRelay, ethdev, wpandev, udpport1, udpport2,
                       udp6port1, udp6port2, httpport,
                       uxpath, suite, max_cache_entries, crypto_sock_path);
+    ccnl_relay_stream(theRelay, tcpport, uxstreampath);
     if (datadir) {
         ccnl_populate_cache(theRelay, datadir);
     }
@@ -364,9 +458,7 @@ usage:
 
     ccnl_io_loop(theRelay);
 
-    while (eventqueue) {
-        ccnl_rem_timer(eventqueue);
-    }
+    ccnl_timer_cleanup();
 
     ccnl_core_cleanup(theRelay);
 #ifdef USE_HTTP_STATUS
@@ -0,0 +1,93 @@
+/*
+ * @f ccnl-app.h
+ * @b CCN lite, in-process application face for embedding the relay
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * An application which runs the relay in its own process talks to it over
+ * the local face: the in-memory face with interface index -1. Interests it
+ * sends are answered by calling back into the application, from the Content
+ * Store before ccnl_app_send returns, or later, from the IO loop, when the
+ * Data arrives over one of the relay's faces. Data it sends satisfies the
+ * pending Interests and is cached, even if nobody asked for it yet.
+ *
+ * A relay embedded this way is set up as in ccn-lite-relay: ccnl_core_init,
+ * ccnl_relay_config (without any interface, if the relay is to serve the
+ * application only), and then either ccnl_io_loop or, without interfaces,
+ * ccnl_run_events now and then for the timers. The relay is not thread safe:
+ * the application has to call in from the thread which runs it, e.g. from
+ * a timer set with ccnl_set_timer. relay->aux is left to the application.
+ *
+ * The callback runs while the relay walks its PIT: what the application
+ * sends from there is queued, and processed when the relay is done with the
+ * packet at hand. The callback must not close the face.
+ *
+ * File history:
+ * 2018-10-02 created
+ */
+
+#ifndef CCNL_APP_H
+#define CCNL_APP_H
+
+#include "ccnl-relay.h"
+#include "ccnl-callbacks.h"
+
+/**
+ * @brief Creates the local face of @p relay and registers the application
+ *
+ * @param[in] relay     the relay the application embeds
+ * @param[in] rx        called with the Data for the application's Interests,
+ *                      which is only valid until @p rx returns
+ *
+ * @return 0 on success, -1 on error
+ */
+int
+ccnl_app_open(struct ccnl_relay_s *relay, ccnl_cb_on_app_data rx);
+
+/**
+ * @brief Sends an Interest or Data packet to the relay over the local face
+ *
+ * @param[in] relay     the relay given to \ref ccnl_app_open
+ * @param[in] data      the packet, in any of the relay's suites
+ * @param[in] len       length of the packet
+ *
+ * The packet is copied: @p data can be reused when the function returns.
+ * Sent from within the application's callback, it is queued until the relay
+ * is done with the packet which the callback is for.
+ *
+ * @return 0 on success, -1 if the application has not opened the face
+ */
+int
+ccnl_app_send(struct ccnl_relay_s *relay, uint8_t *data, size_t len);
+
+/**
+ * @brief Processes the packets the application sent from within its callback
+ *
+ * @param[in] relay     the relay given to \ref ccnl_app_open
+ *
+ * Called by the IO loop once the events of an iteration are served.
+ */
+void
+ccnl_app_flush(struct ccnl_relay_s *relay);
+
+/**
+ * @brief Removes the local face, with the application's pending Interests
+ *
+ * @param[in] relay     the relay given to \ref ccnl_app_open
+ */
+void
+ccnl_app_close(struct ccnl_relay_s *relay);
+
+#endif // CCNL_APP_H
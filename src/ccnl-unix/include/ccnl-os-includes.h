@@ -65,6 +65,61 @@
 #  include <linux/if_packet.h> // sockaddr_ll
 #endif
 
+#if defined(__linux__) && !defined(CCNL_NO_EPOLL)
+#  define USE_EPOLL
+#  include <sys/epoll.h>
+#  include <sys/timerfd.h>
+#  if defined(_GNU_SOURCE) && !defined(CCNL_NO_MMSG)
+#    define USE_MMSG // recvmmsg and sendmmsg are GNU extensions
+#  endif
+#  if defined(USE_MMSG) && !defined(CCNL_NO_UDP_GSO)
+#    include <netinet/udp.h>
+#    if defined(UDP_SEGMENT) && defined(UDP_GRO)
+#      define USE_UDP_GSO
+#      include <ifaddrs.h> // the link MTUs, which bound GSO segments
+#    endif
+#  endif
+#  if defined(USE_MMSG) && !defined(CCNL_NO_URING)
+#    include <linux/io_uring.h>
+#    ifdef IORING_RECV_MULTISHOT // provided buffer rings and multishot recvmsg
+#      define USE_URING
+#      include <poll.h>
+#      include <sys/mman.h>
+#      include <sys/syscall.h>
+#    endif
+#  endif
+#  ifndef CLOCK_REALTIME
+#    define CLOCK_REALTIME 0 // hidden by -std=c99, fixed by the kernel ABI
+#  endif
+#endif
+
+#if defined(__linux__) && defined(USE_LINKLAYER) && !defined(CCNL_NO_TPACKET)
+#  include <linux/if_packet.h>
+#  ifdef TPACKET3_HDRLEN // mmap'ed TPACKET_V3 rings on AF_PACKET sockets
+#    define USE_TPACKET
+#    include <sys/mman.h>
+#  endif
+#endif
+
+#if defined(__linux__) && defined(__GNUC__) && !defined(CCNL_NO_SHARDS)
+#  define USE_SHARDS // forwarding threads, each owning a part of the PIT and CS
+#  include <poll.h>
+#  include <pthread.h>
+#  include <sys/eventfd.h>
+#endif
+
+#if defined(__linux__) && defined(USE_UNIXSOCKET) && !defined(CCNL_NO_SHM)
+#  define USE_SHM_FACES // memfd rings for applications on the same host
+#  include <poll.h>
+#  include <sys/eventfd.h>
+#  include <sys/mman.h>
+#endif
+
+#if defined(USE_EPOLL) && !defined(CCNL_NO_STREAMS)
+#  define USE_STREAM_FACES // TCP and UNIX stream connections, length framed
+#  include <netinet/tcp.h>
+#endif
+
 #ifdef USE_CCNxDIGEST
 #  include <openssl/sha.h>
 #endif
@@ -0,0 +1,113 @@
+/*
+ * @f ccnl-shard.h
+ * @b CCN lite, forwarding threads with a shard of the PIT and CS each
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * The IO loop (the "front" relay) reads the sockets. NDN and CCNx Interests
+ * and Data are handed, by a hash of their name, to one of several forwarding
+ * threads. Each thread runs a relay of its own, with its own PIT, CS, faces
+ * and nonce ring, and sends on the front's sockets directly. Everything else
+ * (CCNB, management requests under /ccnx, fragments, local RPC) is processed
+ * by the front, as without forwarding threads.
+ *
+ * The front's FIB stays authoritative: whenever it changes, each thread gets
+ * a copy of it, together with the faces the routes point at. The threads
+ * only reach faces on one of the front's interfaces: routes over in-memory
+ * faces are refused by the front while the threads run.
+ *
+ * An Interest and a Data meet in the same thread if their names agree in
+ * the first comps components (or are equal, if shorter). comps defaults to
+ * CCNL_SHARD_COMPS, a short routable prefix, so that Interests of at least
+ * that many components also find Data further below their name
+ * (CanBePrefix). Shorter Interests only find Data with exactly their name.
+ * A larger comps spreads the names of a busy prefix over more threads.
+ *
+ * File history:
+ * 2018-09-20 created
+ */
+
+#ifndef CCNL_SHARD_H
+#define CCNL_SHARD_H
+
+#include "ccnl-relay.h"
+#include "ccnl-sockunion.h"
+
+#define CCNL_SHARD_MAX          64      // forwarding threads at most
+#ifndef CCNL_SHARD_COMPS
+#define CCNL_SHARD_COMPS        2       // name components a thread is chosen by
+#endif
+#ifndef CCNL_SHARD_QLEN
+#define CCNL_SHARD_QLEN         1024    // packets queued for a forwarding thread
+#endif
+
+/**
+ * @brief Starts forwarding threads which take over the PIT and CS of a relay
+ *
+ * The content of the relay's CS is moved to the threads, and its cache,
+ * PIT and nonce limits are split between them. Fails if the relay has a
+ * route over a face without an interface.
+ *
+ * @param[in] front     the relay whose IO loop hands packets to the threads
+ * @param[in] count     number of threads, between 1 and CCNL_SHARD_MAX
+ * @param[in] comps     number of name components a thread is chosen by
+ *
+ * @return 0 on success, -1 on error (no thread is running then)
+ */
+int
+ccnl_shard_setup(struct ccnl_relay_s *front, int count, int comps);
+
+/**
+ * @brief Hands a received frame to the forwarding thread for its name
+ *
+ * Only parses the frame as far as needed to hash the name. The thread is
+ * handed the offered receive buffer if it holds exactly the frame (see
+ * \ref ccnl_buf_adopt), a copy otherwise: @p data can be reused when the
+ * function returns unless its buffer was adopted. The pool of an adopted
+ * buffer must be shared.
+ *
+ * @param[in] ifndx     index of the interface the frame was received on
+ * @param[in] data      the frame
+ * @param[in] len       length of the frame
+ * @param[in] src       the sender of the frame
+ * @param[in] addrlen   length of the sender's address
+ *
+ * @return 0 if a thread takes care of the frame (or it was dropped because
+ *         the thread is congested), -1 if the caller has to process it
+ */
+int
+ccnl_shard_dispatch(int ifndx, uint8_t *data, size_t len,
+                    sockunion *src, size_t addrlen);
+
+/**
+ * @brief Passes changes of the FIB of @p front on to the forwarding threads
+ *
+ * Cheap if nothing changed. To be called after the front has processed
+ * packets or timers.
+ *
+ * @param[in] front     the relay given to \ref ccnl_shard_setup
+ */
+void
+ccnl_shard_sync(struct ccnl_relay_s *front);
+
+/**
+ * @brief Stops the forwarding threads and frees their relays
+ *
+ * The sockets, which belong to the front, stay open.
+ */
+void
+ccnl_shard_cleanup(void);
+
+#endif // CCNL_SHARD_H
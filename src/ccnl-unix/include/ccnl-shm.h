@@ -0,0 +1,178 @@
+/*
+ * @f ccnl-shm.h
+ * @b CCN lite, shared memory faces for applications on the same host
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * An application bound to a UNIX datagram socket asks the relay, over that
+ * socket, for a shared memory channel. The relay answers with a memfd that
+ * holds two single-producer/single-consumer rings of packet slots, one in
+ * each direction, and two eventfds: the relay's doorbell and the
+ * application's. A producer only rings the doorbell when the consumer has
+ * said it is about to sleep, so a burst of packets costs one wakeup.
+ *
+ * On the relay's side the channel is not a face of its own: packets from
+ * the rings are received on the UNIX interface, from the application's
+ * socket address, and packets to that address go into the rings. The
+ * forwarder sees the same face as for the application's datagrams.
+ *
+ * File history:
+ * 2018-09-27 created
+ */
+
+#ifndef CCNL_SHM_H
+#define CCNL_SHM_H
+
+#include "ccnl-relay.h"
+#include "ccnl-sockunion.h"
+
+#ifndef CCNL_SHM_SLOTS
+#define CCNL_SHM_SLOTS          128     // packets in flight in each direction
+#endif
+
+#ifndef CCNL_SHM_MAX_CHANS
+#define CCNL_SHM_MAX_CHANS      16      // channels granted, more are refused
+#endif
+
+struct ccnl_shm_area_s;
+struct ccnl_shm_chan_s;
+
+// the application's end of a channel
+struct ccnl_shm_client_s {
+    struct ccnl_shm_area_s *area;
+    int relay_bell;             // rung when the relay has packets to read
+    int bell;                   // rung by the relay
+};
+
+/**
+ * @brief Receives a packet from a channel
+ *
+ * @p data is the start of the private buffer @p *rxbuf, which the callback
+ * may keep if it replaces @p *rxbuf by another buffer of the same pool.
+ */
+typedef void (*ccnl_shm_deliver_func)(struct ccnl_relay_s *relay, int ifndx,
+                                      uint8_t *data, size_t len,
+                                      sockunion *src,
+                                      struct ccnl_buf_s **rxbuf);
+
+/**
+ * @brief Prepares the relay to accept shared memory channels
+ *
+ * @return the relay's doorbell, which the IO loop has to watch for reading
+ *         and then call \ref ccnl_shm_rx, or -1 on error
+ */
+int
+ccnl_shm_setup(void);
+
+/**
+ * @brief Handles a channel request or release received on a UNIX socket
+ *
+ * A request is refused while CCNL_SHM_MAX_CHANS channels are open.
+ *
+ * @param[in] relay     the relay
+ * @param[in] ifndx     the UNIX interface the datagram was received on
+ * @param[in] data      the datagram
+ * @param[in] len       length of the datagram
+ * @param[in] src       the application's socket address
+ *
+ * @return 0 if the datagram was a channel request or release, -1 if it is
+ *         a packet for the relay
+ */
+int
+ccnl_shm_control(struct ccnl_relay_s *relay, int ifndx, uint8_t *data,
+                 size_t len, sockunion *src);
+
+/**
+ * @brief Returns the channel of the application at @p dest, if it has one
+ */
+struct ccnl_shm_chan_s*
+ccnl_shm_of(sockunion *dest);
+
+/**
+ * @brief Puts a packet into the ring of a channel, to the application
+ *
+ * @return the length of the packet, -1 if the ring is full
+ */
+ssize_t
+ccnl_shm_send(struct ccnl_shm_chan_s *ch, uint8_t *data, size_t len);
+
+/**
+ * @brief Hands the packets waiting in all channels to @p deliver
+ *
+ * Each packet is copied out of shared memory, and its slot given back to
+ * the application, before @p deliver sees it: the application cannot
+ * change a packet while the relay processes it. At most CCNL_SHM_SLOTS
+ * packets are taken from each channel; if more are waiting, the doorbell
+ * is left readable. To be called when the doorbell is readable.
+ */
+void
+ccnl_shm_rx(struct ccnl_relay_s *relay, ccnl_shm_deliver_func deliver);
+
+/**
+ * @brief Closes the channels of applications whose socket is gone
+ */
+void
+ccnl_shm_ageing(void);
+
+/**
+ * @brief Closes all channels and the doorbell
+ */
+void
+ccnl_shm_cleanup(void);
+
+/**
+ * @brief Asks the relay at @p relay for a channel, over the bound socket @p sock
+ *
+ * @param[in] sock      a UNIX datagram socket bound to a path
+ * @param[in] relay     the relay's UNIX socket address
+ * @param[out] c        the channel
+ * @param[in] wait      how long to wait for the relay's answer, in seconds
+ *
+ * @return 0 on success, -1 if the relay does not offer channels
+ */
+int
+ccnl_shm_connect(int sock, struct sockaddr_un *relay,
+                 struct ccnl_shm_client_s *c, float wait);
+
+/**
+ * @brief Sends a packet to the relay over a channel
+ *
+ * @return 0 on success, -1 if the packet is too large or the ring is full
+ */
+int
+ccnl_shm_client_send(struct ccnl_shm_client_s *c, uint8_t *data, size_t len);
+
+/**
+ * @brief Receives a packet from the relay over a channel
+ *
+ * @param[in] c         the channel
+ * @param[out] buf      where to copy the packet to
+ * @param[in] size      size of @p buf, longer packets are truncated
+ * @param[in] wait      how long to wait for a packet, in seconds
+ *
+ * @return the length of the packet, 0 on timeout, -1 on error
+ */
+ssize_t
+ccnl_shm_client_recv(struct ccnl_shm_client_s *c, uint8_t *buf, size_t size,
+                     float wait);
+
+/**
+ * @brief Releases a channel, and tells the relay so
+ */
+void
+ccnl_shm_disconnect(int sock, struct sockaddr_un *relay,
+                    struct ccnl_shm_client_s *c);
+
+#endif // CCNL_SHM_H
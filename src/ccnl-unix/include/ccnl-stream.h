@@ -0,0 +1,114 @@
+/*
+ * @f ccnl-stream.h
+ * @b CCN lite, faces over TCP and UNIX stream connections
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * A stream interface listens on a TCP port or a UNIX stream socket, and
+ * each of its faces is a connection of its own: accepted from a peer, or
+ * opened to the peer when the first packet is sent to it. The interface's
+ * socket, the one the IO loop watches, is an epoll set holding the listener
+ * and all connections.
+ *
+ * Packets are framed by the length in their own TLV header, NDN or CCNx, so
+ * nothing is added on the wire. A read takes whatever the kernel has and
+ * hands each complete packet in it to the relay, keeping the start of the
+ * next one for the following read. Packets to a peer are appended to the
+ * connection's write buffer and leave together when the IO loop flushes;
+ * pacing is left to the kernel's congestion control.
+ *
+ * File history:
+ * 2018-10-04 created
+ */
+
+#ifndef CCNL_STREAM_H
+#define CCNL_STREAM_H
+
+#include "ccnl-relay.h"
+#include "ccnl-sockunion.h"
+
+#ifndef CCNL_STREAM_BUFSIZE
+#define CCNL_STREAM_BUFSIZE     (64 * 1024) // per connection and direction
+#endif
+
+#ifndef CCNL_STREAM_MAX_CONNS
+#define CCNL_STREAM_MAX_CONNS   128 // accepted per interface, more are refused
+#endif
+
+typedef void (*ccnl_stream_deliver_func)(struct ccnl_relay_s *relay, int ifndx,
+                                         uint8_t *data, size_t len,
+                                         sockunion *src, size_t addrlen);
+
+/**
+ * @brief Returns the length of the packet at the start of a stream
+ *
+ * @param[in] data      what was read of the stream, from a packet's start
+ * @param[in] len       number of bytes in @p data
+ *
+ * @return the length of the packet with its switch prefixes, which may be
+ *         more than @p len; 0 if more bytes are needed to tell; -1 if the
+ *         stream cannot be framed (CCNB, or a malformed or oversized header)
+ */
+ssize_t
+ccnl_stream_framelen(uint8_t *data, size_t len);
+
+/**
+ * @brief Opens a listening socket for the stream interface @p ifndx
+ *
+ * @param[in] relay     the relay
+ * @param[in] ifndx     the index the interface gets in the relay
+ * @param[in,out] addr  the address to listen on, TCP or UNIX; set to the
+ *                      address actually bound
+ *
+ * @return the interface's epoll set, which the IO loop has to watch for
+ *         reading and then call \ref ccnl_stream_rx, or -1 on error
+ */
+int
+ccnl_stream_listen(struct ccnl_relay_s *relay, int ifndx, sockunion *addr);
+
+/**
+ * @brief Accepts connections, reads and writes on the stream interface
+ *        @p ifndx, and hands the complete packets read to @p deliver
+ *
+ * The data passed to @p deliver is only valid until @p deliver returns.
+ */
+void
+ccnl_stream_rx(struct ccnl_relay_s *relay, int ifndx,
+               ccnl_stream_deliver_func deliver);
+
+/**
+ * @brief Appends a packet to the connection to @p dest, opening the
+ *        connection if there is none
+ *
+ * @return the length of the packet, -1 if it was dropped
+ */
+ssize_t
+ccnl_stream_send(int ifndx, sockunion *dest, uint8_t *data, size_t len);
+
+/**
+ * @brief Writes what was appended to the connections since the last flush
+ */
+void
+ccnl_stream_flush(void);
+
+/**
+ * @brief Closes all connections and listening sockets
+ *
+ * The epoll sets are closed with the interfaces they are the socket of.
+ */
+void
+ccnl_stream_cleanup(void);
+
+#endif // CCNL_STREAM_H
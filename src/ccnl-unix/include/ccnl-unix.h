@@ -93,6 +93,16 @@ void
 ccnl_relay_udp(struct ccnl_relay_s *relay, int32_t port, int af, int suite);
 #endif
 
+/**
+ * @brief Adds stream interfaces, whose faces are connections of their own
+ *
+ * @param[in] relay     the relay
+ * @param[in] tcpport   the TCP port to listen on, -1 for none
+ * @param[in] uxpath    the UNIX stream socket to listen on, NULL for none
+ */
+void
+ccnl_relay_stream(struct ccnl_relay_s *relay, int32_t tcpport, char *uxpath);
+
 void
 ccnl_ll_TX(struct ccnl_relay_s *ccnl, struct ccnl_if_s *ifc,
            sockunion *dest, struct ccnl_buf_s *buf);
@@ -104,6 +114,82 @@ ccnl_relay_config(struct ccnl_relay_s *relay, char *ethdev, char *wpandev,
                   char *uxpath, int suite, int max_cache_entries,
                   char *crypto_face_path);
 
+#ifndef CCNL_RX_BATCH
+#define CCNL_RX_BATCH           16  // datagrams read from a socket per wakeup
+#endif
+#define CCNL_MAX_RX_BATCH       1024
+
+/**
+ * @brief Sets how many datagrams the IO loop reads from an interface at once
+ *
+ * Takes effect when \ref ccnl_io_loop is started.
+ *
+ * @param[in] batch     the batch size, between 1 and CCNL_MAX_RX_BATCH
+ *
+ * @return 0 on success, -1 if the batch size is out of range
+ */
+int
+ccnl_io_set_rx_batch(int batch);
+
+/**
+ * @brief Selects what the IO loop waits for sockets and timers with
+ *
+ * "uring" falls back to "epoll" where the kernel does not support it, and
+ * "epoll" falls back to "select". Takes effect when \ref ccnl_io_loop is
+ * started.
+ *
+ * @param[in] name      "select", "epoll" or "uring"
+ *
+ * @return 0 on success, -1 if the name is unknown or not compiled in
+ */
+int
+ccnl_io_set_backend(const char *name);
+
+/**
+ * @brief Turns on UDP segmentation offload (GSO and GRO) for UDP interfaces
+ *
+ * Runs of equally sized datagrams queued for one peer then leave in a
+ * single send, and the kernel may return several datagrams from one peer
+ * in a single read. Takes effect for the interfaces \ref ccnl_relay_udp
+ * opens afterwards, as far as the kernel supports it.
+ *
+ * @param[in] on        1 to use segmentation offload, 0 not to
+ *
+ * @return 0 on success, -1 if segmentation offload is not compiled in
+ */
+int
+ccnl_io_use_udp_offload(int on);
+
+/**
+ * @brief Makes the IO loop use mmap'ed TPACKET_V3 rings on Ethernet devices
+ *
+ * Frames are then handed to the relay straight out of the receive ring and
+ * built in place in the transmit ring, without a copy or a system call per
+ * frame. Devices where the kernel refuses the rings keep using their socket.
+ * Takes effect when \ref ccnl_io_loop is started.
+ *
+ * @param[in] on        1 to use packet rings, 0 for plain sockets
+ *
+ * @return 0 on success, -1 if packet rings are not compiled in
+ */
+int
+ccnl_io_use_packet_rings(int on);
+
+/**
+ * @brief Makes the IO loop hand NDN and CCNx packets to forwarding threads
+ *
+ * Each thread owns the PIT and CS entries of the names hashed to it, see
+ * ccnl-shard.h. Packet rings are not used then. Takes effect when
+ * \ref ccnl_io_loop is started.
+ *
+ * @param[in] count     number of threads, 0 to forward in the IO loop
+ * @param[in] comps     number of name components a thread is chosen by
+ *
+ * @return 0 on success, -1 if threads are not compiled in or out of range
+ */
+int
+ccnl_io_set_shards(int count, int comps);
+
 int
 ccnl_io_loop(struct ccnl_relay_s *ccnl);
 
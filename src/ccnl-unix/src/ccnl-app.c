@@ -0,0 +1,99 @@
+/*
+ * @f ccnl-app.c
+ * @b CCN lite, in-process application face for embedding the relay
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * File history:
+ * 2018-10-02 created
+ */
+
+#include "ccnl-app.h"
+
+#include "ccnl-os-includes.h"
+
+#include "ccnl-core.h"
+#include "ccnl-dispatch.h"
+
+int
+ccnl_app_open(struct ccnl_relay_s *relay, ccnl_cb_on_app_data rx)
+{
+    struct ccnl_face_s *f = ccnl_get_face_or_create(relay, -1, NULL, 0);
+
+    if (!f) {
+        DEBUGMSG(ERROR, "no local face for the application\n");
+        return -1;
+    }
+    // the face does not time out, and what the application produces is cached
+    f->flags |= CCNL_FACE_FLAGS_STATIC | CCNL_FACE_FLAGS_APP;
+    relay->app_face = f;
+    relay->app_rx = rx;
+    DEBUGMSG(INFO, "application attached to the local face %d\n", f->faceid);
+    return 0;
+}
+
+int
+ccnl_app_send(struct ccnl_relay_s *relay, uint8_t *data, size_t len)
+{
+    struct ccnl_buf_s *buf, **pp;
+
+    if (!relay->app_face) {
+        return -1;
+    }
+    if (relay->app_busy) {
+        // called back while the relay walks its tables: the packet is
+        // processed once the relay is done with the current one
+        buf = ccnl_buf_new(data, len);
+        if (!buf) {
+            return -1;
+        }
+        for (pp = &relay->app_queue; *pp; pp = &(*pp)->next);
+        *pp = buf;
+        return 0;
+    }
+    ccnl_core_RX(relay, -1, data, len, NULL, 0);
+    ccnl_app_flush(relay);
+    return 0;
+}
+
+void
+ccnl_app_flush(struct ccnl_relay_s *relay)
+{
+    struct ccnl_buf_s *buf;
+
+    while (!relay->app_busy && (buf = relay->app_queue)) {
+        relay->app_queue = buf->next;
+        buf->next = NULL;
+        if (relay->app_face) {
+            ccnl_core_RX(relay, -1, buf->data, buf->datalen, NULL, 0);
+        }
+        ccnl_buf_free(buf);
+    }
+}
+
+void
+ccnl_app_close(struct ccnl_relay_s *relay)
+{
+    struct ccnl_buf_s *buf;
+
+    if (relay->app_face) {
+        ccnl_face_remove(relay, relay->app_face);
+    }
+    relay->app_rx = NULL;
+    while ((buf = relay->app_queue)) {
+        relay->app_queue = buf->next;
+        ccnl_buf_free(buf);
+    }
+}
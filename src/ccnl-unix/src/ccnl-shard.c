@@ -0,0 +1,532 @@
+/*
+ * @f ccnl-shard.c
+ * @b CCN lite, forwarding threads with a shard of the PIT and CS each
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * File history:
+ * 2018-09-20 created
+ */
+
+#define _GNU_SOURCE
+
+#include "ccnl-shard.h"
+
+#include "ccnl-os-includes.h"
+
+#include "ccnl-core.h"
+#include "ccnl-dispatch.h"
+#include "ccnl-pkt-ccntlv.h"
+#include "ccnl-pkt-ndntlv.h"
+
+#ifdef USE_SHARDS
+
+// a frame on its way from the IO loop to a forwarding thread
+struct ccnl_shard_msg_s {
+    struct ccnl_buf_s *buf;
+    int ifndx;
+    size_t addrlen;
+    sockunion src;
+};
+
+// a FIB entry of the front, with the face it points at
+struct ccnl_shard_route_s {
+    struct ccnl_prefix_s *prefix;
+    tapCallback tap;
+    int ifndx;                  // -1: no face
+    int flags;
+    sockunion peer;
+};
+
+// a copy of the front's FIB, for one thread
+struct ccnl_shard_fib_s {
+    int count;
+    struct ccnl_shard_route_s routes[];
+};
+
+struct ccnl_shard_s {
+    struct ccnl_relay_s *relay;
+    pthread_t thread;
+    int running;
+    int efd;                    // eventfd the thread waits on when idle
+    int sleeping;               // the thread is (about to be) waiting
+    int halt;
+    struct ccnl_shard_fib_s *fib; // FIB copy the thread has not taken yet
+    unsigned int head;          // next message to process, by the thread
+    unsigned int tail;          // next free slot, by the IO loop
+    uint32_t drops;
+    struct ccnl_shard_msg_s ring[CCNL_SHARD_QLEN];
+};
+
+static struct ccnl_shard_s *shards;
+static int shardcnt;
+static uint32_t shardcomps;
+static uint32_t synced_epoch;
+#ifdef USE_SUITE_NDNTLV
+static uint32_t mgmt_hash;      // hash of an NDN name starting with /ccnx
+#endif
+
+static void
+ccnl_shard_wake(struct ccnl_shard_s *sh)
+{
+    uint64_t one = 1;
+
+    if (write(sh->efd, &one, sizeof(one)) < 0) {
+        DEBUGMSG(DEBUG, "waking forwarding thread: %s\n", strerror(errno));
+    }
+}
+
+static void
+ccnl_shard_fib_free(struct ccnl_shard_fib_s *fib)
+{
+    int k;
+
+    if (!fib) {
+        return;
+    }
+    for (k = 0; k < fib->count; k++) {
+        if (fib->routes[k].prefix) { // NULL once taken over by a thread
+            ccnl_prefix_free(fib->routes[k].prefix);
+        }
+    }
+    ccnl_free(fib);
+}
+
+static struct ccnl_shard_fib_s*
+ccnl_shard_fib_new(struct ccnl_relay_s *front)
+{
+    struct ccnl_shard_fib_s *fib;
+    struct ccnl_forward_s *fwd;
+    int n = 0;
+
+    for (fwd = front->fib; fwd; fwd = fwd->next) {
+        n++;
+    }
+    fib = (struct ccnl_shard_fib_s*) ccnl_calloc(1, sizeof(*fib) +
+                                        n * sizeof(struct ccnl_shard_route_s));
+    if (!fib) {
+        return NULL;
+    }
+    for (fwd = front->fib; fwd; fwd = fwd->next) {
+        struct ccnl_shard_route_s *r = fib->routes + fib->count;
+
+        if (!fwd->prefix) {
+            continue;
+        }
+        r->prefix = ccnl_prefix_dup(fwd->prefix);
+        if (!r->prefix) {
+            ccnl_shard_fib_free(fib);
+            return NULL;
+        }
+        r->prefix->suite = fwd->suite;
+        r->tap = fwd->tap;
+        r->ifndx = -1;
+        if (fwd->face) {
+            r->ifndx = fwd->face->ifndx;
+            r->flags = fwd->face->flags & (CCNL_FACE_FLAGS_REFLECT |
+                                           CCNL_FACE_FLAGS_FWDALLI);
+            r->peer = fwd->face->peer;
+        }
+        fib->count++;
+    }
+    return fib;
+}
+
+// replaces the thread's FIB by a copy of the front's
+static void
+ccnl_shard_fib_apply(struct ccnl_relay_s *relay, struct ccnl_shard_fib_s *fib)
+{
+    struct ccnl_forward_s *fwd;
+    struct ccnl_face_s *f;
+    int k;
+
+    while ((fwd = relay->fib)) {
+        ccnl_fib_unlink(relay, fwd);
+        ccnl_prefix_free(fwd->prefix);
+        ccnl_free(fwd);
+    }
+    for (k = 0; k < fib->count; k++) {
+        struct ccnl_shard_route_s *r = fib->routes + k;
+
+        fwd = (struct ccnl_forward_s *) ccnl_calloc(1, sizeof(*fwd));
+        if (!fwd) {
+            break;
+        }
+        if (r->ifndx >= 0) {
+            fwd->face = ccnl_get_face_or_create(relay, r->ifndx, &r->peer.sa,
+                                                sizeof(r->peer));
+            if (!fwd->face) {
+                ccnl_free(fwd);
+                continue;
+            }
+            // the front decides how long the face lives
+            fwd->face->flags |= r->flags | CCNL_FACE_FLAGS_STATIC;
+        }
+        fwd->prefix = r->prefix;
+        fwd->suite = r->prefix->suite;
+        fwd->tap = r->tap;
+        r->prefix = NULL;
+        if (ccnl_fib_link(relay, fwd)) {
+            ccnl_prefix_free(fwd->prefix);
+            ccnl_free(fwd);
+        }
+    }
+    // faces of routes which are gone age like the thread's other faces
+    for (f = relay->faces; f; f = f->next) {
+        if ((f->flags & CCNL_FACE_FLAGS_STATIC) && !f->fwds) {
+            f->flags &= ~CCNL_FACE_FLAGS_STATIC;
+            ccnl_wheel_schedule(&relay->face_wheel, &f->wlink,
+                                f->last_used + CCNL_FACE_TIMEOUT);
+        }
+    }
+}
+
+// waits until there is something to do, or the next ageing is due
+static void
+ccnl_shard_idle(struct ccnl_shard_s *sh, unsigned int head, double ageing)
+{
+    struct pollfd pfd = { sh->efd, POLLIN, 0 };
+    uint64_t cnt;
+
+    // the IO loop wakes us if it queues something after this store, and
+    // otherwise we see what it queued in the checks below
+    __atomic_store_n(&sh->sleeping, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&sh->tail, __ATOMIC_SEQ_CST) == head &&
+                        !__atomic_load_n(&sh->fib, __ATOMIC_SEQ_CST) &&
+                        !__atomic_load_n(&sh->halt, __ATOMIC_SEQ_CST)) {
+        if (poll(&pfd, 1, (int) ((ageing - CCNL_NOW()) * 1000) + 1) > 0 &&
+                            read(sh->efd, &cnt, sizeof(cnt)) < 0) {
+            DEBUGMSG(DEBUG, "forwarding thread: %s\n", strerror(errno));
+        }
+    }
+    __atomic_store_n(&sh->sleeping, 0, __ATOMIC_SEQ_CST);
+}
+
+static void*
+ccnl_shard_main(void *arg)
+{
+    struct ccnl_shard_s *sh = (struct ccnl_shard_s*) arg;
+    struct ccnl_relay_s *relay = sh->relay;
+    double ageing = CCNL_NOW() + 1;
+
+    while (!__atomic_load_n(&sh->halt, __ATOMIC_ACQUIRE)) {
+        struct ccnl_shard_fib_s *fib;
+        unsigned int start = sh->head, head;
+        unsigned int tail = __atomic_load_n(&sh->tail, __ATOMIC_ACQUIRE);
+
+        fib = __atomic_exchange_n(&sh->fib, NULL, __ATOMIC_ACQ_REL);
+        if (fib) {
+            ccnl_shard_fib_apply(relay, fib);
+            ccnl_shard_fib_free(fib);
+        }
+        for (head = start; head != tail; head++) {
+            struct ccnl_shard_msg_s *m = sh->ring + head % CCNL_SHARD_QLEN;
+
+            ccnl_core_RX_buf(relay, m->ifndx, m->buf, &m->src.sa, m->addrlen);
+            __atomic_store_n(&sh->head, head + 1, __ATOMIC_RELEASE);
+        }
+        if (CCNL_NOW() >= ageing) {
+            ccnl_do_ageing(relay, NULL);
+            ageing = CCNL_NOW() + 1;
+        } else if (!fib && start == tail) {
+            ccnl_shard_idle(sh, tail, ageing);
+        }
+    }
+    return NULL;
+}
+
+// the forwarding thread for a name, given the hashes of its first components
+static struct ccnl_shard_s*
+ccnl_shard_of(uint32_t *hashes, uint32_t n)
+{
+    return shards + hashes[n] % (uint32_t) shardcnt;
+}
+
+static int
+ccnl_shard_limit(int limit, int count)
+{
+    return limit > 0 ? (limit + count - 1) / count : limit;
+}
+
+// the suites whose Interests and Data go to the forwarding threads
+static int
+ccnl_shard_suite(int suite)
+{
+    switch (suite) {
+#ifdef USE_SUITE_CCNTLV
+    case CCNL_SUITE_CCNTLV:
+        return 1;
+#endif
+#ifdef USE_SUITE_NDNTLV
+    case CCNL_SUITE_NDNTLV:
+        return 1;
+#endif
+    default:
+        return 0;
+    }
+}
+
+// moves the front's content to the threads, before these are started
+static void
+ccnl_shard_move_cs(struct ccnl_relay_s *front)
+{
+    uint32_t hashes[CCNL_MAX_NAME_COMP + 1];
+    struct ccnl_content_s *c = front->contents;
+
+    while (c) {
+        struct ccnl_pkt_s *pkt = c->pkt;
+        struct ccnl_content_s *c2;
+        struct ccnl_shard_s *sh;
+        int flags = c->flags;
+
+        if (!ccnl_shard_suite(pkt->pfx->suite)) {
+            c = c->next;
+            continue;
+        }
+        sh = ccnl_shard_of(hashes, ccnl_prefix_hashes(pkt->pfx, hashes,
+                                                      shardcomps));
+        c->pkt = NULL; // the packet moves along, without being copied
+        c = ccnl_content_remove(front, c);
+        c2 = ccnl_content_new(&pkt);
+        if (!c2) {
+            ccnl_pkt_free(pkt);
+            continue;
+        }
+        c2->flags = flags;
+        if (!ccnl_content_add2cache(sh->relay, c2)) {
+            ccnl_content_free(c2);
+        }
+    }
+}
+
+int
+ccnl_shard_setup(struct ccnl_relay_s *front, int count, int comps)
+{
+    struct ccnl_forward_s *fwd;
+    int k, i;
+
+    if (shardcnt || count < 1 || count > CCNL_SHARD_MAX ||
+                    comps < 1 || comps > CCNL_MAX_NAME_COMP) {
+        return -1;
+    }
+    // the threads cannot reach in-memory faces, nor tell them apart
+    for (fwd = front->fib; fwd; fwd = fwd->next) {
+        if (fwd->prefix && fwd->face && fwd->face->ifndx < 0) {
+            char s[CCNL_MAX_PREFIX_SIZE];
+            (void) s;
+
+            DEBUGMSG(ERROR, "route <%s> is over face %d, which has no "
+                     "interface: no forwarding threads\n",
+                     ccnl_prefix_to_str(fwd->prefix, s, CCNL_MAX_PREFIX_SIZE),
+                     fwd->face->faceid);
+            return -1;
+        }
+    }
+    shards = (struct ccnl_shard_s*) ccnl_calloc(count, sizeof(*shards));
+    if (!shards) {
+        return -1;
+    }
+    shardcnt = count;
+    shardcomps = (uint32_t) comps;
+    for (k = 0; k < count; k++) {
+        shards[k].efd = -1;
+    }
+    for (k = 0; k < count; k++) {
+        struct ccnl_shard_s *sh = shards + k;
+        struct ccnl_relay_s *relay;
+
+        relay = (struct ccnl_relay_s*) ccnl_calloc(1, sizeof(*relay));
+        if (!relay) {
+            goto Bail;
+        }
+        sh->relay = relay;
+        sh->efd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (sh->efd < 0) {
+            DEBUGMSG(ERROR, "eventfd: %s\n", strerror(errno));
+            goto Bail;
+        }
+        relay->id = k + 1;
+        relay->startup_time = front->startup_time;
+        relay->ccnl_ll_TX_ptr = front->ccnl_ll_TX_ptr;
+        relay->max_cache_entries = ccnl_shard_limit(front->max_cache_entries,
+                                                    count);
+        relay->max_pit_entries = ccnl_shard_limit(front->max_pit_entries,
+                                                  count);
+        relay->nonce_window = front->nonce_window;
+        relay->retrans_period = front->retrans_period;
+        relay->max_nonces = ccnl_shard_limit(front->max_nonces, count);
+        // the same interfaces, on the front's sockets
+        relay->ifcount = front->ifcount;
+        for (i = 0; i < front->ifcount; i++) {
+            relay->ifs[i].addr = front->ifs[i].addr;
+            relay->ifs[i].sock = front->ifs[i].sock;
+            relay->ifs[i].mtu = front->ifs[i].mtu;
+            relay->ifs[i].reflect = front->ifs[i].reflect;
+            relay->ifs[i].fwdalli = front->ifs[i].fwdalli;
+        }
+    }
+#ifdef USE_SUITE_NDNTLV
+    mgmt_hash = ccnl_hash_uint(CCNL_HASH_INIT, (uint8_t) CCNL_SUITE_NDNTLV);
+    mgmt_hash = ccnl_hash_bytes(ccnl_hash_uint(mgmt_hash, 4), "ccnx", 4);
+#endif
+
+    ccnl_shard_move_cs(front);
+    synced_epoch = front->fib_epoch - 1;
+    ccnl_shard_sync(front);
+
+    for (k = 0; k < count; k++) {
+        if (pthread_create(&shards[k].thread, NULL, ccnl_shard_main,
+                           shards + k)) {
+            DEBUGMSG(ERROR, "could not start forwarding thread %d\n", k + 1);
+            goto Bail;
+        }
+        shards[k].running = 1;
+    }
+    front->fib_ifaces_only = 1;
+    DEBUGMSG(INFO, "%d forwarding threads, sharded by %d name components\n",
+             count, comps);
+    return 0;
+
+Bail:
+    ccnl_shard_cleanup();
+    return -1;
+}
+
+int
+ccnl_shard_dispatch(int ifndx, uint8_t *data, size_t len,
+                    sockunion *src, size_t addrlen)
+{
+    uint32_t hashes[CCNL_MAX_NAME_COMP + 1];
+    struct ccnl_shard_msg_s *m;
+    struct ccnl_shard_s *sh;
+    unsigned int tail;
+    size_t skip;
+    int n = -1;
+
+    if (!shardcnt || addrlen > sizeof(*src)) {
+        return -1;
+    }
+    switch (ccnl_pkt2suite(data, len, &skip)) {
+#ifdef USE_SUITE_CCNTLV
+    case CCNL_SUITE_CCNTLV:
+        n = ccnl_ccntlv_name_hashes(data + skip, len - skip, hashes,
+                                    shardcomps);
+        break;
+#endif
+#ifdef USE_SUITE_NDNTLV
+    case CCNL_SUITE_NDNTLV:
+        n = ccnl_ndntlv_name_hashes(data + skip, len - skip, hashes,
+                                    shardcomps);
+        if (n >= 1 && hashes[1] == mgmt_hash) {
+            n = -1; // management requests are for the front
+        }
+        break;
+#endif
+    default:
+        break;
+    }
+    if (n < 0) {
+        return -1;
+    }
+
+    sh = ccnl_shard_of(hashes, (uint32_t) n);
+    tail = sh->tail;
+    if (tail - __atomic_load_n(&sh->head, __ATOMIC_ACQUIRE) >= CCNL_SHARD_QLEN) {
+        sh->drops++;
+        DEBUGMSG(DEBUG, "forwarding thread %d congested, dropping packet\n",
+                 sh->relay->id);
+        return 0;
+    }
+    m = sh->ring + tail % CCNL_SHARD_QLEN;
+    m->buf = ccnl_buf_adopt(data, len);
+    if (!m->buf) {
+        return 0;
+    }
+    m->ifndx = ifndx;
+    m->addrlen = addrlen;
+    memcpy(&m->src, src, addrlen);
+    __atomic_store_n(&sh->tail, tail + 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&sh->sleeping, __ATOMIC_SEQ_CST)) {
+        ccnl_shard_wake(sh);
+    }
+    return 0;
+}
+
+void
+ccnl_shard_sync(struct ccnl_relay_s *front)
+{
+    int k;
+
+    if (!shardcnt || front->fib_epoch == synced_epoch) {
+        return;
+    }
+    for (k = 0; k < shardcnt; k++) {
+        struct ccnl_shard_fib_s *fib = ccnl_shard_fib_new(front);
+
+        if (!fib) {
+            DEBUGMSG(WARNING, "no memory for the FIB of the forwarding threads\n");
+            return; // tried again on the next call
+        }
+        // a copy the thread has not taken yet is outdated
+        ccnl_shard_fib_free(__atomic_exchange_n(&shards[k].fib, fib,
+                                                __ATOMIC_ACQ_REL));
+        ccnl_shard_wake(shards + k);
+    }
+    synced_epoch = front->fib_epoch;
+}
+
+void
+ccnl_shard_cleanup(void)
+{
+    int k, i;
+
+    for (k = 0; k < shardcnt; k++) {
+        __atomic_store_n(&shards[k].halt, 1, __ATOMIC_SEQ_CST);
+        if (shards[k].running) {
+            ccnl_shard_wake(shards + k);
+        }
+    }
+    for (k = 0; k < shardcnt; k++) {
+        struct ccnl_shard_s *sh = shards + k;
+
+        if (sh->running) {
+            pthread_join(sh->thread, NULL);
+        }
+        for (; sh->head != sh->tail; sh->head++) {
+            ccnl_buf_free(sh->ring[sh->head % CCNL_SHARD_QLEN].buf);
+        }
+        ccnl_shard_fib_free(sh->fib);
+        if (sh->drops) {
+            DEBUGMSG(INFO, "forwarding thread %d dropped %u packets\n",
+                     k + 1, (unsigned) sh->drops);
+        }
+        if (sh->relay) {
+            // the sockets are the front's
+            for (i = 0; i < sh->relay->ifcount; i++) {
+                sh->relay->ifs[i].sock = -1;
+            }
+            ccnl_core_cleanup(sh->relay);
+            ccnl_free(sh->relay);
+        }
+        if (sh->efd >= 0) {
+            close(sh->efd);
+        }
+    }
+    ccnl_free(shards);
+    shards = NULL;
+    shardcnt = 0;
+}
+
+#endif // USE_SHARDS
@@ -0,0 +1,523 @@
+/*
+ * @f ccnl-shm.c
+ * @b CCN lite, shared memory faces for applications on the same host
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * File history:
+ * 2018-09-27 created
+ */
+
+#define _GNU_SOURCE // memfd_create
+
+#include "ccnl-shm.h"
+
+#include "ccnl-os-includes.h"
+
+#include "ccnl-core.h"
+
+#ifdef USE_SHM_FACES
+
+#define CCNL_SHM_MAGIC          0x63736d31 // "csm1"
+#define CCNL_SHM_LINE           64         // keeps the indices apart
+
+// datagram asking for, or releasing, a channel; the answer to a request
+// carries the memfd and the two doorbells
+struct ccnl_shm_ctrl_s {
+    char tag[8];
+    uint32_t op;
+};
+
+#define CCNL_SHM_TAG            "ccnl-shm"
+#define CCNL_SHM_OP_REQUEST     1
+#define CCNL_SHM_OP_GRANT       2
+#define CCNL_SHM_OP_REFUSE      3
+#define CCNL_SHM_OP_RELEASE     4
+
+struct ccnl_shm_slot_s {
+    uint32_t len;
+    uint8_t data[CCNL_MAX_PACKET_SIZE];
+};
+
+struct ccnl_shm_ring_s {
+    uint32_t head;              // next slot to read, by the consumer
+    uint8_t pad0[CCNL_SHM_LINE - sizeof(uint32_t)];
+    uint32_t tail;              // next slot to fill, by the producer
+    uint8_t pad1[CCNL_SHM_LINE - sizeof(uint32_t)];
+    uint32_t waiting;           // the consumer wants its doorbell rung
+    uint8_t pad2[CCNL_SHM_LINE - sizeof(uint32_t)];
+    struct ccnl_shm_slot_s slots[CCNL_SHM_SLOTS];
+};
+
+struct ccnl_shm_area_s {
+    uint32_t magic;
+    uint32_t slots;
+    uint32_t slotsize;
+    uint8_t pad[CCNL_SHM_LINE - 3 * sizeof(uint32_t)];
+    struct ccnl_shm_ring_s up;  // application to relay
+    struct ccnl_shm_ring_s down; // relay to application
+};
+
+// the relay's end of a channel
+struct ccnl_shm_chan_s {
+    struct ccnl_shm_chan_s *next;
+    struct ccnl_shm_area_s *area;
+    int bell;                   // the application's doorbell
+    int ifndx;
+    sockunion peer;
+};
+
+static struct ccnl_shm_chan_s *chans;
+static int chancnt;             // at most CCNL_SHM_MAX_CHANS
+static int relay_bell = -1;
+// the private buffers packets are copied to from the rings
+static struct ccnl_bufpool_s rxpool = { NULL, CCNL_MAX_PACKET_SIZE, 0, 1, 0, NULL };
+static struct ccnl_buf_s *rxbuf;
+
+static int
+ccnl_shm_put(struct ccnl_shm_ring_s *r, uint8_t *data, size_t len)
+{
+    uint32_t tail = r->tail;
+    struct ccnl_shm_slot_s *s;
+
+    if (len > sizeof(s->data) ||
+        tail - __atomic_load_n(&r->head, __ATOMIC_ACQUIRE) >= CCNL_SHM_SLOTS) {
+        return -1;
+    }
+    s = r->slots + tail % CCNL_SHM_SLOTS;
+    s->len = (uint32_t) len;
+    memcpy(s->data, data, len);
+    __atomic_store_n(&r->tail, tail + 1, __ATOMIC_SEQ_CST);
+    return 0;
+}
+
+// rings the consumer's doorbell if it sleeps
+static void
+ccnl_shm_ring(struct ccnl_shm_ring_s *r, int bell)
+{
+    uint64_t one = 1;
+
+    if (__atomic_load_n(&r->waiting, __ATOMIC_SEQ_CST) &&
+                        write(bell, &one, sizeof(one)) < 0) {
+        DEBUGMSG(DEBUG, "shm doorbell: %s\n", strerror(errno));
+    }
+}
+
+static void
+ccnl_shm_send_ctrl(int sock, struct sockaddr_un *to, uint32_t op, int *fds,
+                   int fdcnt)
+{
+    struct ccnl_shm_ctrl_s ctrl;
+    union {
+        struct cmsghdr hdr;
+        char buf[CMSG_SPACE(3 * sizeof(int))];
+    } cbuf;
+    struct iovec iov = { &ctrl, sizeof(ctrl) };
+    struct msghdr msg;
+
+    memset(&ctrl, 0, sizeof(ctrl));
+    memcpy(ctrl.tag, CCNL_SHM_TAG, sizeof(ctrl.tag));
+    ctrl.op = op;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_name = to;
+    msg.msg_namelen = sizeof(*to);
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    if (fdcnt > 0) {
+        struct cmsghdr *cm;
+
+        memset(&cbuf, 0, sizeof(cbuf));
+        msg.msg_control = cbuf.buf;
+        msg.msg_controllen = CMSG_SPACE(fdcnt * sizeof(int));
+        cm = CMSG_FIRSTHDR(&msg);
+        cm->cmsg_level = SOL_SOCKET;
+        cm->cmsg_type = SCM_RIGHTS;
+        cm->cmsg_len = CMSG_LEN(fdcnt * sizeof(int));
+        memcpy(CMSG_DATA(cm), fds, fdcnt * sizeof(int));
+    }
+    if (sendmsg(sock, &msg, MSG_DONTWAIT) < 0) {
+        DEBUGMSG(DEBUG, "shm control to %s: %s\n", to->sun_path,
+                 strerror(errno));
+    }
+}
+
+static void
+ccnl_shm_chan_free(struct ccnl_shm_chan_s *ch)
+{
+    munmap(ch->area, sizeof(*ch->area));
+    close(ch->bell);
+    ccnl_free(ch);
+}
+
+// unlinks and frees the channel of the application at path, if any
+static void
+ccnl_shm_release(const char *path)
+{
+    struct ccnl_shm_chan_s **pp, *ch;
+
+    for (pp = &chans; (ch = *pp); pp = &ch->next) {
+        if (!strncmp(ch->peer.ux.sun_path, path, sizeof(ch->peer.ux.sun_path))) {
+            *pp = ch->next;
+            chancnt--;
+            DEBUGMSG(INFO, "shm channel of %s closed\n", path);
+            ccnl_shm_chan_free(ch);
+            return;
+        }
+    }
+}
+
+// creates a channel, and the memfd to hand to the application
+static struct ccnl_shm_chan_s*
+ccnl_shm_grant(int ifndx, sockunion *src, int *memfd)
+{
+    struct ccnl_shm_chan_s *ch;
+
+    ch = (struct ccnl_shm_chan_s*) ccnl_calloc(1, sizeof(*ch));
+    if (!ch) {
+        return NULL;
+    }
+    ch->ifndx = ifndx;
+    ch->peer = *src;
+    ch->bell = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    *memfd = memfd_create("ccnl-shm", MFD_CLOEXEC);
+    if (ch->bell < 0 || *memfd < 0 ||
+                        ftruncate(*memfd, sizeof(struct ccnl_shm_area_s))) {
+        goto Bail;
+    }
+    ch->area = (struct ccnl_shm_area_s*) mmap(NULL, sizeof(*ch->area),
+                        PROT_READ | PROT_WRITE, MAP_SHARED, *memfd, 0);
+    if (ch->area == MAP_FAILED) {
+        ch->area = NULL;
+        goto Bail;
+    }
+    ch->area->magic = CCNL_SHM_MAGIC;
+    ch->area->slots = CCNL_SHM_SLOTS;
+    ch->area->slotsize = CCNL_MAX_PACKET_SIZE;
+    ch->area->up.waiting = 1; // see ccnl_shm_rx
+    return ch;
+
+Bail:
+    DEBUGMSG(WARNING, "no shm channel for %s: %s\n", src->ux.sun_path,
+             strerror(errno));
+    if (*memfd >= 0) {
+        close(*memfd);
+    }
+    if (ch->bell >= 0) {
+        close(ch->bell);
+    }
+    ccnl_free(ch);
+    return NULL;
+}
+
+int
+ccnl_shm_setup(void)
+{
+    if (relay_bell < 0) {
+        relay_bell = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    }
+    return relay_bell;
+}
+
+int
+ccnl_shm_control(struct ccnl_relay_s *relay, int ifndx, uint8_t *data,
+                 size_t len, sockunion *src)
+{
+    struct ccnl_shm_ctrl_s ctrl;
+    struct ccnl_shm_chan_s *ch;
+    int fds[3];
+
+    if (len != sizeof(ctrl) || src->sa.sa_family != AF_UNIX) {
+        return -1;
+    }
+    memcpy(&ctrl, data, sizeof(ctrl));
+    if (memcmp(ctrl.tag, CCNL_SHM_TAG, sizeof(ctrl.tag))) {
+        return -1;
+    }
+
+    // an application which asks again has restarted
+    ccnl_shm_release(src->ux.sun_path);
+    if (ctrl.op != CCNL_SHM_OP_REQUEST) {
+        return 0;
+    }
+    if (chancnt >= CCNL_SHM_MAX_CHANS) {
+        DEBUGMSG(WARNING, "no shm channel for %s: %d channels open\n",
+                 src->ux.sun_path, chancnt);
+        ch = NULL;
+    } else {
+        ch = relay_bell < 0 ? NULL : ccnl_shm_grant(ifndx, src, fds);
+    }
+    if (!ch) {
+        ccnl_shm_send_ctrl(relay->ifs[ifndx].sock, &src->ux,
+                           CCNL_SHM_OP_REFUSE, NULL, 0);
+        return 0;
+    }
+    fds[1] = relay_bell;
+    fds[2] = ch->bell;
+    ccnl_shm_send_ctrl(relay->ifs[ifndx].sock, &src->ux, CCNL_SHM_OP_GRANT,
+                       fds, 3);
+    close(fds[0]); // the mapping stays
+    ch->next = chans;
+    chans = ch;
+    chancnt++;
+    DEBUGMSG(INFO, "shm channel of %s opened\n", src->ux.sun_path);
+    return 0;
+}
+
+struct ccnl_shm_chan_s*
+ccnl_shm_of(sockunion *dest)
+{
+    struct ccnl_shm_chan_s *ch;
+
+    // a handful of local applications at most: a list does
+    for (ch = chans; ch; ch = ch->next) {
+        if (!strncmp(ch->peer.ux.sun_path, dest->ux.sun_path,
+                     sizeof(dest->ux.sun_path))) {
+            return ch;
+        }
+    }
+    return NULL;
+}
+
+ssize_t
+ccnl_shm_send(struct ccnl_shm_chan_s *ch, uint8_t *data, size_t len)
+{
+    if (ccnl_shm_put(&ch->area->down, data, len)) {
+        return -1;
+    }
+    ccnl_shm_ring(&ch->area->down, ch->bell);
+    return (ssize_t) len;
+}
+
+void
+ccnl_shm_rx(struct ccnl_relay_s *relay, ccnl_shm_deliver_func deliver)
+{
+    struct ccnl_shm_chan_s *ch;
+    uint64_t cnt;
+    int more = 0;
+
+    if (!rxbuf) {
+        rxbuf = ccnl_bufpool_get(&rxpool);
+        if (!rxbuf) {
+            return; // the doorbell stays readable
+        }
+    }
+    if (read(relay_bell, &cnt, sizeof(cnt)) < 0 && errno != EAGAIN) {
+        DEBUGMSG(DEBUG, "shm doorbell: %s\n", strerror(errno));
+    }
+    for (ch = chans; ch; ch = ch->next) {
+        struct ccnl_shm_ring_s *r = &ch->area->up;
+        uint32_t head = r->head, budget = CCNL_SHM_SLOTS;
+
+        // applications do not ring while the relay drains their ring, and
+        // what they put in after the last look is seen on the way out
+        __atomic_store_n(&r->waiting, 0, __ATOMIC_SEQ_CST);
+        for (;;) {
+            uint32_t tail = __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+
+            if (tail == head) {
+                __atomic_store_n(&r->waiting, 1, __ATOMIC_SEQ_CST);
+                if (__atomic_load_n(&r->tail, __ATOMIC_SEQ_CST) == head) {
+                    break;
+                }
+                __atomic_store_n(&r->waiting, 0, __ATOMIC_SEQ_CST);
+                continue;
+            }
+            if (tail - head > CCNL_SHM_SLOTS) {
+                DEBUGMSG(WARNING, "shm ring of %s is broken\n",
+                         ch->peer.ux.sun_path);
+                break;
+            }
+            if (!budget) {
+                // a ring's worth per call: the other events get their turn,
+                // the application still does not ring
+                more = 1;
+                break;
+            }
+            for (; head != tail && budget > 0; head++, budget--) {
+                struct ccnl_shm_slot_s *s = r->slots + head % CCNL_SHM_SLOTS;
+                uint32_t len = __atomic_load_n(&s->len, __ATOMIC_RELAXED);
+                int valid = len > 0 && len <= sizeof(s->data);
+
+                // the application may write the slot again once it is
+                // given back: only the copy is looked at
+                if (valid) {
+                    memcpy(rxbuf->data, s->data, len);
+                }
+                __atomic_store_n(&r->head, head + 1, __ATOMIC_RELEASE);
+                if (valid) {
+                    deliver(relay, ch->ifndx, rxbuf->data, len, &ch->peer,
+                            &rxbuf);
+                }
+            }
+        }
+    }
+    if (more) {
+        cnt = 1;
+        if (write(relay_bell, &cnt, sizeof(cnt)) < 0) {
+            DEBUGMSG(DEBUG, "shm doorbell: %s\n", strerror(errno));
+        }
+    }
+}
+
+void
+ccnl_shm_ageing(void)
+{
+    struct ccnl_shm_chan_s *ch = chans;
+
+    while (ch) {
+        char *path = ch->peer.ux.sun_path;
+
+        ch = ch->next;
+        if (access(path, F_OK)) {
+            ccnl_shm_release(path);
+        }
+    }
+}
+
+void
+ccnl_shm_cleanup(void)
+{
+    while (chans) {
+        struct ccnl_shm_chan_s *ch = chans;
+
+        chans = ch->next;
+        ccnl_shm_chan_free(ch);
+    }
+    chancnt = 0;
+    if (relay_bell >= 0) {
+        close(relay_bell);
+        relay_bell = -1;
+    }
+    ccnl_buf_free(rxbuf);
+    rxbuf = NULL;
+    ccnl_bufpool_drain(&rxpool);
+}
+
+int
+ccnl_shm_connect(int sock, struct sockaddr_un *relay,
+                 struct ccnl_shm_client_s *c, float wait)
+{
+    struct ccnl_shm_ctrl_s ctrl;
+    union {
+        struct cmsghdr hdr;
+        char buf[CMSG_SPACE(3 * sizeof(int))];
+    } cbuf;
+    struct iovec iov = { &ctrl, sizeof(ctrl) };
+    struct pollfd pfd = { sock, POLLIN, 0 };
+    struct msghdr msg;
+    struct cmsghdr *cm;
+    int fds[3];
+    void *area;
+
+    ccnl_shm_send_ctrl(sock, relay, CCNL_SHM_OP_REQUEST, NULL, 0);
+    if (poll(&pfd, 1, (int) (wait * 1000)) <= 0) {
+        return -1;
+    }
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = cbuf.buf;
+    msg.msg_controllen = sizeof(cbuf.buf);
+    if (recvmsg(sock, &msg, MSG_CMSG_CLOEXEC) != sizeof(ctrl) ||
+        memcmp(ctrl.tag, CCNL_SHM_TAG, sizeof(ctrl.tag)) ||
+        ctrl.op != CCNL_SHM_OP_GRANT) {
+        return -1;
+    }
+    cm = CMSG_FIRSTHDR(&msg);
+    if (!cm || cm->cmsg_type != SCM_RIGHTS ||
+               cm->cmsg_len != CMSG_LEN(sizeof(fds))) {
+        return -1;
+    }
+    memcpy(fds, CMSG_DATA(cm), sizeof(fds));
+    area = mmap(NULL, sizeof(*c->area), PROT_READ | PROT_WRITE, MAP_SHARED,
+                fds[0], 0);
+    close(fds[0]);
+    if (area == MAP_FAILED) {
+        close(fds[1]);
+        close(fds[2]);
+        return -1;
+    }
+    c->area = (struct ccnl_shm_area_s*) area;
+    c->relay_bell = fds[1];
+    c->bell = fds[2];
+    if (c->area->magic != CCNL_SHM_MAGIC || c->area->slots != CCNL_SHM_SLOTS ||
+        c->area->slotsize != CCNL_MAX_PACKET_SIZE) {
+        ccnl_shm_disconnect(sock, relay, c); // built differently
+        return -1;
+    }
+    return 0;
+}
+
+int
+ccnl_shm_client_send(struct ccnl_shm_client_s *c, uint8_t *data, size_t len)
+{
+    if (ccnl_shm_put(&c->area->up, data, len)) {
+        return -1;
+    }
+    ccnl_shm_ring(&c->area->up, c->relay_bell);
+    return 0;
+}
+
+ssize_t
+ccnl_shm_client_recv(struct ccnl_shm_client_s *c, uint8_t *buf, size_t size,
+                     float wait)
+{
+    struct ccnl_shm_ring_s *r = &c->area->down;
+    double deadline = CCNL_NOW() + wait;
+
+    for (;;) {
+        uint32_t head = r->head;
+
+        if (__atomic_load_n(&r->tail, __ATOMIC_ACQUIRE) != head) {
+            struct ccnl_shm_slot_s *s = r->slots + head % CCNL_SHM_SLOTS;
+            size_t len = s->len < size ? s->len : size;
+
+            memcpy(buf, s->data, len);
+            __atomic_store_n(&r->head, head + 1, __ATOMIC_RELEASE);
+            return (ssize_t) len;
+        }
+
+        __atomic_store_n(&r->waiting, 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&r->tail, __ATOMIC_SEQ_CST) == head) {
+            struct pollfd pfd = { c->bell, POLLIN, 0 };
+            double left = deadline - CCNL_NOW();
+            uint64_t cnt;
+            int rc;
+
+            rc = left > 0 ? poll(&pfd, 1, (int) (left * 1000) + 1) : 0;
+            if (rc > 0 && read(c->bell, &cnt, sizeof(cnt)) < 0) {
+                DEBUGMSG(DEBUG, "shm doorbell: %s\n", strerror(errno));
+            }
+            if (rc <= 0) {
+                __atomic_store_n(&r->waiting, 0, __ATOMIC_SEQ_CST);
+                return rc < 0 && errno != EINTR ? -1 : 0;
+            }
+        }
+        __atomic_store_n(&r->waiting, 0, __ATOMIC_SEQ_CST);
+    }
+}
+
+void
+ccnl_shm_disconnect(int sock, struct sockaddr_un *relay,
+                    struct ccnl_shm_client_s *c)
+{
+    ccnl_shm_send_ctrl(sock, relay, CCNL_SHM_OP_RELEASE, NULL, 0);
+    munmap(c->area, sizeof(*c->area));
+    close(c->relay_bell);
+    close(c->bell);
+    c->area = NULL;
+}
+
+#endif // USE_SHM_FACES
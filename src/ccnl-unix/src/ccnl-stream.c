@@ -0,0 +1,558 @@
+/*
+ * @f ccnl-stream.c
+ * @b CCN lite, faces over TCP and UNIX stream connections
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ *
+ * File history:
+ * 2018-10-04 created
+ */
+
+#define _GNU_SOURCE // accept4
+
+#include "ccnl-stream.h"
+
+#include "ccnl-os-includes.h"
+
+#include "ccnl-core.h"
+#include "ccnl-pkt-ccntlv.h"
+#include "ccnl-pkt-ndntlv.h"
+
+#ifdef USE_STREAM_FACES
+
+#define CCNL_STREAM_EVENTS      16 // epoll events served per call
+#define CCNL_STREAM_BACKLOG     16
+
+struct ccnl_stream_conn_s {
+    struct ccnl_stream_conn_s *next;
+    int fd;
+    int connecting;             // the non-blocking connect has not completed
+    int accepted;               // the peer connected, its faces go with it
+    sockunion peer;
+    size_t addrlen;
+    uint32_t events;            // what the epoll set watches on fd
+    size_t rlen;                // start of a packet not yet complete
+    size_t woff, wlen;          // what is left to write
+    uint8_t rbuf[CCNL_STREAM_BUFSIZE];
+    uint8_t wbuf[CCNL_STREAM_BUFSIZE];
+};
+
+struct ccnl_stream_if_s {
+    struct ccnl_relay_s *relay;
+    int ifndx;
+    int epfd;
+    int listener;
+    unsigned int seq;           // names UNIX peers which did not bind
+    int accepted;               // connections from peers, at most CCNL_STREAM_MAX_CONNS
+    struct ccnl_stream_conn_s *conns;
+};
+
+static struct ccnl_stream_if_s *streams[CCNL_MAX_INTERFACES];
+
+static size_t
+ccnl_stream_addrlen(sockunion *su)
+{
+    switch (su->sa.sa_family) {
+#ifdef USE_IPV4
+    case AF_INET:
+        return sizeof(su->ip4);
+#endif
+#ifdef USE_IPV6
+    case AF_INET6:
+        return sizeof(su->ip6);
+#endif
+#ifdef USE_UNIXSOCKET
+    case AF_UNIX:
+        return sizeof(su->ux);
+#endif
+    default:
+        return 0;
+    }
+}
+
+ssize_t
+ccnl_stream_framelen(uint8_t *data, size_t len)
+{
+    size_t skip;
+    int suite;
+
+    // the CCNx fixed header, shorter than any NDN Interest or Data
+    if (len < 8) {
+        return 0;
+    }
+    suite = ccnl_pkt2suite(data, len, &skip);
+    if (len - skip < 8) {
+        return 0;
+    }
+    data += skip;
+    len -= skip;
+    switch (suite) {
+#ifdef USE_SUITE_CCNTLV
+    case CCNL_SUITE_CCNTLV: {
+        size_t pktlen = ((size_t) data[2] << 8) | data[3];
+
+        if (pktlen < sizeof(struct ccnx_tlvhdr_ccnx2015_s)) {
+            return -1;
+        }
+        return (ssize_t) (skip + pktlen);
+    }
+#endif
+#ifdef USE_SUITE_NDNTLV
+    case CCNL_SUITE_NDNTLV: {
+        uint8_t *cp = data;
+        uint64_t typ, vallen;
+
+        if (ccnl_ndntlv_varlenint(&cp, &len, &typ) ||
+            ccnl_ndntlv_varlenint(&cp, &len, &vallen) ||
+            vallen > CCNL_STREAM_BUFSIZE) {
+            return -1;
+        }
+        return (ssize_t) (skip + (size_t) (cp - data) + vallen);
+    }
+#endif
+    default:
+        return -1; // CCNB has no length up front
+    }
+}
+
+static void
+ccnl_stream_want(struct ccnl_stream_if_s *s, struct ccnl_stream_conn_s *c,
+                 uint32_t events)
+{
+    struct epoll_event ev;
+
+    if (events == c->events) {
+        return;
+    }
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.ptr = c;
+    if (!epoll_ctl(s->epfd, EPOLL_CTL_MOD, c->fd, &ev)) {
+        c->events = events;
+    }
+}
+
+static struct ccnl_stream_conn_s*
+ccnl_stream_add(struct ccnl_stream_if_s *s, int fd, sockunion *peer,
+                uint32_t events)
+{
+    struct ccnl_stream_conn_s *c;
+    struct epoll_event ev;
+
+    c = (struct ccnl_stream_conn_s*) ccnl_calloc(1, sizeof(*c));
+    if (!c) {
+        close(fd);
+        return NULL;
+    }
+    c->fd = fd;
+    c->peer = *peer;
+    c->addrlen = ccnl_stream_addrlen(peer);
+    c->events = events;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.ptr = c;
+    if (epoll_ctl(s->epfd, EPOLL_CTL_ADD, fd, &ev)) {
+        DEBUGMSG(ERROR, "stream epoll_ctl: %s\n", strerror(errno));
+        close(fd);
+        ccnl_free(c);
+        return NULL;
+    }
+    c->next = s->conns;
+    s->conns = c;
+    return c;
+}
+
+/* closes a connection; the faces of a peer which connected go with it,
+   a face the relay was configured with connects again when used */
+static void
+ccnl_stream_close(struct ccnl_stream_if_s *s, struct ccnl_stream_conn_s *c,
+                  int remove_faces)
+{
+    struct ccnl_stream_conn_s **pp;
+
+    DEBUGMSG(INFO, "stream connection to %s closed\n",
+             ccnl_addr2ascii(&c->peer));
+    for (pp = &s->conns; *pp; pp = &(*pp)->next) {
+        if (*pp == c) {
+            *pp = c->next;
+            break;
+        }
+    }
+    // not ccnl_close_socket: a UNIX connection has the listener's name
+    close(c->fd);
+    if (c->accepted) {
+        s->accepted--;
+    }
+    if (remove_faces && c->accepted) {
+        struct ccnl_face_s *f = s->relay->faces;
+
+        while (f) {
+            if (f->ifndx == s->ifndx && !ccnl_addr_cmp(&f->peer, &c->peer)) {
+                f = ccnl_face_remove(s->relay, f);
+            } else {
+                f = f->next;
+            }
+        }
+    }
+    ccnl_free(c);
+}
+
+static void
+ccnl_stream_write(struct ccnl_stream_if_s *s, struct ccnl_stream_conn_s *c)
+{
+    while (c->woff < c->wlen) {
+        ssize_t n = send(c->fd, c->wbuf + c->woff, c->wlen - c->woff,
+                         MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                // nothing more is read from a peer which does not read
+                ccnl_stream_want(s, c, EPOLLOUT);
+                return;
+            }
+            // the read side sees the error, and closes the connection
+            DEBUGMSG(DEBUG, "stream send to %s: %s\n",
+                     ccnl_addr2ascii(&c->peer), strerror(errno));
+            shutdown(c->fd, SHUT_RDWR);
+            c->woff = c->wlen = 0;
+            break;
+        }
+        c->woff += (size_t) n;
+    }
+    c->woff = c->wlen = 0;
+    ccnl_stream_want(s, c, EPOLLIN);
+}
+
+static void
+ccnl_stream_accept(struct ccnl_stream_if_s *s)
+{
+    sockunion peer;
+    socklen_t len = sizeof(peer);
+    struct ccnl_stream_conn_s *c;
+    int fd, on = 1;
+
+    memset(&peer, 0, sizeof(peer));
+    fd = accept4(s->listener, &peer.sa, &len, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0) {
+        return;
+    }
+    if (s->accepted >= CCNL_STREAM_MAX_CONNS) {
+        // taken off the backlog, or the listener stays readable
+        DEBUGMSG(WARNING, "stream connection from %s refused, %d connected\n",
+                 ccnl_addr2ascii(&peer), s->accepted);
+        close(fd);
+        return;
+    }
+    switch (peer.sa.sa_family) {
+#ifdef USE_UNIXSOCKET
+    case AF_UNIX:
+        if (!peer.ux.sun_path[0]) {
+            // a face needs an address of its own
+            sockunion *self = &s->relay->ifs[s->ifndx].addr;
+
+            snprintf(peer.ux.sun_path, sizeof(peer.ux.sun_path), "%.*s#%u",
+                     (int) (sizeof(peer.ux.sun_path) - 12),
+                     self->ux.sun_path, ++s->seq);
+        }
+        break;
+#endif
+    default:
+        // packets are coalesced here, Nagle would only delay them
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        break;
+    }
+    c = ccnl_stream_add(s, fd, &peer, EPOLLIN);
+    if (c) {
+        c->accepted = 1;
+        s->accepted++;
+        DEBUGMSG(INFO, "stream connection from %s\n", ccnl_addr2ascii(&peer));
+    }
+}
+
+static struct ccnl_stream_conn_s*
+ccnl_stream_connect(struct ccnl_stream_if_s *s, sockunion *dest)
+{
+    size_t addrlen = ccnl_stream_addrlen(dest);
+    struct ccnl_stream_conn_s *c;
+    int fd, on = 1;
+
+    if (!addrlen) {
+        return NULL;
+    }
+    fd = socket(dest->sa.sa_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                0);
+    if (fd < 0) {
+        return NULL;
+    }
+    if (dest->sa.sa_family != AF_UNIX) {
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    }
+    if (connect(fd, &dest->sa, (socklen_t) addrlen) && errno != EINPROGRESS) {
+        DEBUGMSG(WARNING, "could not connect to %s: %s\n",
+                 ccnl_addr2ascii(dest), strerror(errno));
+        close(fd);
+        return NULL;
+    }
+    c = ccnl_stream_add(s, fd, dest, EPOLLIN | EPOLLOUT);
+    if (c) {
+        c->connecting = 1;
+        DEBUGMSG(INFO, "stream connection to %s\n", ccnl_addr2ascii(dest));
+    }
+    return c;
+}
+
+/* hands the complete packets read from a connection to the relay, as long
+   as the answers to the peer can be written; the rest is served once the
+   writes have drained. Returns -1 if the connection was closed */
+static int
+ccnl_stream_parse(struct ccnl_stream_if_s *s, struct ccnl_stream_conn_s *c,
+                  ccnl_stream_deliver_func deliver)
+{
+    size_t off = 0;
+
+    while (off < c->rlen) {
+        ssize_t len;
+
+        if (sizeof(c->wbuf) - (c->wlen - c->woff) < CCNL_MAX_PACKET_SIZE &&
+            !(c->events & EPOLLOUT)) {
+            ccnl_stream_write(s, c);
+        }
+        if (c->events & EPOLLOUT) {
+            break;
+        }
+        len = ccnl_stream_framelen(c->rbuf + off, c->rlen - off);
+        if (len < 0 || (size_t) len > sizeof(c->rbuf)) {
+            DEBUGMSG(WARNING, "stream from %s cannot be framed\n",
+                     ccnl_addr2ascii(&c->peer));
+            ccnl_stream_close(s, c, 1);
+            return -1;
+        }
+        if (!len || (size_t) len > c->rlen - off) {
+            break;
+        }
+        deliver(s->relay, s->ifndx, c->rbuf + off, (size_t) len,
+                &c->peer, c->addrlen);
+        off += (size_t) len;
+    }
+    if (off > 0) {
+        memmove(c->rbuf, c->rbuf + off, c->rlen - off);
+        c->rlen -= off;
+    }
+    return 0;
+}
+
+/* reads what the kernel has, see ccnl_stream_parse */
+static int
+ccnl_stream_read(struct ccnl_stream_if_s *s, struct ccnl_stream_conn_s *c,
+                 ccnl_stream_deliver_func deliver)
+{
+    ssize_t n;
+
+    if (c->rlen < sizeof(c->rbuf)) {
+        n = recv(c->fd, c->rbuf + c->rlen, sizeof(c->rbuf) - c->rlen,
+                 MSG_DONTWAIT);
+        if (n == 0 || (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK &&
+                                errno != EINTR)) {
+            ccnl_stream_close(s, c, 1);
+            return -1;
+        }
+        if (n > 0) {
+            c->rlen += (size_t) n;
+        }
+    }
+    return ccnl_stream_parse(s, c, deliver);
+}
+
+int
+ccnl_stream_listen(struct ccnl_relay_s *relay, int ifndx, sockunion *addr)
+{
+    struct ccnl_stream_if_s *s;
+    socklen_t len = (socklen_t) ccnl_stream_addrlen(addr);
+    int on = 1;
+    struct epoll_event ev;
+
+    if (!len || ifndx < 0 || ifndx >= CCNL_MAX_INTERFACES || streams[ifndx]) {
+        return -1;
+    }
+    s = (struct ccnl_stream_if_s*) ccnl_calloc(1, sizeof(*s));
+    if (!s) {
+        return -1;
+    }
+    s->relay = relay;
+    s->ifndx = ifndx;
+    s->epfd = epoll_create1(EPOLL_CLOEXEC);
+    s->listener = socket(addr->sa.sa_family,
+                         SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (s->epfd < 0 || s->listener < 0) {
+        perror("stream socket");
+        goto Fail;
+    }
+    if (addr->sa.sa_family == AF_UNIX) {
+        unlink(addr->ux.sun_path);
+    } else {
+        setsockopt(s->listener, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    }
+    if (bind(s->listener, &addr->sa, len) ||
+        listen(s->listener, CCNL_STREAM_BACKLOG) ||
+        getsockname(s->listener, &addr->sa, &len)) {
+        perror("stream bind/listen");
+        goto Fail;
+    }
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.ptr = NULL; // the listener
+    if (epoll_ctl(s->epfd, EPOLL_CTL_ADD, s->listener, &ev)) {
+        goto Fail;
+    }
+    streams[ifndx] = s;
+    return s->epfd;
+
+Fail:
+    if (s->listener >= 0) {
+        ccnl_close_socket(s->listener);
+    }
+    if (s->epfd >= 0) {
+        close(s->epfd);
+    }
+    ccnl_free(s);
+    return -1;
+}
+
+void
+ccnl_stream_rx(struct ccnl_relay_s *relay, int ifndx,
+               ccnl_stream_deliver_func deliver)
+{
+    struct ccnl_stream_if_s *s = streams[ifndx];
+    struct epoll_event evs[CCNL_STREAM_EVENTS];
+    int k, n;
+
+    (void) relay;
+    if (!s) {
+        return;
+    }
+    n = epoll_wait(s->epfd, evs, CCNL_STREAM_EVENTS, 0);
+    for (k = 0; k < n; k++) {
+        struct ccnl_stream_conn_s *c = evs[k].data.ptr;
+        uint32_t ev = evs[k].events;
+
+        if (!c) {
+            ccnl_stream_accept(s);
+            continue;
+        }
+        if (c->connecting && (ev & (EPOLLOUT | EPOLLERR | EPOLLHUP))) {
+            int err = 0;
+            socklen_t len = sizeof(err);
+
+            if (getsockopt(c->fd, SOL_SOCKET, SO_ERROR, &err, &len) || err) {
+                DEBUGMSG(WARNING, "could not connect to %s: %s\n",
+                         ccnl_addr2ascii(&c->peer), strerror(err));
+                ccnl_stream_close(s, c, 1);
+                continue;
+            }
+            c->connecting = 0;
+        }
+        if (ev & EPOLLOUT) {
+            ccnl_stream_write(s, c);
+        }
+        if (ev & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+            ccnl_stream_read(s, c, deliver);
+        } else if (c->rlen > 0) {
+            ccnl_stream_parse(s, c, deliver); // the writes have drained
+        }
+    }
+}
+
+ssize_t
+ccnl_stream_send(int ifndx, sockunion *dest, uint8_t *data, size_t len)
+{
+    struct ccnl_stream_if_s *s;
+    struct ccnl_stream_conn_s *c;
+
+    if (ifndx < 0 || ifndx >= CCNL_MAX_INTERFACES || !streams[ifndx]) {
+        return -1;
+    }
+    s = streams[ifndx];
+    for (c = s->conns; c; c = c->next) {
+        if (!ccnl_addr_cmp(&c->peer, dest)) {
+            break;
+        }
+    }
+    if (!c && !(c = ccnl_stream_connect(s, dest))) {
+        return -1;
+    }
+    if (c->wlen + len > sizeof(c->wbuf)) {
+        // a full buffer leaves before the flush, as far as the kernel takes it
+        if (!c->connecting && !(c->events & EPOLLOUT)) {
+            ccnl_stream_write(s, c);
+        }
+        if (c->woff > 0) {
+            memmove(c->wbuf, c->wbuf + c->woff, c->wlen - c->woff);
+            c->wlen -= c->woff;
+            c->woff = 0;
+        }
+    }
+    if (c->wlen + len > sizeof(c->wbuf)) {
+        DEBUGMSG(DEBUG, "stream to %s is backed up, packet dropped\n",
+                 ccnl_addr2ascii(dest));
+        return -1;
+    }
+    memcpy(c->wbuf + c->wlen, data, len);
+    c->wlen += len;
+    return (ssize_t) len;
+}
+
+void
+ccnl_stream_flush(void)
+{
+    struct ccnl_stream_conn_s *c;
+    int i;
+
+    for (i = 0; i < CCNL_MAX_INTERFACES; i++) {
+        if (!streams[i]) {
+            continue;
+        }
+        for (c = streams[i]->conns; c; c = c->next) {
+            // a connection waiting for EPOLLOUT is written to from rx
+            if (c->wlen > c->woff && !c->connecting &&
+                !(c->events & EPOLLOUT)) {
+                ccnl_stream_write(streams[i], c);
+            }
+        }
+    }
+}
+
+void
+ccnl_stream_cleanup(void)
+{
+    int i;
+
+    for (i = 0; i < CCNL_MAX_INTERFACES; i++) {
+        struct ccnl_stream_if_s *s = streams[i];
+
+        if (!s) {
+            continue;
+        }
+        while (s->conns) {
+            ccnl_stream_close(s, s->conns, 0);
+        }
+        ccnl_close_socket(s->listener);
+        ccnl_free(s);
+        streams[i] = NULL;
+    }
+}
+
+#endif // USE_STREAM_FACES
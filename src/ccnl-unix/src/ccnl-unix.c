@@ -20,6 +20,8 @@
  * 2017-06-16 created
  */
 
+#define _GNU_SOURCE // recvmmsg, sendmmsg
+
 #include "ccnl-unix.h"
 
 #include "ccnl-os-includes.h"
@@ -32,9 +34,13 @@
 #include "ccnl-pkt-ndntlv.h"
 #include "ccnl-pkt-switch.h"
 #include "ccnl-dispatch.h"
+#include "ccnl-app.h"
 #ifdef USE_HTTP_STATUS
 #include "ccnl-http-status.h"
 #endif
+#include "ccnl-shard.h"
+#include "ccnl-shm.h"
+#include "ccnl-stream.h"
 
 /**
  * TODO: The variables are never updated within the context of
@@ -46,6 +52,86 @@ static int inter_ccn_interval = 0; // in usec
 static int inter_pkt_interval = 0; // in usec
 #endif 
 
+#ifdef USE_UDP_GSO
+#define CCNL_UDP_GSO            0x01 // datagrams to one peer may leave together
+#define CCNL_UDP_GRO            0x02 // a read may return several datagrams
+#define CCNL_UDP_GSO_SEGS       64   // the kernel's limit of datagrams per send
+#define CCNL_UDP_GSO_BYTES      65507
+#define CCNL_UDP_GRO_BUFSIZE    65536
+
+// room for the UDP_SEGMENT or UDP_GRO control message of one datagram
+union ccnl_udpctrl_u {
+    char buf[CMSG_SPACE(sizeof(int))];
+    size_t align; // that of struct cmsghdr
+};
+
+static int use_udp_offload = 0;
+static uint8_t udp_offload[CCNL_MAX_INTERFACES];
+static size_t udp_gso_maxseg[CCNL_MAX_INTERFACES]; // largest datagram to join
+#endif
+
+// receive buffers for the datagrams read from one interface per wakeup; a
+// datagram that is a packet of its own keeps its buffer, the slot is then
+// refilled from the pool
+struct ccnl_rxring_s {
+    int size;
+    struct ccnl_bufpool_s *pool;
+    struct ccnl_buf_s **bufs;
+    sockunion *addrs;
+#ifdef USE_MMSG
+    struct iovec *iovs;
+    struct mmsghdr *msgs;
+#endif
+#ifdef USE_UDP_GSO
+    union ccnl_udpctrl_u *ctrls;
+#endif
+};
+
+// the mechanisms the IO loop can wait with, each falls back to the next
+#define CCNL_IO_URING           0
+#define CCNL_IO_EPOLL           1
+#define CCNL_IO_SELECT          2
+
+static int io_backend = CCNL_IO_EPOLL;
+static int rx_batch = CCNL_RX_BATCH;
+static struct ccnl_rxring_s rxring;
+#ifdef USE_SHARDS
+static int shard_count = 0;
+static int shard_comps = CCNL_SHARD_COMPS;
+#endif
+#ifdef USE_SHM_FACES
+static int shm_bell = -1;       // rung by applications with shm channels
+#endif
+
+// the pools outlive the IO loop, the relay may still hold their buffers
+static struct ccnl_bufpool_s rxpool = { NULL, CCNL_MAX_PACKET_SIZE, 0, 0, 0, NULL };
+#ifdef USE_UDP_GSO
+static struct ccnl_bufpool_s rxpool_gro = { NULL, CCNL_UDP_GRO_BUFSIZE, 0, 0, 0, NULL };
+#endif
+
+#ifdef USE_TPACKET
+#define CCNL_PRING_BLOCKSIZE    (1 << 16) // a multiple of the page size
+#define CCNL_PRING_FRAMESIZE    2048      // a full Ethernet frame, with header
+#define CCNL_PRING_RX_BLOCKS    32
+#define CCNL_PRING_TX_BLOCKS    8
+#define CCNL_PRING_TX_FRAMES    (CCNL_PRING_TX_BLOCKS * \
+                                 (CCNL_PRING_BLOCKSIZE / CCNL_PRING_FRAMESIZE))
+#define CCNL_PRING_RETIRE_MS    1 // a partly filled block is handed over after
+
+// the mmap'ed receive and transmit rings of an AF_PACKET socket
+struct ccnl_pring_s {
+    int sock;
+    uint8_t *map;          // the RX ring, followed by the TX ring
+    size_t map_size;
+    unsigned rx_block;     // next block the kernel hands over
+    unsigned tx_frame;     // next slot to write a frame into
+    int tx_pending;        // frames written since the kernel was last kicked
+};
+
+static int use_prings = 0;
+static struct ccnl_pring_s *prings[CCNL_MAX_INTERFACES];
+#endif
+
 #ifdef USE_LINKLAYER
 int
 ccnl_open_ethdev(char *devname, struct sockaddr_ll *sll, uint16_t ethtype)
@@ -241,6 +327,132 @@ ccnl_eth_sendto(int sock, uint8_t *dst, uint8_t *src,
 
     return sendto(sock, buf, hdrlen + datalen, 0, 0, 0);
 }
+
+#ifdef USE_TPACKET
+static void
+ccnl_pring_free(struct ccnl_pring_s *r)
+{
+    struct tpacket_req3 req;
+    int version = TPACKET_V1;
+
+    if (r->map) {
+        munmap(r->map, r->map_size);
+    }
+    // an empty request releases a ring, the socket is then a plain one again
+    memset(&req, 0, sizeof(req));
+    setsockopt(r->sock, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req));
+    setsockopt(r->sock, SOL_PACKET, PACKET_TX_RING, &req, sizeof(req));
+    setsockopt(r->sock, SOL_PACKET, PACKET_VERSION, &version, sizeof(version));
+    ccnl_free(r);
+}
+
+/* switches an AF_PACKET socket to TPACKET_V3 and maps its rings; returns
+   NULL, with the socket left as it was, if the kernel does not support it */
+static struct ccnl_pring_s*
+ccnl_pring_new(int sock)
+{
+    struct ccnl_pring_s *r;
+    struct tpacket_req3 req;
+    int version = TPACKET_V3;
+    void *m;
+
+    r = (struct ccnl_pring_s *) ccnl_calloc(1, sizeof(*r));
+    if (!r) {
+        return NULL;
+    }
+    r->sock = sock;
+    if (setsockopt(sock, SOL_PACKET, PACKET_VERSION,
+                   &version, sizeof(version)) < 0) {
+        goto Fail;
+    }
+    memset(&req, 0, sizeof(req));
+    req.tp_block_size = CCNL_PRING_BLOCKSIZE;
+    req.tp_frame_size = CCNL_PRING_FRAMESIZE;
+    req.tp_block_nr = CCNL_PRING_RX_BLOCKS;
+    req.tp_frame_nr = CCNL_PRING_RX_BLOCKS *
+                      (CCNL_PRING_BLOCKSIZE / CCNL_PRING_FRAMESIZE);
+    req.tp_retire_blk_tov = CCNL_PRING_RETIRE_MS;
+    if (setsockopt(sock, SOL_PACKET, PACKET_RX_RING, &req, sizeof(req)) < 0) {
+        goto Fail;
+    }
+    req.tp_block_nr = CCNL_PRING_TX_BLOCKS;
+    req.tp_frame_nr = CCNL_PRING_TX_FRAMES;
+    req.tp_retire_blk_tov = 0; // must be 0 for a TX ring
+    if (setsockopt(sock, SOL_PACKET, PACKET_TX_RING, &req, sizeof(req)) < 0) {
+        goto Fail;
+    }
+    r->map_size = (size_t) (CCNL_PRING_RX_BLOCKS + CCNL_PRING_TX_BLOCKS) *
+                  CCNL_PRING_BLOCKSIZE;
+    m = mmap(NULL, r->map_size, PROT_READ | PROT_WRITE, MAP_SHARED, sock, 0);
+    if (m == MAP_FAILED) {
+        goto Fail;
+    }
+    r->map = (uint8_t *) m;
+    return r;
+
+Fail:
+    ccnl_pring_free(r);
+    return NULL;
+}
+
+/* lets the kernel send the frames written into the TX ring so far */
+static void
+ccnl_pring_kick(struct ccnl_pring_s *r)
+{
+    if (send(r->sock, NULL, 0, MSG_DONTWAIT) < 0 &&
+                                errno != EAGAIN && errno != EWOULDBLOCK) {
+        DEBUGMSG(DEBUG, "packet ring kick failed: %s\n", strerror(errno));
+    }
+    r->tx_pending = 0;
+}
+
+/* the TX ring flavour of ccnl_eth_sendto: the frame is built in the next
+   free slot, it leaves with the next \ref ccnl_pring_kick */
+static ssize_t
+ccnl_pring_sendto(struct ccnl_pring_s *r, uint8_t *dst, uint8_t *src,
+                  uint8_t *data, size_t datalen)
+{
+    uint8_t *slot = r->map + (size_t) CCNL_PRING_RX_BLOCKS *
+                             CCNL_PRING_BLOCKSIZE +
+                             (size_t) r->tx_frame * CCNL_PRING_FRAMESIZE;
+    struct tpacket3_hdr *h = (struct tpacket3_hdr *) slot;
+    uint8_t *frame = slot + TPACKET_ALIGN(sizeof(*h));
+    uint16_t type = htons(CCNL_ETH_TYPE);
+    size_t hdrlen = 14;
+
+    if (__atomic_load_n(&h->tp_status, __ATOMIC_ACQUIRE) &
+                        (TP_STATUS_SEND_REQUEST | TP_STATUS_SENDING)) {
+        ccnl_pring_kick(r); // the ring is full: make room
+        if (__atomic_load_n(&h->tp_status, __ATOMIC_ACQUIRE) &
+                            (TP_STATUS_SEND_REQUEST | TP_STATUS_SENDING)) {
+            return -1;
+        }
+    }
+    if (datalen + hdrlen > CCNL_PRING_FRAMESIZE - TPACKET_ALIGN(sizeof(*h))) {
+        datalen = CCNL_PRING_FRAMESIZE - TPACKET_ALIGN(sizeof(*h)) - hdrlen;
+    }
+    memcpy(frame, dst, 6);
+    memcpy(frame+6, src, 6);
+    memcpy(frame+12, &type, sizeof(type));
+    memcpy(frame+hdrlen, data, datalen);
+    h->tp_len = (uint32_t) (hdrlen + datalen);
+    h->tp_next_offset = 0;
+    __atomic_store_n(&h->tp_status, TP_STATUS_SEND_REQUEST, __ATOMIC_RELEASE);
+
+    r->tx_frame = (r->tx_frame + 1) % CCNL_PRING_TX_FRAMES;
+    r->tx_pending++;
+    return (ssize_t) (hdrlen + datalen);
+}
+
+static struct ccnl_pring_s*
+ccnl_pring_of(struct ccnl_relay_s *ccnl, struct ccnl_if_s *ifc)
+{
+    if (ifc < ccnl->ifs || ifc >= ccnl->ifs + CCNL_MAX_INTERFACES) {
+        return NULL;
+    }
+    return prings[ifc - ccnl->ifs];
+}
+#endif // USE_TPACKET
 #endif // USE_LINKLAYER
 
 
@@ -284,10 +496,94 @@ void ccnl_ageing(void *relay, void *aux)
     }
 
     ccnl_do_ageing(relay, aux);
+#ifdef USE_SHARDS
+    ccnl_shard_sync(relay);
+#endif
+#ifdef USE_SHM_FACES
+    ccnl_shm_ageing();
+#endif
     ccnl_set_timer(1000000, ccnl_ageing, relay, 0);
 }
 
 #if defined(USE_IPV4) || defined(USE_IPV6)
+#ifdef USE_UDP_GSO
+/* the largest UDP payload which fits into one IP packet on the links sock
+   may send on: those of its address, or all links if it is bound to any */
+static size_t
+ccnl_udp_gso_mtu(int sock, sockunion *addr)
+{
+    struct ifaddrs *ifas, *a;
+    struct ifreq ifr;
+    size_t hdrlen = 20 + 8, mtu = 0;
+    int any = 1;
+
+#ifdef USE_IPV4
+    if (addr->sa.sa_family == AF_INET) {
+        any = addr->ip4.sin_addr.s_addr == htonl(INADDR_ANY);
+    }
+#endif
+#ifdef USE_IPV6
+    if (addr->sa.sa_family == AF_INET6) {
+        hdrlen = 40 + 8;
+        any = IN6_IS_ADDR_UNSPECIFIED(&addr->ip6.sin6_addr);
+    }
+#endif
+    if (getifaddrs(&ifas)) {
+        return 0;
+    }
+    for (a = ifas; a; a = a->ifa_next) {
+        if (!a->ifa_addr || a->ifa_addr->sa_family != addr->sa.sa_family ||
+            !(a->ifa_flags & IFF_UP)) {
+            continue;
+        }
+#ifdef USE_IPV4
+        if (!any && addr->sa.sa_family == AF_INET &&
+            ((struct sockaddr_in*) a->ifa_addr)->sin_addr.s_addr !=
+                                            addr->ip4.sin_addr.s_addr) {
+            continue;
+        }
+#endif
+#ifdef USE_IPV6
+        if (!any && addr->sa.sa_family == AF_INET6 &&
+            memcmp(&((struct sockaddr_in6*) a->ifa_addr)->sin6_addr,
+                   &addr->ip6.sin6_addr, sizeof(struct in6_addr))) {
+            continue;
+        }
+#endif
+        memset(&ifr, 0, sizeof(ifr));
+        strncpy(ifr.ifr_name, a->ifa_name, IFNAMSIZ - 1);
+        if (!ioctl(sock, SIOCGIFMTU, &ifr) && ifr.ifr_mtu > (int) hdrlen &&
+            (!mtu || (size_t) ifr.ifr_mtu - hdrlen < mtu)) {
+            mtu = (size_t) ifr.ifr_mtu - hdrlen;
+        }
+    }
+    freeifaddrs(ifas);
+    return mtu;
+}
+
+/* turns on segmentation offload for the UDP socket of interface i, as far
+   as the kernel supports it */
+static void
+ccnl_udp_offload_setup(int i, int sock, sockunion *addr)
+{
+    int on = 1, size = 0;
+
+    udp_offload[i] = 0;
+    // each segment leaves as an IP packet of its own, unfragmented
+    udp_gso_maxseg[i] = ccnl_udp_gso_mtu(sock, addr);
+    if (udp_gso_maxseg[i] &&
+        !setsockopt(sock, IPPROTO_UDP, UDP_SEGMENT, &size, sizeof(size))) {
+        udp_offload[i] |= CCNL_UDP_GSO;
+    }
+    if (!setsockopt(sock, IPPROTO_UDP, UDP_GRO, &on, sizeof(on))) {
+        udp_offload[i] |= CCNL_UDP_GRO;
+    }
+    DEBUGMSG(INFO, "  UDP segmentation offload:%s%s (segments up to %zu)\n",
+             udp_offload[i] & CCNL_UDP_GSO ? " gso" : "",
+             udp_offload[i] & CCNL_UDP_GRO ? " gro" : "", udp_gso_maxseg[i]);
+}
+#endif
+
 void
 ccnl_relay_udp(struct ccnl_relay_s *relay, int32_t sport, int af, int suite)
 {
@@ -336,6 +632,12 @@ ccnl_relay_udp(struct ccnl_relay_s *relay, int32_t sport, int af, int suite)
     }
 #endif
     i->fwdalli = 1;
+#ifdef USE_UDP_GSO
+    udp_offload[relay->ifcount] = 0;
+    if (use_udp_offload) {
+        ccnl_udp_offload_setup(relay->ifcount, i->sock, &i->addr);
+    }
+#endif
     relay->ifcount++;
     DEBUGMSG(INFO, "UDP interface (%s) configured\n",
              ccnl_addr2ascii(&i->addr));
@@ -345,12 +647,92 @@ ccnl_relay_udp(struct ccnl_relay_s *relay, int32_t sport, int af, int suite)
 }
 #endif
 
+#ifdef USE_STREAM_FACES
+/* adds a stream interface listening at addr, if it can be opened */
+static void
+ccnl_relay_stream_if(struct ccnl_relay_s *relay, sockunion *addr)
+{
+    struct ccnl_if_s *i;
+
+    if (relay->ifcount >= CCNL_MAX_INTERFACES) {
+        DEBUGMSG(WARNING, "too many interfaces, no stream interface\n");
+        return;
+    }
+    i = &relay->ifs[relay->ifcount];
+    i->sock = ccnl_stream_listen(relay, relay->ifcount, addr);
+    if (i->sock < 0) {
+        DEBUGMSG(WARNING, "sorry, could not open stream interface (%s)\n",
+                 ccnl_addr2ascii(addr));
+        return;
+    }
+    i->addr = *addr;
+    i->stream = 1;
+    i->fwdalli = 1;
+    relay->ifcount++;
+    DEBUGMSG(INFO, "stream interface (%s) configured\n",
+             ccnl_addr2ascii(&i->addr));
+    if (relay->defaultInterfaceScheduler)
+        i->sched = relay->defaultInterfaceScheduler(relay,
+                                                        ccnl_interface_CTS);
+}
+#endif
+
+void
+ccnl_relay_stream(struct ccnl_relay_s *relay, int32_t tcpport, char *uxpath)
+{
+#ifdef USE_STREAM_FACES
+    sockunion su;
+
+    (void) su;
+    (void) tcpport;
+    (void) uxpath;
+#ifdef USE_IPV4
+    if (tcpport >= 0 && tcpport <= UINT16_MAX) {
+        memset(&su, 0, sizeof(su));
+        su.ip4.sin_family = AF_INET;
+        su.ip4.sin_addr.s_addr = INADDR_ANY;
+        su.ip4.sin_port = htons((uint16_t) tcpport);
+        ccnl_relay_stream_if(relay, &su);
+    }
+#endif
+#ifdef USE_UNIXSOCKET
+    if (uxpath) {
+        memset(&su, 0, sizeof(su));
+        su.ux.sun_family = AF_UNIX;
+        if (strlen(uxpath) >= sizeof(su.ux.sun_path)) {
+            DEBUGMSG(WARNING, "stream socket path too long: %s\n", uxpath);
+            return;
+        }
+        strcpy(su.ux.sun_path, uxpath);
+        ccnl_relay_stream_if(relay, &su);
+    }
+#endif
+#else
+    (void) relay;
+    if (tcpport >= 0 || uxpath) {
+        DEBUGMSG(WARNING, "stream faces are not compiled in\n");
+    }
+#endif
+}
+
 void
 ccnl_ll_TX(struct ccnl_relay_s *ccnl, struct ccnl_if_s *ifc,
            sockunion *dest, struct ccnl_buf_s *buf)
 {
     ssize_t rc = -1;
     (void) ccnl;
+#ifdef USE_STREAM_FACES
+    if (ifc->stream) {
+        rc = ccnl_stream_send((int) (ifc - ccnl->ifs), dest,
+                              buf->data, buf->datalen);
+        DEBUGMSG(DEBUG, "stream to %s returned %zd\n",
+                 ccnl_addr2ascii(dest), rc);
+        if (!ccnl->tx_deferred) {
+            ccnl_stream_flush();
+        }
+        return;
+    }
+#endif
     switch(dest->sa.sa_family) {
 #ifdef USE_IPV4
     case AF_INET:
@@ -388,6 +770,18 @@ ccnl_ll_TX(struct ccnl_relay_s *ccnl, struct ccnl_if_s *ifc,
 #endif
 #ifdef USE_LINKLAYER
     case AF_PACKET:
+#ifdef USE_TPACKET
+        if (ccnl_pring_of(ccnl, ifc)) {
+            struct ccnl_pring_s *r = ccnl_pring_of(ccnl, ifc);
+
+            rc = ccnl_pring_sendto(r, dest->linklayer.sll_addr,
+                                   ifc->addr.linklayer.sll_addr,
+                                   buf->data, buf->datalen);
+            if (!ccnl->tx_deferred) {
+                ccnl_pring_kick(r);
+            }
+        } else
+#endif
         rc = ccnl_eth_sendto(ifc->sock,
                              dest->linklayer.sll_addr,
                              ifc->addr.linklayer.sll_addr,
@@ -403,6 +797,14 @@ ccnl_ll_TX(struct ccnl_relay_s *ccnl, struct ccnl_if_s *ifc,
 #endif
 #ifdef USE_UNIXSOCKET
     case AF_UNIX:
+#ifdef USE_SHM_FACES
+        if (ccnl_shm_of(dest)) {
+            rc = ccnl_shm_send(ccnl_shm_of(dest), buf->data, buf->datalen);
+            DEBUGMSG(DEBUG, "unix shm to %s returned %zd\n",
+                     dest->ux.sun_path, rc);
+            break;
+        }
+#endif
         rc = sendto(ifc->sock,
                     buf->data, buf->datalen, 0,
                     (struct sockaddr*) &dest->ux, sizeof(struct sockaddr_un));
@@ -559,156 +961,1653 @@ ccnl_relay_config(struct ccnl_relay_s *relay, char *ethdev, char *wpandev,
     ccnl_set_timer(1000000, ccnl_ageing, relay, 0);
 }
 
-int
-ccnl_io_loop(struct ccnl_relay_s *ccnl)
+/* hands a received packet, with the sender's address already checked, to
+   the forwarding threads or to the relay; see ccnl_io_dispatch for rxbuf */
+static void
+ccnl_io_deliver(struct ccnl_relay_s *ccnl, int i, unsigned char *buf,
+                size_t len, sockunion *src_addr, size_t addrlen,
+                struct ccnl_buf_s **rxbuf)
 {
-    int i, maxfd = -1, rc;
-    size_t len;
-    fd_set readfs, writefs;
-    unsigned char buf[CCNL_MAX_PACKET_SIZE];
+    struct ccnl_buf_s *fresh;
 
-    if (ccnl->ifcount == 0) {
-        DEBUGMSG(ERROR, "no socket to work with, not good, quitting\n");
-        exit(EXIT_FAILURE);
+    fresh = NULL;
+    if (rxbuf && *rxbuf && (*rxbuf)->pool && buf == (*rxbuf)->data) {
+        fresh = ccnl_bufpool_get((*rxbuf)->pool);
     }
-    for (i = 0; i < ccnl->ifcount; i++) {
-        if (ccnl->ifs[i].sock > maxfd) {
-            maxfd = ccnl->ifs[i].sock;
-        }
+#ifdef USE_SHARDS
+    // a forwarding thread may take the receive buffer along
+    if (fresh) {
+        (*rxbuf)->datalen = len;
+        ccnl_buf_offer(*rxbuf);
     }
-    maxfd++;
-
-    DEBUGMSG(INFO, "starting main event and IO loop\n");
-    while (!ccnl->halt_flag) {
-        int usec;
-
-        FD_ZERO(&readfs);
-        FD_ZERO(&writefs);
-
-#ifdef USE_HTTP_STATUS
-        ccnl_http_anteselect(ccnl, ccnl->http, &readfs, &writefs, &maxfd);
-#endif
-        for (i = 0; i < ccnl->ifcount; i++) {
-            FD_SET(ccnl->ifs[i].sock, &readfs);
-            if (ccnl->ifs[i].qlen > 0) {
-                FD_SET(ccnl->ifs[i].sock, &writefs);
-            }
-        }
-
-        usec = ccnl_run_events();
-        if (usec >= 0) {
-            struct timeval deadline;
-            deadline.tv_sec = usec / 1000000;
-            deadline.tv_usec = usec % 1000000;
-            rc = select(maxfd, &readfs, &writefs, NULL, &deadline);
+    if (!ccnl_shard_dispatch(i, buf, len, src_addr, addrlen)) {
+        if (fresh && !ccnl_buf_offer(NULL)) {
+            *rxbuf = fresh;
         } else {
-            rc = select(maxfd, &readfs, &writefs, NULL, NULL);
+            ccnl_buf_free(fresh);
         }
+        return;
+    }
+    ccnl_buf_offer(NULL);
+#endif
+    if (fresh) {
+        struct ccnl_buf_s *b = *rxbuf;
+
+        *rxbuf = fresh;
+        b->datalen = len;
+        ccnl_core_RX_buf(ccnl, i, b, &src_addr->sa, addrlen);
+    } else {
+        ccnl_core_RX(ccnl, i, buf, len, &src_addr->sa, addrlen);
+    }
+#ifdef USE_SHARDS
+    ccnl_shard_sync(ccnl); // management requests may have changed the FIB
+#endif
+}
 
-        if (rc < 0) {
-            perror("select(): ");
-            exit(EXIT_FAILURE);
-        }
+/* hands a datagram received on interface i to the relay; if it fills the
+   receive buffer *rxbuf, the relay is handed the buffer itself and *rxbuf
+   is refilled from the pool */
+static void
+ccnl_io_dispatch(struct ccnl_relay_s *ccnl, int i, unsigned char *buf,
+                 size_t len, sockunion *src_addr, struct ccnl_buf_s **rxbuf)
+{
+    size_t addrlen;
 
-#ifdef USE_HTTP_STATUS
-        ccnl_http_postselect(ccnl, ccnl->http, &readfs, &writefs);
-#endif
-        for (i = 0; i < ccnl->ifcount; i++) {
-            if (FD_ISSET(ccnl->ifs[i].sock, &readfs)) {
-                sockunion src_addr;
-                socklen_t addrlen = sizeof(sockunion);
-                ssize_t recvlen;
-                if ((recvlen = recvfrom(ccnl->ifs[i].sock, buf, sizeof(buf), 0,
-                                (struct sockaddr*) &src_addr, &addrlen)) > 0) {
-                    len = (size_t) recvlen;
-                    if (0) {}
+    if (0) {}
 #ifdef USE_IPV4
-                    else if (src_addr.sa.sa_family == AF_INET) {
-                        ccnl_core_RX(ccnl, i, buf, len,
-                                     &src_addr.sa, sizeof(src_addr.ip4));
-                    }
+    else if (src_addr->sa.sa_family == AF_INET) {
+        addrlen = sizeof(src_addr->ip4);
+    }
 #endif
 #ifdef USE_IPV6
-                    else if (src_addr.sa.sa_family == AF_INET6) {
-                        ccnl_core_RX(ccnl, i, buf, len,
-                                     &src_addr.sa, sizeof(src_addr.ip6));
-                    }
+    else if (src_addr->sa.sa_family == AF_INET6) {
+        addrlen = sizeof(src_addr->ip6);
+    }
 #endif
 #ifdef USE_LINKLAYER
-                    else if (src_addr.sa.sa_family == AF_PACKET) {
-                        if (len > 14) {
-                            ccnl_core_RX(ccnl, i, buf + 14, len - 14,
-                                         &src_addr.sa, sizeof(src_addr.linklayer));
-                        }
-                    }
+    else if (src_addr->sa.sa_family == AF_PACKET) {
+        if (len <= 14) {
+            return;
+        }
+        buf += 14;
+        len -= 14;
+        addrlen = sizeof(src_addr->linklayer);
+    }
 #endif
 #ifdef USE_WPAN
-                    else if (src_addr.sa.sa_family == AF_IEEE802154) {
-                        if (len > 14) {
-                            ccnl_core_RX(ccnl, i, buf, len,
-                                         &src_addr.sa, sizeof(src_addr.linklayer));
-                        }
-                    }
+    else if (src_addr->sa.sa_family == AF_IEEE802154) {
+        if (len <= 14) {
+            return;
+        }
+        addrlen = sizeof(src_addr->linklayer);
+    }
 #endif
 #ifdef USE_UNIXSOCKET
-                    else if (src_addr.sa.sa_family == AF_UNIX) {
-                        ccnl_core_RX(ccnl, i, buf, len,
-                                     &src_addr.sa, sizeof(src_addr.ux));
-                    }
+    else if (src_addr->sa.sa_family == AF_UNIX) {
+#ifdef USE_SHM_FACES
+        if (!ccnl_shm_control(ccnl, i, buf, len, src_addr)) {
+            return;
+        }
 #endif
-                }
-            }
+        addrlen = sizeof(src_addr->ux);
+    }
+#endif
+    else {
+        return;
+    }
 
-            if (FD_ISSET(ccnl->ifs[i].sock, &writefs)) {
-              ccnl_interface_CTS(ccnl, ccnl->ifs + i);
-            }
+    ccnl_io_deliver(ccnl, i, buf, len, src_addr, addrlen, rxbuf);
+}
+
+#if defined(USE_STREAM_FACES) || defined(USE_SHM_FACES) || defined(USE_TPACKET)
+static void
+ccnl_io_flush(struct ccnl_relay_s *ccnl);
+
+/* a read or a ring holds many more packets than a batch of datagrams: what
+   they caused is sent before an interface queue overflows */
+static void
+ccnl_io_flush_filling(struct ccnl_relay_s *ccnl)
+{
+    int k;
+
+    for (k = 0; k < ccnl->ifcount; k++) {
+        if (ccnl->ifs[k].qlen >= CCNL_MAX_IF_QLEN / 2) {
+            ccnl_io_flush(ccnl);
+            break;
         }
     }
+}
+#endif
 
-    return 0;
+#ifdef USE_STREAM_FACES
+static void
+ccnl_io_stream_deliver(struct ccnl_relay_s *ccnl, int i, uint8_t *data,
+                       size_t len, sockunion *src, size_t addrlen)
+{
+    ccnl_io_deliver(ccnl, i, data, len, src, addrlen, NULL);
+    ccnl_io_flush_filling(ccnl);
 }
+#endif
 
-void
-ccnl_populate_cache(struct ccnl_relay_s *ccnl, char *path)
+#ifdef USE_SHM_FACES
+static void
+ccnl_io_shm_deliver(struct ccnl_relay_s *ccnl, int i, uint8_t *data,
+                    size_t len, sockunion *src, struct ccnl_buf_s **rxbuf)
 {
-    DIR *dir;
-    struct dirent *de;
+    ccnl_io_deliver(ccnl, i, data, len, src, sizeof(src->ux), rxbuf);
+    ccnl_io_flush_filling(ccnl);
+}
+#endif
 
-    dir = opendir(path);
-    if (!dir) {
-        DEBUGMSG(ERROR, "could not open directory %s\n", path);
-        return;
+int
+ccnl_io_set_backend(const char *name)
+{
+    if (!strcmp(name, "select")) {
+        io_backend = CCNL_IO_SELECT;
+#ifdef USE_EPOLL
+    } else if (!strcmp(name, "epoll")) {
+        io_backend = CCNL_IO_EPOLL;
+#endif
+#ifdef USE_URING
+    } else if (!strcmp(name, "uring")) {
+        io_backend = CCNL_IO_URING;
+#endif
+    } else {
+        return -1;
     }
+    return 0;
+}
 
-    DEBUGMSG(INFO, "populating cache from directory %s\n", path);
+int
+ccnl_io_set_rx_batch(int batch)
+{
+    if (batch < 1 || batch > CCNL_MAX_RX_BATCH) {
+        return -1;
+    }
+    rx_batch = batch;
+    return 0;
+}
 
-    while ((de = readdir(dir))) {
-        char fname[1000];
-        struct stat s;
-        struct ccnl_buf_s *buf = 0; // , *nonce=0, *ppkd=0, *pkt = 0;
-        struct ccnl_content_s *c = 0;
-        int fd, suite;
-        ssize_t recvlen;
-        size_t datalen, skip, flen;
-        uint8_t *data;
-        (void) data; // silence compiler warning (if any USE_SUITE_* is not set)
-#if defined(USE_SUITE_NDNTLV)
-        uint64_t typ;
-        size_t len;
+int
+ccnl_io_use_udp_offload(int on)
+{
+#ifdef USE_UDP_GSO
+    use_udp_offload = on;
+    return 0;
+#else
+    return on ? -1 : 0;
 #endif
-        struct ccnl_pkt_s *pk;
+}
 
-        if (de->d_name[0] == '.') {
-            continue;
-        }
+int
+ccnl_io_use_packet_rings(int on)
+{
+#ifdef USE_TPACKET
+    use_prings = on;
+    return 0;
+#else
+    return on ? -1 : 0;
+#endif
+}
 
-        strcpy(fname, path);
-        strcat(fname, "/");
-        strcat(fname, de->d_name);
+static void
+ccnl_rxring_free(struct ccnl_rxring_s *rx)
+{
+    int k;
 
-        if (stat(fname, &s)) {
-            perror("stat");
-            continue;
+    if (rx->pool) {
+        rx->pool->max = 0;
+        for (k = 0; rx->bufs && k < rx->size; k++) {
+            ccnl_buf_free(rx->bufs[k]);
+        }
+        ccnl_bufpool_drain(rx->pool);
+    }
+    ccnl_free(rx->bufs);
+    ccnl_free(rx->addrs);
+#ifdef USE_MMSG
+    ccnl_free(rx->iovs);
+    ccnl_free(rx->msgs);
+#endif
+#ifdef USE_UDP_GSO
+    ccnl_free(rx->ctrls);
+#endif
+    memset(rx, 0, sizeof(*rx));
+}
+
+static int
+ccnl_rxring_init(struct ccnl_rxring_s *rx, int size,
+                 struct ccnl_bufpool_s *pool)
+{
+    int k;
+#ifndef USE_MMSG
+
+    size = 1; // without recvmmsg, datagrams are read one at a time
+#endif
+
+    memset(rx, 0, sizeof(*rx));
+    rx->size = size;
+    rx->pool = pool;
+    pool->max = (unsigned int) size; // a spare buffer for each slot
+    rx->bufs = (struct ccnl_buf_s **) ccnl_calloc(size, sizeof(*rx->bufs));
+    for (k = 0; rx->bufs && k < size; k++) {
+        rx->bufs[k] = ccnl_bufpool_get(pool);
+        if (!rx->bufs[k]) {
+            ccnl_rxring_free(rx);
+            return -1;
+        }
+    }
+    rx->addrs = (sockunion *) ccnl_calloc(size, sizeof(*rx->addrs));
+#ifdef USE_MMSG
+    rx->iovs = (struct iovec *) ccnl_calloc(size, sizeof(*rx->iovs));
+    rx->msgs = (struct mmsghdr *) ccnl_calloc(size, sizeof(*rx->msgs));
+#ifdef USE_UDP_GSO
+    rx->ctrls = (union ccnl_udpctrl_u *) ccnl_calloc(size, sizeof(*rx->ctrls));
+    if (!rx->ctrls) {
+        ccnl_rxring_free(rx);
+        return -1;
+    }
+#endif
+    if (!rx->bufs || !rx->addrs || !rx->iovs || !rx->msgs) {
+        ccnl_rxring_free(rx);
+        return -1;
+    }
+    for (k = 0; k < size; k++) {
+        rx->msgs[k].msg_hdr.msg_name = rx->addrs + k;
+        rx->msgs[k].msg_hdr.msg_iov = rx->iovs + k;
+        rx->msgs[k].msg_hdr.msg_iovlen = 1;
+#ifdef USE_UDP_GSO
+        rx->msgs[k].msg_hdr.msg_control = rx->ctrls[k].buf;
+#endif
+    }
+#else
+    if (!rx->bufs || !rx->addrs) {
+        ccnl_rxring_free(rx);
+        return -1;
+    }
+#endif
+    return 0;
+}
+
+#ifdef USE_UDP_GSO
+/* the size of the datagrams a read returned coalesced, 0 if it returned
+   a single one */
+static size_t
+ccnl_udp_gro_size(struct msghdr *msg)
+{
+    struct cmsghdr *cm;
+
+    for (cm = CMSG_FIRSTHDR(msg); cm; cm = CMSG_NXTHDR(msg, cm)) {
+        if (cm->cmsg_level == IPPROTO_UDP && cm->cmsg_type == UDP_GRO) {
+            int size;
+
+            memcpy(&size, CMSG_DATA(cm), sizeof(size));
+            return size > 0 ? (size_t) size : 0;
+        }
+    }
+    return 0;
+}
+
+/* whether request r can be added to the GSO send msg: all its datagrams
+   have the size of the first one, only the last may be shorter, and none
+   is larger than maxseg */
+static int
+ccnl_udp_gso_joins(struct msghdr *msg, struct ccnl_txrequest_s *r,
+                   size_t maxseg)
+{
+    size_t size = msg->msg_iov[0].iov_len;
+    size_t last = msg->msg_iov[msg->msg_iovlen - 1].iov_len;
+
+    return msg->msg_iovlen < CCNL_UDP_GSO_SEGS && last == size &&
+           size <= maxseg &&
+           r->buf->datalen > 0 && r->buf->datalen <= size &&
+           size * msg->msg_iovlen + r->buf->datalen <= CCNL_UDP_GSO_BYTES &&
+           !memcmp(msg->msg_name, &r->dst, msg->msg_namelen);
+}
+
+static void
+ccnl_udp_gso_ctrl(struct msghdr *msg, union ccnl_udpctrl_u *ctrl)
+{
+    struct cmsghdr *cm;
+    uint16_t size = (uint16_t) msg->msg_iov[0].iov_len;
+
+    msg->msg_control = ctrl->buf;
+    msg->msg_controllen = CMSG_SPACE(sizeof(size));
+    cm = CMSG_FIRSTHDR(msg);
+    cm->cmsg_level = IPPROTO_UDP;
+    cm->cmsg_type = UDP_SEGMENT;
+    cm->cmsg_len = CMSG_LEN(sizeof(size));
+    memcpy(CMSG_DATA(cm), &size, sizeof(size));
+}
+#endif // USE_UDP_GSO
+
+#ifdef USE_TPACKET
+/* hands the frames of the blocks the kernel has filled to the relay,
+   straight out of the ring, and gives the blocks back; whole blocks until
+   a batch of frames is done, the socket stays readable for the others */
+static void
+ccnl_pring_rx(struct ccnl_relay_s *ccnl, struct ccnl_pring_s *r, int i)
+{
+    int done = 0;
+
+    while (done < rx_batch) {
+        struct tpacket_block_desc *bd = (struct tpacket_block_desc *)
+            (r->map + (size_t) r->rx_block * CCNL_PRING_BLOCKSIZE);
+        struct tpacket3_hdr *h;
+        uint32_t k, n;
+
+        if (!(__atomic_load_n(&bd->hdr.bh1.block_status, __ATOMIC_ACQUIRE) &
+                                                            TP_STATUS_USER)) {
+            break;
+        }
+        n = bd->hdr.bh1.num_pkts;
+        h = (struct tpacket3_hdr *) ((uint8_t *) bd +
+                                     bd->hdr.bh1.offset_to_first_pkt);
+        for (k = 0; k < n; k++) {
+            sockunion src;
+
+            // the link layer address follows the frame header
+            memset(&src, 0, sizeof(src));
+            memcpy(&src.linklayer, (uint8_t *) h + TPACKET_ALIGN(sizeof(*h)),
+                   sizeof(src.linklayer));
+            ccnl_io_dispatch(ccnl, i, (uint8_t *) h + h->tp_mac,
+                             h->tp_snaplen, &src, NULL);
+            h = (struct tpacket3_hdr *) ((uint8_t *) h + h->tp_next_offset);
+        }
+#ifdef USE_STATS
+        ccnl->ifs[i].rx_batches++;
+        ccnl->ifs[i].rx_batched += n;
+#endif
+        __atomic_store_n(&bd->hdr.bh1.block_status, TP_STATUS_KERNEL,
+                         __ATOMIC_RELEASE);
+        r->rx_block = (r->rx_block + 1) % CCNL_PRING_RX_BLOCKS;
+        done += (int) n;
+        ccnl_io_flush_filling(ccnl);
+    }
+}
+
+/* maps packet rings for the Ethernet interfaces, those where this fails
+   keep using their socket */
+static void
+ccnl_pring_setup(struct ccnl_relay_s *ccnl)
+{
+    int i;
+
+    for (i = 0; i < ccnl->ifcount; i++) {
+        if (ccnl->ifs[i].addr.sa.sa_family != AF_PACKET || prings[i]) {
+            continue;
+        }
+        prings[i] = ccnl_pring_new(ccnl->ifs[i].sock);
+        if (prings[i]) {
+            DEBUGMSG(INFO, "i%d uses mmap'ed packet rings\n", i);
+        } else {
+            DEBUGMSG(WARNING, "no packet rings for i%d: %s\n",
+                     i, strerror(errno));
+        }
+    }
+}
+
+static void
+ccnl_pring_flush(void)
+{
+    int i;
+
+    for (i = 0; i < CCNL_MAX_INTERFACES; i++) {
+        if (prings[i] && prings[i]->tx_pending) {
+            ccnl_pring_kick(prings[i]);
+        }
+    }
+}
+
+static void
+ccnl_pring_cleanup(void)
+{
+    int i;
+
+    ccnl_pring_flush();
+    for (i = 0; i < CCNL_MAX_INTERFACES; i++) {
+        if (prings[i]) {
+            ccnl_pring_free(prings[i]);
+            prings[i] = NULL;
+        }
+    }
+}
+#endif // USE_TPACKET
+
+/* drains up to one batch of datagrams from interface i, then hands them to
+   the relay in the order they were received */
+static void
+ccnl_io_rx(struct ccnl_relay_s *ccnl, int i)
+{
+    struct ccnl_rxring_s *rx = &rxring;
+    int k, n;
+#ifdef USE_STREAM_FACES
+
+    if (ccnl->ifs[i].stream) {
+        ccnl_stream_rx(ccnl, i, ccnl_io_stream_deliver);
+        return;
+    }
+#endif
+#ifdef USE_TPACKET
+
+    if (prings[i]) {
+        ccnl_pring_rx(ccnl, prings[i], i);
+        return;
+    }
+#endif
+#ifdef USE_MMSG
+
+    for (k = 0; k < rx->size; k++) {
+        rx->iovs[k].iov_base = rx->bufs[k]->data;
+        rx->iovs[k].iov_len = rx->pool->bufsize;
+        rx->msgs[k].msg_hdr.msg_namelen = sizeof(sockunion);
+#ifdef USE_UDP_GSO
+        rx->msgs[k].msg_hdr.msg_controllen = sizeof(rx->ctrls[k]);
+#endif
+    }
+    n = recvmmsg(ccnl->ifs[i].sock, rx->msgs, (unsigned int) rx->size,
+                 MSG_DONTWAIT, NULL);
+    if (n <= 0) {
+        return;
+    }
+#else
+    socklen_t addrlen = sizeof(sockunion);
+    ssize_t recvlen;
+
+    recvlen = recvfrom(ccnl->ifs[i].sock, rx->bufs[0]->data,
+                       rx->pool->bufsize, 0,
+                       &rx->addrs[0].sa, &addrlen);
+    if (recvlen <= 0) {
+        return;
+    }
+    n = 1;
+#endif
+#ifdef USE_STATS
+    ccnl->ifs[i].rx_batches++;
+    ccnl->ifs[i].rx_batched += n;
+#endif
+    for (k = 0; k < n; k++) {
+        unsigned char *buf = rx->bufs[k]->data;
+#ifdef USE_MMSG
+        size_t len = rx->msgs[k].msg_len;
+#else
+        size_t len = (size_t) recvlen;
+#endif
+#ifdef USE_UDP_GSO
+        size_t seg = ccnl_udp_gro_size(&rx->msgs[k].msg_hdr);
+
+        // split what GRO coalesced back into the datagrams that were sent
+        for (; seg > 0 && len > seg; buf += seg, len -= seg) {
+            ccnl_io_dispatch(ccnl, i, buf, seg, rx->addrs + k, NULL);
+#ifdef USE_STATS
+            ccnl->ifs[i].rx_batched++;
+#endif
+        }
+#endif
+        if (len > 0) {
+            ccnl_io_dispatch(ccnl, i, buf, len, rx->addrs + k, rx->bufs + k);
+        }
+    }
+}
+
+#if defined(USE_MMSG) || defined(USE_URING)
+/* the address length for sending to dst with sendto, 0 if the packet has to
+   go through ccnl_ll_TX */
+static socklen_t
+ccnl_io_addrlen(struct ccnl_if_s *ifc, sockunion *dst)
+{
+    if (ifc->stream) {
+        return 0; // appended to the connection's write buffer
+    }
+    switch (dst->sa.sa_family) {
+#ifdef USE_IPV4
+    case AF_INET:
+        return sizeof(dst->ip4);
+#endif
+#ifdef USE_IPV6
+    case AF_INET6:
+        return sizeof(dst->ip6);
+#endif
+#ifdef USE_UNIXSOCKET
+    case AF_UNIX:
+#ifdef USE_SHM_FACES
+        if (ccnl_shm_of(dst)) {
+            return 0; // goes into the application's ring instead
+        }
+#endif
+        return sizeof(dst->ux);
+#endif
+    default:
+        return 0;
+    }
+}
+#endif
+
+/* drains the queue of an interface; with sendmmsg, consecutive datagrams
+   for the socket leave in one call, each still completed on its own; with
+   GSO, runs of equally sized datagrams to one peer are a single send */
+static void
+ccnl_io_tx(struct ccnl_relay_s *ccnl, struct ccnl_if_s *ifc)
+{
+#ifdef USE_MMSG
+    struct mmsghdr msgs[CCNL_MAX_IF_QLEN];
+    struct iovec iovs[CCNL_MAX_IF_QLEN];
+#endif
+#ifdef USE_UDP_GSO
+    union ccnl_udpctrl_u ctrls[CCNL_MAX_IF_QLEN];
+    int gso = udp_offload[ifc - ccnl->ifs] & CCNL_UDP_GSO;
+#endif
+
+    while (ifc->qlen > 0) {
+#ifdef USE_MMSG
+        struct ccnl_txrequest_s req;
+        size_t k, j, n, m = 0; // requests, and the messages they fill
+        int rc;
+
+        for (n = 0; n < ifc->qlen && ccnl->ccnl_ll_TX_ptr == ccnl_ll_TX; n++) {
+            struct ccnl_txrequest_s *r =
+                ifc->queue + (ifc->qfront + n) % CCNL_MAX_IF_QLEN;
+            socklen_t addrlen = ccnl_io_addrlen(ifc, &r->dst);
+
+            if (!addrlen) {
+                break;
+            }
+            iovs[n].iov_base = r->buf->data;
+            iovs[n].iov_len = r->buf->datalen;
+#ifdef USE_UDP_GSO
+            if (m > 0 && gso && ccnl_udp_gso_joins(&msgs[m - 1].msg_hdr, r,
+                                            udp_gso_maxseg[ifc - ccnl->ifs])) {
+                msgs[m - 1].msg_hdr.msg_iovlen++; // iovs[n] is next in line
+                continue;
+            }
+#endif
+            memset(msgs + m, 0, sizeof(msgs[m]));
+            msgs[m].msg_hdr.msg_name = &r->dst;
+            msgs[m].msg_hdr.msg_namelen = addrlen;
+            msgs[m].msg_hdr.msg_iov = iovs + n;
+            msgs[m].msg_hdr.msg_iovlen = 1;
+            m++;
+        }
+        if (m > 0) {
+#ifdef USE_UDP_GSO
+            for (k = 0; k < m; k++) {
+                if (msgs[k].msg_hdr.msg_iovlen > 1) {
+                    ccnl_udp_gso_ctrl(&msgs[k].msg_hdr, ctrls + k);
+                }
+            }
+#endif
+            rc = sendmmsg(ifc->sock, msgs, (unsigned int) m, MSG_DONTWAIT);
+            DEBUGMSG(DEBUG, "sendmmsg of %zu datagrams in %zu sends "
+                     "returned %d\n", n, m, rc);
+            if (rc < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) {
+                    return; // the rest goes once the socket is writable
+                }
+#ifdef USE_UDP_GSO
+                if (msgs[0].msg_hdr.msg_iovlen > 1) {
+                    DEBUGMSG(WARNING, "UDP GSO send failed (%s), sending "
+                             "the datagrams one by one\n", strerror(errno));
+                    gso = 0;
+                    continue;
+                }
+#endif
+                rc = 1; // the first datagram failed: dropped, as with sendto
+            }
+            for (k = 0; k < (size_t) rc; k++) {
+                for (j = 0; j < msgs[k].msg_hdr.msg_iovlen; j++) {
+                    ccnl_interface_dequeue(ifc, &req);
+                    ccnl_interface_tx_done(ifc, &req);
+                }
+            }
+            continue;
+        }
+#endif
+        ccnl_interface_CTS(ccnl, ifc);
+    }
+}
+
+/* sends what was queued while serving the last events and timers */
+static void
+ccnl_io_flush(struct ccnl_relay_s *ccnl)
+{
+    int i;
+
+    ccnl_app_flush(ccnl);
+    if (!ccnl->tx_deferred) {
+        return;
+    }
+    for (i = 0; i < ccnl->ifcount; i++) {
+        if (ccnl->ifs[i].qlen > 0) {
+            ccnl_io_tx(ccnl, ccnl->ifs + i);
+        }
+    }
+#ifdef USE_TPACKET
+    ccnl_pring_flush();
+#endif
+#ifdef USE_STREAM_FACES
+    ccnl_stream_flush();
+#endif
+}
+
+#ifdef USE_EPOLL
+
+// epoll tags of the timer and the status server; interfaces use their index
+#define CCNL_EPOLL_TIMER        CCNL_MAX_INTERFACES
+#define CCNL_EPOLL_HTTP         (CCNL_MAX_INTERFACES + 1)
+#define CCNL_EPOLL_SHM          (CCNL_MAX_INTERFACES + 2)
+#define CCNL_EPOLL_MAXEVENTS    (CCNL_MAX_INTERFACES + 3)
+
+static int
+ccnl_epoll_ctl(int epfd, int op, int fd, uint32_t events, uint32_t tag)
+{
+    struct epoll_event ev;
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.u32 = tag;
+    return epoll_ctl(epfd, op, fd, &ev);
+}
+
+/* sets the timerfd to the expiry of the earliest pending timer; the timerfd
+   is only touched when that expiry changes */
+static void
+ccnl_epoll_timer(int tfd, struct timeval *armed, int *is_armed)
+{
+    struct itimerspec its;
+    struct timeval next;
+
+    memset(&its, 0, sizeof(its));
+    if (!ccnl_timer_next(&next)) {
+        if (*is_armed && next.tv_sec == armed->tv_sec &&
+                         next.tv_usec == armed->tv_usec) {
+            return;
+        }
+        its.it_value.tv_sec = next.tv_sec;
+        its.it_value.tv_nsec = next.tv_usec * 1000L;
+        if (!its.it_value.tv_sec && !its.it_value.tv_nsec) {
+            its.it_value.tv_nsec = 1; // an all-zero value disarms the timer
+        }
+        *armed = next;
+        *is_armed = 1;
+    } else if (*is_armed) {
+        *is_armed = 0;
+    } else {
+        return;
+    }
+    if (timerfd_settime(tfd, TFD_TIMER_ABSTIME, &its, NULL) < 0) {
+        perror("timerfd_settime(): ");
+    }
+}
+
+/* the epoll flavour of the IO loop: sockets and the timer are registered
+   once, write interest is only armed while an interface has queued packets;
+   returns -1 if epoll is not available, before serving anything */
+static int
+ccnl_io_loop_epoll(struct ccnl_relay_s *ccnl)
+{
+    struct epoll_event events[CCNL_EPOLL_MAXEVENTS];
+    uint32_t ifevents[CCNL_MAX_INTERFACES];
+    struct timeval armed;
+    int epfd, tfd, i, n, is_armed = 0;
+#ifdef USE_HTTP_STATUS
+    int hfd = -1;
+    uint32_t hevents = 0;
+#endif
+
+    epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (epfd < 0) {
+        return -1;
+    }
+    tfd = timerfd_create(CLOCK_REALTIME, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (tfd < 0 ||
+        ccnl_epoll_ctl(epfd, EPOLL_CTL_ADD, tfd, EPOLLIN, CCNL_EPOLL_TIMER)) {
+        goto Fail;
+    }
+    for (i = 0; i < ccnl->ifcount; i++) {
+        ifevents[i] = EPOLLIN;
+        if (ccnl_epoll_ctl(epfd, EPOLL_CTL_ADD, ccnl->ifs[i].sock,
+                           EPOLLIN, (uint32_t) i)) {
+            goto Fail;
+        }
+    }
+#ifdef USE_SHM_FACES
+    if (shm_bell >= 0 &&
+        ccnl_epoll_ctl(epfd, EPOLL_CTL_ADD, shm_bell, EPOLLIN, CCNL_EPOLL_SHM)) {
+        goto Fail;
+    }
+#endif
+
+    DEBUGMSG(INFO, "starting main event and IO loop (epoll)\n");
+    while (!ccnl->halt_flag) {
+        ccnl_run_events();
+        ccnl_io_flush(ccnl);
+        ccnl_epoll_timer(tfd, &armed, &is_armed);
+
+        for (i = 0; i < ccnl->ifcount; i++) {
+            uint32_t want = ccnl->ifs[i].qlen > 0 ? EPOLLIN | EPOLLOUT
+                                                  : EPOLLIN;
+            if (want != ifevents[i] &&
+                !ccnl_epoll_ctl(epfd, EPOLL_CTL_MOD, ccnl->ifs[i].sock,
+                                want, (uint32_t) i)) {
+                ifevents[i] = want;
+            }
+        }
+#ifdef USE_HTTP_STATUS
+        if (ccnl->http) {
+            int rd, wr, fd = ccnl_http_wants(ccnl->http, &rd, &wr);
+            uint32_t want = (rd ? EPOLLIN : 0) | (wr ? EPOLLOUT : 0);
+
+            if (fd != hfd) {
+                // a closed client socket has already left the epoll set
+                if (hfd >= 0) {
+                    epoll_ctl(epfd, EPOLL_CTL_DEL, hfd, NULL);
+                }
+                hfd = ccnl_epoll_ctl(epfd, EPOLL_CTL_ADD, fd, want,
+                                     CCNL_EPOLL_HTTP) ? -1 : fd;
+                hevents = want;
+            } else if (want != hevents &&
+                       !ccnl_epoll_ctl(epfd, EPOLL_CTL_MOD, fd, want,
+                                       CCNL_EPOLL_HTTP)) {
+                hevents = want;
+            }
+        }
+#endif
+
+        n = epoll_wait(epfd, events, CCNL_EPOLL_MAXEVENTS, -1);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("epoll_wait(): ");
+            exit(EXIT_FAILURE);
+        }
+
+        for (i = 0; i < n; i++) {
+            uint32_t tag = events[i].data.u32;
+            uint32_t ev = events[i].events;
+
+            if (tag == CCNL_EPOLL_TIMER) {
+                uint64_t expirations;
+                if (read(tfd, &expirations, sizeof(expirations)) < 0) {
+                    DEBUGMSG(TRACE, "  timerfd read failed\n");
+                }
+                is_armed = 0;
+            }
+#ifdef USE_HTTP_STATUS
+            else if (tag == CCNL_EPOLL_HTTP) {
+                ccnl_http_io(ccnl, ccnl->http, hfd,
+                             (ev & (EPOLLIN | EPOLLHUP | EPOLLERR)) != 0,
+                             (ev & EPOLLOUT) != 0);
+            }
+#endif
+#ifdef USE_SHM_FACES
+            else if (tag == CCNL_EPOLL_SHM) {
+                ccnl_shm_rx(ccnl, ccnl_io_shm_deliver);
+            }
+#endif
+            else if (tag < (uint32_t) ccnl->ifcount) {
+                if (ev & (EPOLLIN | EPOLLERR)) {
+                    ccnl_io_rx(ccnl, (int) tag);
+                }
+                if (ev & EPOLLOUT) {
+                    if (ccnl->tx_deferred) {
+                        ccnl_io_tx(ccnl, ccnl->ifs + tag);
+                    } else {
+                        ccnl_interface_CTS(ccnl, ccnl->ifs + tag);
+                    }
+                }
+            }
+        }
+    }
+
+    close(tfd);
+    close(epfd);
+    return 0;
+
+Fail:
+    if (tfd >= 0) {
+        close(tfd);
+    }
+    close(epfd);
+    return -1;
+}
+
+#endif // USE_EPOLL
+
+#ifdef USE_URING
+
+#define CCNL_URING_ENTRIES      256
+#define CCNL_URING_BUFS         128 // provided receive buffers, a power of 2
+#define CCNL_URING_BUFSIZE      (sizeof(struct io_uring_recvmsg_out) + \
+                                 sizeof(sockunion) + CCNL_MAX_PACKET_SIZE)
+#define CCNL_URING_SENDS        (CCNL_MAX_INTERFACES * CCNL_MAX_IF_QLEN)
+
+// user_data of a submission: what it is in the upper half, an index below
+#define CCNL_URING_RECV         1
+#define CCNL_URING_SEND         2
+#define CCNL_URING_TIMER        3
+#define CCNL_URING_HTTP         4
+#define CCNL_URING_CANCEL       5
+#define CCNL_URING_POLL         6 // readiness of a socket read by ccnl_io_rx
+#define CCNL_URING_SHM          7 // the doorbell of the shm channels
+
+#if defined(USE_TPACKET) || defined(USE_UDP_GSO) || defined(USE_STREAM_FACES)
+/* whether interface i is read by ccnl_io_rx once it is readable */
+static int
+ccnl_io_polled(struct ccnl_relay_s *ccnl, int i)
+{
+    (void) ccnl;
+#ifdef USE_STREAM_FACES
+    if (ccnl->ifs[i].stream) {
+        return 1;
+    }
+#endif
+#ifdef USE_TPACKET
+    if (prings[i]) {
+        return 1;
+    }
+#endif
+#ifdef USE_UDP_GSO
+    if (udp_offload[i] & CCNL_UDP_GRO) {
+        return 1;
+    }
+#endif
+    return 0;
+}
+#endif
+#define CCNL_URING_DATA(kind, idx)  (((uint64_t) (kind) << 32) | (uint32_t) (idx))
+
+struct ccnl_uring_send_s {
+    struct ccnl_if_s *ifc;
+    struct ccnl_txrequest_s req;   // dequeued, completed when the send is
+    struct iovec iov;
+    struct msghdr msg;
+    int next_free;
+};
+
+struct ccnl_uring_s {
+    int fd;
+    void *ring;                    // shared SQ and CQ ring
+    size_t ring_size;
+    struct io_uring_sqe *sqes;
+    size_t sqes_size;
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array, sq_entries;
+    unsigned sq_local;             // our tail, published on submission
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_cqe *cqes;
+    struct io_uring_buf_ring *br;  // ring of the provided receive buffers
+    size_t br_size;
+    uint16_t br_tail;
+    unsigned char *bufs;
+    struct msghdr recvmsg[CCNL_MAX_INTERFACES]; // multishot receive templates
+    struct ccnl_uring_send_s sends[CCNL_URING_SENDS];
+    int free_send, inflight;
+    struct __kernel_timespec ts;
+    struct timeval armed;          // expiry the timeout was submitted for
+    uint32_t timer_gen;
+    int timer_armed;
+    int http_fd, http_polling;
+};
+
+static int
+ccnl_uring_enter(struct ccnl_uring_s *u, unsigned to_submit,
+                 unsigned min_complete)
+{
+    return (int) syscall(__NR_io_uring_enter, u->fd, to_submit, min_complete,
+                         min_complete ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+}
+
+/* hands the prepared entries to the kernel and, if asked to, waits until
+   at least one completion is there */
+static int
+ccnl_uring_submit(struct ccnl_uring_s *u, int wait)
+{
+    __atomic_store_n(u->sq_tail, u->sq_local, __ATOMIC_RELEASE);
+    return ccnl_uring_enter(u, u->sq_local -
+                            __atomic_load_n(u->sq_head, __ATOMIC_ACQUIRE),
+                            wait ? 1 : 0);
+}
+
+static struct io_uring_sqe*
+ccnl_uring_sqe(struct ccnl_uring_s *u)
+{
+    struct io_uring_sqe *sqe;
+    unsigned idx;
+
+    if (u->sq_local - __atomic_load_n(u->sq_head, __ATOMIC_ACQUIRE) >=
+                                                        u->sq_entries) {
+        ccnl_uring_submit(u, 0);
+        if (u->sq_local - __atomic_load_n(u->sq_head, __ATOMIC_ACQUIRE) >=
+                                                        u->sq_entries) {
+            return NULL;
+        }
+    }
+    idx = u->sq_local & *u->sq_mask;
+    u->sq_array[idx] = idx;
+    sqe = u->sqes + idx;
+    memset(sqe, 0, sizeof(*sqe));
+    u->sq_local++;
+    return sqe;
+}
+
+/* gives a receive buffer (back) to the kernel */
+static void
+ccnl_uring_recycle(struct ccnl_uring_s *u, uint16_t bid)
+{
+    struct io_uring_buf *b = u->br->bufs + (u->br_tail & (CCNL_URING_BUFS - 1));
+
+    b->addr = (uintptr_t) (u->bufs + (size_t) bid * CCNL_URING_BUFSIZE);
+    b->len = CCNL_URING_BUFSIZE;
+    b->bid = bid;
+    u->br_tail++;
+    __atomic_store_n(&u->br->tail, u->br_tail, __ATOMIC_RELEASE);
+}
+
+static void
+ccnl_uring_free(struct ccnl_uring_s *u)
+{
+    if (u->ring) {
+        munmap(u->ring, u->ring_size);
+    }
+    if (u->sqes) {
+        munmap(u->sqes, u->sqes_size);
+    }
+    if (u->br) {
+        munmap(u->br, u->br_size);
+    }
+    ccnl_free(u->bufs);
+    if (u->fd >= 0) {
+        close(u->fd);
+    }
+    ccnl_free(u);
+}
+
+static struct ccnl_uring_s*
+ccnl_uring_new(void)
+{
+    struct ccnl_uring_s *u;
+    struct io_uring_params p;
+    struct io_uring_buf_reg reg;
+    size_t cq_size;
+    void *m;
+    int k;
+
+    u = (struct ccnl_uring_s *) ccnl_calloc(1, sizeof(*u));
+    if (!u) {
+        return NULL;
+    }
+    memset(&p, 0, sizeof(p));
+    u->fd = (int) syscall(__NR_io_uring_setup, CCNL_URING_ENTRIES, &p);
+    if (u->fd < 0 || !(p.features & IORING_FEAT_SINGLE_MMAP)) {
+        goto Fail;
+    }
+
+    u->ring_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    cq_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if (cq_size > u->ring_size) {
+        u->ring_size = cq_size;
+    }
+    m = mmap(NULL, u->ring_size, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_POPULATE, u->fd, IORING_OFF_SQ_RING);
+    if (m == MAP_FAILED) {
+        goto Fail;
+    }
+    u->ring = m;
+    u->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+    m = mmap(NULL, u->sqes_size, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_POPULATE, u->fd, IORING_OFF_SQES);
+    if (m == MAP_FAILED) {
+        goto Fail;
+    }
+    u->sqes = (struct io_uring_sqe *) m;
+    u->sq_head = (unsigned *) ((char *) u->ring + p.sq_off.head);
+    u->sq_tail = (unsigned *) ((char *) u->ring + p.sq_off.tail);
+    u->sq_mask = (unsigned *) ((char *) u->ring + p.sq_off.ring_mask);
+    u->sq_array = (unsigned *) ((char *) u->ring + p.sq_off.array);
+    u->sq_entries = p.sq_entries;
+    u->sq_local = *u->sq_tail;
+    u->cq_head = (unsigned *) ((char *) u->ring + p.cq_off.head);
+    u->cq_tail = (unsigned *) ((char *) u->ring + p.cq_off.tail);
+    u->cq_mask = (unsigned *) ((char *) u->ring + p.cq_off.ring_mask);
+    u->cqes = (struct io_uring_cqe *) ((char *) u->ring + p.cq_off.cqes);
+
+    u->br_size = CCNL_URING_BUFS * sizeof(struct io_uring_buf);
+    m = mmap(NULL, u->br_size, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (m == MAP_FAILED) {
+        goto Fail;
+    }
+    u->br = (struct io_uring_buf_ring *) m;
+    u->bufs = (unsigned char *) ccnl_malloc(CCNL_URING_BUFS *
+                                            CCNL_URING_BUFSIZE);
+    if (!u->bufs) {
+        goto Fail;
+    }
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = (uintptr_t) u->br;
+    reg.ring_entries = CCNL_URING_BUFS;
+    reg.bgid = 0;
+    if (syscall(__NR_io_uring_register, u->fd, IORING_REGISTER_PBUF_RING,
+                &reg, 1) < 0) {
+        goto Fail;
+    }
+    for (k = 0; k < CCNL_URING_BUFS; k++) {
+        ccnl_uring_recycle(u, (uint16_t) k);
+    }
+
+    for (k = 0; k < CCNL_URING_SENDS; k++) {
+        u->sends[k].next_free = k + 1 < CCNL_URING_SENDS ? k + 1 : -1;
+    }
+    u->free_send = 0;
+    u->http_fd = -1;
+    return u;
+
+Fail:
+    ccnl_uring_free(u);
+    return NULL;
+}
+
+/* posts a multishot receive on interface i, it keeps completing until the
+   kernel runs out of receive buffers or the socket fails; an interface with
+   a packet ring is polled instead, its frames never pass through a buffer,
+   and so is one with GRO, whose reads do not fit the provided buffers */
+static void
+ccnl_uring_recv(struct ccnl_uring_s *u, struct ccnl_relay_s *ccnl, int i)
+{
+    struct io_uring_sqe *sqe = ccnl_uring_sqe(u);
+
+    if (!sqe) {
+        DEBUGMSG(WARNING, "io_uring: no room to post a receive on i%d\n", i);
+        return;
+    }
+#if defined(USE_TPACKET) || defined(USE_UDP_GSO) || defined(USE_STREAM_FACES)
+    if (ccnl_io_polled(ccnl, i)) {
+        sqe->opcode = IORING_OP_POLL_ADD;
+        sqe->fd = ccnl->ifs[i].sock;
+        sqe->poll32_events = POLLIN;
+        sqe->user_data = CCNL_URING_DATA(CCNL_URING_POLL, i);
+        return;
+    }
+#endif
+    memset(u->recvmsg + i, 0, sizeof(u->recvmsg[i]));
+    u->recvmsg[i].msg_namelen = sizeof(sockunion);
+    sqe->opcode = IORING_OP_RECVMSG;
+    sqe->fd = ccnl->ifs[i].sock;
+    sqe->addr = (uintptr_t) (u->recvmsg + i);
+    sqe->len = 1;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = 0;
+    sqe->user_data = CCNL_URING_DATA(CCNL_URING_RECV, i);
+}
+
+/* turns the interface queues into send submissions; each request is
+   completed when its send is */
+static void
+ccnl_uring_flush(struct ccnl_uring_s *u, struct ccnl_relay_s *ccnl)
+{
+    int i;
+
+    if (!ccnl->tx_deferred) {
+        return;
+    }
+    for (i = 0; i < ccnl->ifcount; i++) {
+        struct ccnl_if_s *ifc = ccnl->ifs + i;
+
+        while (ifc->qlen > 0) {
+            struct ccnl_uring_send_s *s;
+            struct io_uring_sqe *sqe;
+            socklen_t addrlen = ccnl_io_addrlen(ifc,
+                                            &ifc->queue[ifc->qfront].dst);
+            int k;
+
+            if (!addrlen || ccnl->ccnl_ll_TX_ptr != ccnl_ll_TX) {
+                ccnl_interface_CTS(ccnl, ifc);
+                continue;
+            }
+            if (u->free_send < 0 || !(sqe = ccnl_uring_sqe(u))) {
+                break; // the rest goes when sends have completed
+            }
+            k = u->free_send;
+            s = u->sends + k;
+            u->free_send = s->next_free;
+            ccnl_interface_dequeue(ifc, &s->req);
+            s->ifc = ifc;
+            s->iov.iov_base = s->req.buf->data;
+            s->iov.iov_len = s->req.buf->datalen;
+            memset(&s->msg, 0, sizeof(s->msg));
+            s->msg.msg_name = &s->req.dst;
+            s->msg.msg_namelen = addrlen;
+            s->msg.msg_iov = &s->iov;
+            s->msg.msg_iovlen = 1;
+            sqe->opcode = IORING_OP_SENDMSG;
+            sqe->fd = ifc->sock;
+            sqe->addr = (uintptr_t) &s->msg;
+            sqe->len = 1;
+            sqe->user_data = CCNL_URING_DATA(CCNL_URING_SEND, k);
+            u->inflight++;
+        }
+    }
+#ifdef USE_TPACKET
+    ccnl_pring_flush();
+#endif
+#ifdef USE_STREAM_FACES
+    ccnl_stream_flush();
+#endif
+}
+
+/* keeps one timeout submitted for the earliest pending timer */
+static void
+ccnl_uring_timer(struct ccnl_uring_s *u)
+{
+    struct io_uring_sqe *sqe;
+    struct timeval next, now;
+    long usec;
+
+    if (ccnl_timer_next(&next) ||
+        (u->timer_armed && next.tv_sec == u->armed.tv_sec &&
+                           next.tv_usec == u->armed.tv_usec)) {
+        return; // a stale timeout just wakes the loop once
+    }
+    if (u->sq_entries - (u->sq_local -
+            __atomic_load_n(u->sq_head, __ATOMIC_ACQUIRE)) < 2) {
+        ccnl_uring_submit(u, 0);
+    }
+    if (u->timer_armed && (sqe = ccnl_uring_sqe(u))) {
+        sqe->opcode = IORING_OP_TIMEOUT_REMOVE;
+        sqe->fd = -1;
+        sqe->addr = CCNL_URING_DATA(CCNL_URING_TIMER, u->timer_gen);
+        sqe->user_data = CCNL_URING_DATA(CCNL_URING_CANCEL, 0);
+    }
+    sqe = ccnl_uring_sqe(u);
+    if (!sqe) {
+        return;
+    }
+    gettimeofday(&now, NULL);
+    usec = timevaldelta(&next, &now);
+    if (usec < 0) {
+        usec = 0;
+    }
+    u->ts.tv_sec = usec / 1000000;
+    u->ts.tv_nsec = (usec % 1000000) * 1000L;
+    sqe->opcode = IORING_OP_TIMEOUT;
+    sqe->fd = -1;
+    sqe->addr = (uintptr_t) &u->ts;
+    sqe->len = 1;
+    sqe->user_data = CCNL_URING_DATA(CCNL_URING_TIMER, ++u->timer_gen);
+    u->armed = next;
+    u->timer_armed = 1;
+}
+
+#ifdef USE_SHM_FACES
+/* waits (once) for the doorbell of the shm channels to be rung */
+static void
+ccnl_uring_shm(struct ccnl_uring_s *u)
+{
+    struct io_uring_sqe *sqe;
+
+    if (shm_bell < 0 || !(sqe = ccnl_uring_sqe(u))) {
+        return;
+    }
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = shm_bell;
+    sqe->poll32_events = POLLIN;
+    sqe->user_data = CCNL_URING_DATA(CCNL_URING_SHM, 0);
+}
+#endif
+
+#ifdef USE_HTTP_STATUS
+static void
+ccnl_uring_http(struct ccnl_uring_s *u, struct ccnl_relay_s *ccnl)
+{
+    struct io_uring_sqe *sqe;
+    int rd, wr, fd;
+
+    if (!ccnl->http || u->http_polling) {
+        return;
+    }
+    fd = ccnl_http_wants(ccnl->http, &rd, &wr);
+    if (fd < 0 || !(sqe = ccnl_uring_sqe(u))) {
+        return;
+    }
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+    sqe->poll32_events = (rd ? POLLIN : 0) | (wr ? POLLOUT : 0);
+    sqe->user_data = CCNL_URING_DATA(CCNL_URING_HTTP, 0);
+    u->http_fd = fd;
+    u->http_polling = 1;
+}
+#endif
+
+static void
+ccnl_uring_reap(struct ccnl_uring_s *u, struct ccnl_relay_s *ccnl)
+{
+    unsigned head = *u->cq_head;
+#ifdef USE_STATS
+    uint32_t got[CCNL_MAX_INTERFACES];
+    int i;
+
+    memset(got, 0, sizeof(got));
+#endif
+
+    while (head != __atomic_load_n(u->cq_tail, __ATOMIC_ACQUIRE)) {
+        struct io_uring_cqe cqe = u->cqes[head & *u->cq_mask];
+        uint32_t idx = (uint32_t) cqe.user_data;
+
+        // the entry is copied, so the kernel may reuse its slot right away
+        __atomic_store_n(u->cq_head, ++head, __ATOMIC_RELEASE);
+        switch (cqe.user_data >> 32) {
+        case CCNL_URING_RECV:
+            if (cqe.flags & IORING_CQE_F_BUFFER) {
+                uint16_t bid = (uint16_t) (cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+                unsigned char *b = u->bufs + (size_t) bid * CCNL_URING_BUFSIZE;
+                struct io_uring_recvmsg_out *out =
+                    (struct io_uring_recvmsg_out *) b;
+                size_t hdr = sizeof(*out) + sizeof(sockunion);
+                sockunion src;
+
+                memset(&src, 0, sizeof(src));
+                memcpy(&src, b + sizeof(*out), out->namelen < sizeof(src) ?
+                                               out->namelen : sizeof(src));
+                if (cqe.res > 0 && (size_t) cqe.res > hdr &&
+                                            idx < (uint32_t) ccnl->ifcount) {
+                    ccnl_io_dispatch(ccnl, (int) idx, b + hdr,
+                                     (size_t) cqe.res - hdr, &src, NULL);
+#ifdef USE_STATS
+                    got[idx]++;
+#endif
+                }
+                ccnl_uring_recycle(u, bid);
+            } else if (cqe.res < 0 && cqe.res != -ENOBUFS) {
+                DEBUGMSG(DEBUG, "io_uring: receive on i%u failed: %s\n",
+                         idx, strerror(-cqe.res));
+            }
+            if (!(cqe.flags & IORING_CQE_F_MORE) &&
+                                            idx < (uint32_t) ccnl->ifcount) {
+                ccnl_uring_recv(u, ccnl, (int) idx);
+            }
+            break;
+        case CCNL_URING_SEND:
+            if (idx < CCNL_URING_SENDS) {
+                struct ccnl_uring_send_s *s = u->sends + idx;
+
+                if (cqe.res < 0) {
+                    DEBUGMSG(DEBUG, "io_uring: send failed: %s\n",
+                             strerror(-cqe.res));
+                }
+                ccnl_interface_tx_done(s->ifc, &s->req);
+                s->next_free = u->free_send;
+                u->free_send = (int) idx;
+                u->inflight--;
+            }
+            break;
+#if defined(USE_TPACKET) || defined(USE_UDP_GSO) || defined(USE_STREAM_FACES)
+        case CCNL_URING_POLL:
+            if (idx < (uint32_t) ccnl->ifcount) {
+                ccnl_io_rx(ccnl, (int) idx);
+                ccnl_uring_recv(u, ccnl, (int) idx);
+            }
+            break;
+#endif
+#ifdef USE_SHM_FACES
+        case CCNL_URING_SHM:
+            ccnl_shm_rx(ccnl, ccnl_io_shm_deliver);
+            ccnl_uring_shm(u);
+            break;
+#endif
+        case CCNL_URING_TIMER:
+            if (idx == u->timer_gen) {
+                u->timer_armed = 0;
+            }
+            break;
+#ifdef USE_HTTP_STATUS
+        case CCNL_URING_HTTP:
+            u->http_polling = 0;
+            ccnl_http_io(ccnl, ccnl->http, u->http_fd,
+                         cqe.res > 0 && (cqe.res & (POLLIN | POLLHUP | POLLERR)),
+                         cqe.res > 0 && (cqe.res & POLLOUT));
+            break;
+#endif
+        default:
+            break;
+        }
+    }
+#ifdef USE_STATS
+    for (i = 0; i < ccnl->ifcount; i++) {
+        if (got[i]) {
+            ccnl->ifs[i].rx_batches++;
+            ccnl->ifs[i].rx_batched += got[i];
+        }
+    }
+#endif
+}
+
+/* multishot receives need a newer kernel than the rest: where they are not
+   supported, the receives fail as soon as they are submitted */
+static int
+ccnl_uring_probe(struct ccnl_uring_s *u)
+{
+    unsigned head = *u->cq_head;
+    unsigned tail = __atomic_load_n(u->cq_tail, __ATOMIC_ACQUIRE);
+
+    for (; head != tail; head++) {
+        struct io_uring_cqe *cqe = u->cqes + (head & *u->cq_mask);
+        if ((cqe->user_data >> 32) == CCNL_URING_RECV && cqe->res == -EINVAL) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* the io_uring flavour of the IO loop: receives, sends, the timer and the
+   status server are all submissions on one ring, so a loop iteration costs
+   a single system call however many packets it moves; returns -1 if
+   io_uring is not available, before serving anything */
+static int
+ccnl_io_loop_uring(struct ccnl_relay_s *ccnl)
+{
+    struct ccnl_uring_s *u = ccnl_uring_new();
+    int i;
+
+    if (!u) {
+        return -1;
+    }
+    for (i = 0; i < ccnl->ifcount; i++) {
+        ccnl_uring_recv(u, ccnl, i);
+    }
+#ifdef USE_SHM_FACES
+    ccnl_uring_shm(u);
+#endif
+    if (ccnl_uring_submit(u, 0) < 0 || ccnl_uring_probe(u)) {
+        ccnl_uring_free(u);
+        return -1;
+    }
+
+    DEBUGMSG(INFO, "starting main event and IO loop (io_uring)\n");
+    while (!ccnl->halt_flag) {
+        ccnl_run_events();
+        ccnl_uring_flush(u, ccnl);
+        ccnl_uring_timer(u);
+#ifdef USE_HTTP_STATUS
+        ccnl_uring_http(u, ccnl);
+#endif
+        if (ccnl_uring_submit(u, 1) < 0 && errno != EINTR && errno != EBUSY) {
+            perror("io_uring_enter(): ");
+            exit(EXIT_FAILURE);
+        }
+        ccnl_uring_reap(u, ccnl);
+    }
+
+    // let the sends in flight complete before the ring goes away
+    ccnl_uring_flush(u, ccnl);
+    while (u->inflight > 0) {
+        if (ccnl_uring_submit(u, 1) < 0 && errno != EINTR) {
+            break;
+        }
+        ccnl_uring_reap(u, ccnl);
+        ccnl_uring_flush(u, ccnl);
+    }
+    ccnl_uring_free(u);
+    return 0;
+}
+
+#endif // USE_URING
+
+static int
+ccnl_io_loop_select(struct ccnl_relay_s *ccnl)
+{
+    int i, maxfd = -1, rc;
+    fd_set readfs, writefs;
+
+    for (i = 0; i < ccnl->ifcount; i++) {
+        if (ccnl->ifs[i].sock > maxfd) {
+            maxfd = ccnl->ifs[i].sock;
+        }
+    }
+#ifdef USE_SHM_FACES
+    if (shm_bell > maxfd) {
+        maxfd = shm_bell;
+    }
+#endif
+    maxfd++;
+
+    DEBUGMSG(INFO, "starting main event and IO loop\n");
+    while (!ccnl->halt_flag) {
+        int usec = ccnl_run_events();
+
+        ccnl_io_flush(ccnl);
+        FD_ZERO(&readfs);
+        FD_ZERO(&writefs);
+
+#ifdef USE_HTTP_STATUS
+        ccnl_http_anteselect(ccnl, ccnl->http, &readfs, &writefs, &maxfd);
+#endif
+        for (i = 0; i < ccnl->ifcount; i++) {
+            FD_SET(ccnl->ifs[i].sock, &readfs);
+            if (ccnl->ifs[i].qlen > 0) {
+                FD_SET(ccnl->ifs[i].sock, &writefs);
+            }
+        }
+#ifdef USE_SHM_FACES
+        if (shm_bell >= 0) {
+            FD_SET(shm_bell, &readfs);
+        }
+#endif
+
+        if (usec >= 0) {
+            struct timeval deadline;
+            deadline.tv_sec = usec / 1000000;
+            deadline.tv_usec = usec % 1000000;
+            rc = select(maxfd, &readfs, &writefs, NULL, &deadline);
+        } else {
+            rc = select(maxfd, &readfs, &writefs, NULL, NULL);
+        }
+
+        if (rc < 0) {
+            perror("select(): ");
+            exit(EXIT_FAILURE);
+        }
+
+#ifdef USE_HTTP_STATUS
+        ccnl_http_postselect(ccnl, ccnl->http, &readfs, &writefs);
+#endif
+#ifdef USE_SHM_FACES
+        if (shm_bell >= 0 && FD_ISSET(shm_bell, &readfs)) {
+            ccnl_shm_rx(ccnl, ccnl_io_shm_deliver);
+        }
+#endif
+        for (i = 0; i < ccnl->ifcount; i++) {
+            if (FD_ISSET(ccnl->ifs[i].sock, &readfs)) {
+                ccnl_io_rx(ccnl, i);
+            }
+
+            if (FD_ISSET(ccnl->ifs[i].sock, &writefs)) {
+                if (ccnl->tx_deferred) {
+                    ccnl_io_tx(ccnl, ccnl->ifs + i);
+                } else {
+                    ccnl_interface_CTS(ccnl, ccnl->ifs + i);
+                }
+            }
+        }
+    }
+
+    return 0;
+}
+
+int
+ccnl_io_set_shards(int count, int comps)
+{
+#ifdef USE_SHARDS
+    if (count < 0 || count > CCNL_SHARD_MAX ||
+                     comps < 1 || comps > CCNL_MAX_NAME_COMP) {
+        return -1;
+    }
+    shard_count = count;
+    shard_comps = comps;
+    return 0;
+#else
+    return count ? -1 : 0;
+#endif
+}
+
+int
+ccnl_io_loop(struct ccnl_relay_s *ccnl)
+{
+    struct ccnl_bufpool_s *pool = &rxpool;
+    int rc = -1;
+#if defined(USE_UDP_GSO) || (defined(USE_SHARDS) && defined(USE_STREAM_FACES))
+    int i;
+#endif
+#ifdef USE_SHM_FACES
+    int sharded = 0;
+#endif
+
+    if (ccnl->ifcount == 0) {
+        DEBUGMSG(ERROR, "no socket to work with, not good, quitting\n");
+        exit(EXIT_FAILURE);
+    }
+
+#ifdef USE_UDP_GSO
+    for (i = 0; i < ccnl->ifcount; i++) {
+        if (udp_offload[i] & CCNL_UDP_GRO) {
+            pool = &rxpool_gro; // room for a coalesced read
+        }
+    }
+#endif
+    if (ccnl_rxring_init(&rxring, rx_batch, pool)) {
+        DEBUGMSG(ERROR, "no memory for the receive buffers, quitting\n");
+        exit(EXIT_FAILURE);
+    }
+
+#if (defined(USE_MMSG) || defined(USE_URING)) && !defined(USE_SCHEDULER)
+    // without a scheduler pacing the interfaces, queued packets are sent
+    // in batches once the events of a loop iteration have been served
+    ccnl->tx_deferred = 1;
+    ccnl->tx_flush = ccnl_io_tx;
+#endif
+#ifdef USE_SHARDS
+#ifdef USE_STREAM_FACES
+    for (i = 0; shard_count > 0 && i < ccnl->ifcount; i++) {
+        if (ccnl->ifs[i].stream) {
+            // connections are written to by the IO loop only
+            DEBUGMSG(WARNING, "no forwarding threads with stream faces\n");
+            shard_count = 0;
+        }
+    }
+#endif
+    if (shard_count > 0) {
+#ifdef USE_TPACKET
+        if (use_prings) {
+            // the forwarding threads send on the sockets themselves
+            DEBUGMSG(WARNING, "packet rings are not used with forwarding threads\n");
+            use_prings = 0;
+        }
+#endif
+        if (ccnl_shard_setup(ccnl, shard_count, shard_comps)) {
+            DEBUGMSG(WARNING, "could not start the forwarding threads, "
+                              "forwarding in the IO loop\n");
+        } else {
+            // the threads free the receive buffers they are handed
+            pool->shared = 1;
+#ifdef USE_SHM_FACES
+            sharded = 1;
+#endif
+        }
+    }
+#endif
+#ifdef USE_SHM_FACES
+    // the rings have a single consumer, the IO loop: channels are refused
+    // while forwarding threads send on the relay's behalf
+    if (!sharded) {
+        shm_bell = ccnl_shm_setup();
+    }
+#endif
+#ifdef USE_TPACKET
+    if (use_prings) {
+        ccnl_pring_setup(ccnl);
+    }
+#endif
+
+#ifdef USE_URING
+    if (io_backend == CCNL_IO_URING) {
+        rc = ccnl_io_loop_uring(ccnl);
+        if (rc) {
+            DEBUGMSG(WARNING, "io_uring not available, falling back\n");
+        }
+    }
+#endif
+#ifdef USE_EPOLL
+    if (rc && io_backend != CCNL_IO_SELECT) {
+        rc = ccnl_io_loop_epoll(ccnl);
+        if (rc) {
+            DEBUGMSG(WARNING, "epoll not available, falling back to select\n");
+        }
+    }
+#endif
+    if (rc) {
+        ccnl_io_loop_select(ccnl);
+    }
+
+#ifdef USE_SHARDS
+    ccnl_shard_cleanup();
+#endif
+    ccnl_io_flush(ccnl);
+#ifdef USE_SHM_FACES
+    ccnl_shm_cleanup();
+    shm_bell = -1;
+#endif
+#ifdef USE_STREAM_FACES
+    ccnl_stream_cleanup();
+#endif
+    ccnl->tx_deferred = 0;
+    ccnl->tx_flush = NULL;
+#ifdef USE_TPACKET
+    ccnl_pring_cleanup();
+#endif
+    ccnl_rxring_free(&rxring);
+    return 0;
+}
+
+void
+ccnl_populate_cache(struct ccnl_relay_s *ccnl, char *path)
+{
+    DIR *dir;
+    struct dirent *de;
+
+    dir = opendir(path);
+    if (!dir) {
+        DEBUGMSG(ERROR, "could not open directory %s\n", path);
+        return;
+    }
+
+    DEBUGMSG(INFO, "populating cache from directory %s\n", path);
+
+    while ((de = readdir(dir))) {
+        char fname[1000];
+        struct stat s;
+        struct ccnl_buf_s *buf = 0; // , *nonce=0, *ppkd=0, *pkt = 0;
+        struct ccnl_content_s *c = 0;
+        int fd, suite;
+        ssize_t recvlen;
+        size_t datalen, skip, flen;
+        uint8_t *data;
+        (void) data; // silence compiler warning (if any USE_SUITE_* is not set)
+#if defined(USE_SUITE_NDNTLV)
+        uint64_t typ;
+        size_t len;
+#endif
+        struct ccnl_pkt_s *pk;
+
+        if (de->d_name[0] == '.') {
+            continue;
+        }
+
+        strcpy(fname, path);
+        strcat(fname, "/");
+        strcat(fname, de->d_name);
+
+        if (stat(fname, &s)) {
+            perror("stat");
+            continue;
         }
         if (S_ISDIR(s.st_mode)) {
             continue;
@@ -726,7 +2625,7 @@ ccnl_populate_cache(struct ccnl_relay_s *ccnl, char *path)
             continue;
         }
 
-        buf = (struct ccnl_buf_s *) ccnl_malloc(sizeof(*buf) + s.st_size);
+        buf = ccnl_buf_new(NULL, s.st_size);
         if (buf) {
             recvlen = read(fd, buf->data, flen);
         } else {
@@ -806,16 +2705,18 @@ ccnl_populate_cache(struct ccnl_relay_s *ccnl, char *path)
             DEBUGMSG(WARNING, "could not create content (%s)\n", de->d_name);
             goto Done;
         }
-        ccnl_content_add2cache(ccnl, c);
         c->flags |= CCNL_CONTENT_FLAGS_STATIC;
+        if (!ccnl_content_add2cache(ccnl, c)) {
+            ccnl_content_free(c);
+        }
 Done:
         ccnl_pkt_free(pk);
-        ccnl_free(buf);
+        ccnl_buf_free(buf);
         continue;
 #if defined(USE_SUITE_CCNB) || defined(USE_SUITE_NDNTLV)
 notacontent:
         DEBUGMSG(WARNING, "not a content object (%s)\n", de->d_name);
-        ccnl_free(buf);
+        ccnl_buf_free(buf);
 #endif
     }
 
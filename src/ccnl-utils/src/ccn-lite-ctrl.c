@@ -513,8 +513,8 @@ mkEchoserverRequest(uint8_t *out, size_t outlen, char *path, int suite,
 }
 
 int8_t
-mkNewFaceRequest(uint8_t *out, size_t outlen, char *macsrc, char *ip4src, char *ip6src, char *wpan_addr,
-         char *wpan_panid, char *host, char *port, char *flags, char *private_key_path, size_t *reslen)
+mkNewFaceRequest(uint8_t *out, size_t outlen, char *macsrc, char *ip4src, char *ip6src, char *proto,
+         char *wpan_addr, char *wpan_panid, char *host, char *port, char *flags, char *private_key_path, size_t *reslen)
 {
     size_t len = 0, len1 = 0, len2 = 0, len3 = 0;
     uint8_t out1[CCNL_MAX_PACKET_SIZE];
@@ -555,7 +555,7 @@ mkNewFaceRequest(uint8_t *out, size_t outlen, char *macsrc, char *ip4src, char *
         if (ccnl_ccnb_mkStrBlob(faceinst+len3, faceinst + sizeof(faceinst), CCNL_DTAG_IP4SRC, CCN_TT_DTAG, ip4src, &len3)) {
             return -1;
         }
-        if (ccnl_ccnb_mkStrBlob(faceinst+len3, faceinst + sizeof(faceinst), CCN_DTAG_IPPROTO, CCN_TT_DTAG, "17", &len3)) {
+        if (ccnl_ccnb_mkStrBlob(faceinst+len3, faceinst + sizeof(faceinst), CCN_DTAG_IPPROTO, CCN_TT_DTAG, proto, &len3)) {
             return -1;
         }
     }
@@ -563,7 +563,7 @@ mkNewFaceRequest(uint8_t *out, size_t outlen, char *macsrc, char *ip4src, char *
         if (ccnl_ccnb_mkStrBlob(faceinst+len3, faceinst + sizeof(faceinst), CCNL_DTAG_IP6SRC, CCN_TT_DTAG, ip6src, &len3)) {
             return -1;
         }
-        if (ccnl_ccnb_mkStrBlob(faceinst+len3, faceinst + sizeof(faceinst), CCN_DTAG_IPPROTO, CCN_TT_DTAG, "17", &len3)) {
+        if (ccnl_ccnb_mkStrBlob(faceinst+len3, faceinst + sizeof(faceinst), CCN_DTAG_IPPROTO, CCN_TT_DTAG, proto, &len3)) {
             return -1;
         }
     }
@@ -1663,6 +1663,8 @@ help:
        "  newUDPface    IP4SRC|any IP4DST PORT [FACEFLAGS]\n"
        "  newWPANface   WPAN_ADDR WPAN_PANID [FACEFLAGS]\n"
        "  newUDP6face   IP6SRC|any IP6DST PORT [FACEFLAGS]\n"
+       "  newTCPface    IP4SRC|any IP4DST PORT [FACEFLAGS]\n"
+       "  newTCP6face   IP6SRC|any IP6DST PORT [FACEFLAGS]\n"
        "  newUNIXface   PATH [FACEFLAGS]\n"
        "  destroyface   FACEID\n"
        "  prefixreg     PREFIX FACEID [SUITE]\n"
@@ -1753,15 +1755,19 @@ help:
             goto Bail;
         }
     } else if (!strcmp(argv[1], "newETHface")||!strcmp(argv[1],
-                "newUDPface")||!strcmp(argv[1], "newUDP6face")) {
+                "newUDPface")||!strcmp(argv[1], "newUDP6face")||
+               !strcmp(argv[1], "newTCPface")||!strcmp(argv[1], "newTCP6face")) {
+        int tcp = !strncmp(argv[1], "newTCP", 6);
         if (argc < 5) {
             goto help;
         }
         if (mkNewFaceRequest(out, sizeof(out),
                        !strcmp(argv[1], "newETHface") ? argv[2] : NULL,
-                       !strcmp(argv[1], "newUDPface") ? argv[2] : NULL,
-                       !strcmp(argv[1], "newUDP6face") ? argv[2] : NULL,
-                       NULL, NULL,
+                       !strcmp(argv[1], "newUDPface") ||
+                       !strcmp(argv[1], "newTCPface") ? argv[2] : NULL,
+                       !strcmp(argv[1], "newUDP6face") ||
+                       !strcmp(argv[1], "newTCP6face") ? argv[2] : NULL,
+                       tcp ? "6" : "17", NULL, NULL,
                        argv[3], argv[4],
                        argc > 5 ? argv[5] : "0x0001", private_key_path, &len)) {
             goto Bail;
@@ -1771,7 +1777,7 @@ help:
             goto help;
         }
         if (mkNewFaceRequest(out, sizeof(out),
-                NULL, NULL, NULL, argv[2], argv[3], NULL, NULL, argc > 5 ? argv[5] : "0x0001", private_key_path,
+                NULL, NULL, NULL, NULL, argv[2], argv[3], NULL, NULL, argc > 5 ? argv[5] : "0x0001", private_key_path,
                 &len)) {
             goto Bail;
         }
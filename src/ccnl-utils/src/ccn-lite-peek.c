@@ -23,6 +23,9 @@
 
 #include "ccnl-common.h"
 #include <unistd.h>
+#ifdef USE_SHM_FACES
+#include "ccnl-shm.h"
+#endif
 #ifndef assert
 #define assert(...) do {} while(0)
 #endif
@@ -32,6 +35,25 @@
 unsigned char out[8*CCNL_MAX_PACKET_SIZE];
 int outlen;
 
+#ifdef USE_SHM_FACES
+int use_shm;
+struct ccnl_shm_client_s chan;
+#endif
+
+void
+peek_exit(int sock, struct sockaddr *sa, int rc)
+{
+#ifdef USE_SHM_FACES
+    if (chan.area) {
+        ccnl_shm_disconnect(sock, (struct sockaddr_un*) sa, &chan);
+    }
+#else
+    (void) sock;
+    (void) sa;
+#endif
+    myexit(rc);
+}
+
 int
 frag_cb(struct ccnl_relay_s *relay, struct ccnl_face_s *from,
         unsigned char **data, int *len)
@@ -59,8 +81,13 @@ main(int argc, char *argv[])
     ccnl_isFragmentFunc isFragment;
 #endif
 
-    while ((opt = getopt(argc, argv, "hn:s:u:v:w:x:")) != -1) {
+    while ((opt = getopt(argc, argv, "hmn:s:u:v:w:x:")) != -1) {
         switch (opt) {
+#ifdef USE_SHM_FACES
+        case 'm':
+            use_shm = 1;
+            break;
+#endif
         case 'n': {
             errno = 0;
             unsigned long chunknum_ul = strtoul(optarg, (char **) NULL, 10);
@@ -104,6 +131,9 @@ usage:
 #endif
             "  -w timeout       in sec (float)\n"
             "  -x ux_path_name  UNIX IPC: use this instead of UDP\n"
+#ifdef USE_SHM_FACES
+            "  -m               with -x: exchange packets over shared memory\n"
+#endif
             "Examples:\n"
             "%% peek /ndn/edu/wustl/ping             (classic lookup)\n"
             "%% peek /rpc/site \"call 1 /test/data\"   (lambda RPC, directed)\n",
@@ -131,6 +161,11 @@ usage:
         su->sun_family = AF_UNIX;
         strcpy(su->sun_path, ux);
         sock = ux_open();
+#ifdef USE_SHM_FACES
+        if (use_shm && ccnl_shm_connect(sock, su, &chan, wait)) {
+            DEBUGMSG(WARNING, "no shared memory channel, using the socket\n");
+        }
+#endif
     } else { // UDP
         struct sockaddr_in *si = (struct sockaddr_in*) &sa;
         si->sin_family = PF_INET;
@@ -176,10 +211,15 @@ usage:
         } else {
             socksize = sizeof(struct sockaddr_in);
         }
+#ifdef USE_SHM_FACES
+        if (chan.area) {
+            rc = ccnl_shm_client_send(&chan, buf->data, buf->datalen);
+        } else
+#endif
         rc = sendto(sock, buf->data, buf->datalen, 0, (struct sockaddr*)&sa, socksize);
         if (rc < 0) {
             perror("sendto");
-            myexit(1);
+            peek_exit(sock, &sa, 1);
         }
         DEBUGMSG(DEBUG, "sendto returned %d\n", rc);
 
@@ -190,10 +230,20 @@ usage:
             size_t len2;
             DEBUGMSG(TRACE, "  waiting for packet\n");
 
-            if (block_on_read(sock, wait) <= 0) { // timeout
-                break;
+#ifdef USE_SHM_FACES
+            if (chan.area) {
+                len = ccnl_shm_client_recv(&chan, out, sizeof(out), wait);
+                if (len <= 0) { // timeout
+                    break;
+                }
+            } else
+#endif
+            {
+                if (block_on_read(sock, wait) <= 0) { // timeout
+                    break;
+                }
+                len = recv(sock, out, sizeof(out), 0);
             }
-            len = recv(sock, out, sizeof(out), 0);
 
             DEBUGMSG(DEBUG, "received %d bytes\n", len);
 /*
@@ -267,7 +317,7 @@ usage:
                 continue;
             }
             write(1, out, len);
-            myexit(0);
+            peek_exit(sock, &sa, 0);
         }
         if (cnt < 2)
             DEBUGMSG(WARNING, "re-sending interest\n");
@@ -275,8 +325,7 @@ usage:
     fprintf(stderr, "timeout\n");
 
 done:
-    close(sock);
-    myexit(-1);
+    peek_exit(sock, &sa, -1);
     return 0; // avoid a compiler warning
 }
 
@@ -0,0 +1,185 @@
+/**
+ * @file test_app.c
+ * @brief Tests for the in-process application face
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "ccnl-os-includes.h"
+#include "ccnl-core.h"
+#include "ccnl-app.h"
+#include "ccnl-dispatch.h"
+#include "ccnl-pkt-ndntlv.h"
+#include "ccnl-unix.h"
+
+static int delivered;           /* Data seen by the application */
+static struct ccnl_relay_s *delivered_to;
+static int resend;              /* app_rx sends this packet once more */
+static uint8_t *resend_pkt;
+static size_t resend_len;
+
+static void
+check_data(struct ccnl_content_s *c)
+{
+    char s[CCNL_MAX_PREFIX_SIZE];
+
+    assert_string_equal(ccnl_prefix_to_str(c->pkt->pfx, s, sizeof(s)),
+                        "/app/test");
+    assert_int_equal(c->pkt->contlen, 5);
+    assert_memory_equal(c->pkt->content, "hello", 5);
+}
+
+static int
+app_rx(struct ccnl_relay_s *relay, struct ccnl_content_s *c)
+{
+    delivered_to = relay;
+    check_data(c);
+    delivered++;
+    if (resend) {
+        resend--;
+        if (ccnl_app_send(relay, resend_pkt, resend_len)) {
+            delivered = -1;
+        }
+    }
+    return 0;
+}
+
+/* encodes an NDN Interest (with the given nonce) or Data packet for uri,
+   and sets pkt to its start in buf */
+static void
+app_pkt(const char *uri, int32_t nonce, uint8_t *buf, size_t size,
+        uint8_t **pkt, size_t *len)
+{
+    char u[CCNL_MAX_PREFIX_SIZE];
+    struct ccnl_prefix_s *p;
+    struct ccnl_ndntlv_interest_opts_s opts;
+    size_t offs = size;
+
+    strcpy(u, uri);
+    p = ccnl_URItoPrefix(u, 6, NULL); /* ndn2013 */
+    *pkt = NULL;
+    assert_non_null(p);
+    if (nonce) {
+        memset(&opts, 0, sizeof(opts));
+        opts.nonce = nonce;
+        assert_int_equal(ccnl_ndntlv_prependInterest(p, -1, &opts, &offs,
+                                                     buf, len), 0);
+    } else {
+        assert_int_equal(ccnl_ndntlv_prependContent(p, (uint8_t*) "hello", 5,
+                                     NULL, NULL, &offs, buf, len), 0);
+    }
+    ccnl_prefix_free(p);
+    *pkt = buf + offs;
+}
+
+void test_ccnl_app_round_trip()
+{
+    struct ccnl_relay_s relay, other;
+    uint8_t buf[256], *pkt;
+    size_t len;
+
+    memset(&relay, 0, sizeof(relay));
+    memset(&other, 0, sizeof(other));
+    ccnl_core_init();
+    ccnl_relay_config(&relay, NULL, NULL, -1, -1, -1, -1, -1, NULL, 6, 10, NULL);
+    ccnl_relay_config(&other, NULL, NULL, -1, -1, -1, -1, -1, NULL, 6, 10, NULL);
+    delivered = 0;
+    resend = 0;
+
+    app_pkt("/app/test", 1, buf, sizeof(buf), &pkt, &len);
+    assert_int_equal(ccnl_app_send(&relay, pkt, len), -1);
+    assert_int_equal(ccnl_app_open(&relay, app_rx), 0);
+    assert_non_null(relay.app_face);
+    assert_null(other.app_rx);
+
+    /* the Interest waits in the PIT, the Data answers it and is cached */
+    assert_int_equal(ccnl_app_send(&relay, pkt, len), 0);
+    assert_int_equal(relay.pitcnt, 1);
+    assert_int_equal(delivered, 0);
+    app_pkt("/app/test", 0, buf, sizeof(buf), &pkt, &len);
+    assert_int_equal(ccnl_app_send(&relay, pkt, len), 0);
+    assert_int_equal(delivered, 1);
+    assert_ptr_equal(delivered_to, &relay);
+    assert_int_equal(relay.pitcnt, 0);
+    assert_int_equal(relay.contentcnt, 1);
+
+    /* the next Interest is answered from the cache, before the send returns */
+    app_pkt("/app/test", 2, buf, sizeof(buf), &pkt, &len);
+    assert_int_equal(ccnl_app_send(&relay, pkt, len), 0);
+    assert_int_equal(delivered, 2);
+    assert_int_equal(relay.pitcnt, 0);
+
+    /* another relay in the process has an application of its own */
+    assert_int_equal(ccnl_app_send(&other, pkt, len), -1);
+
+    ccnl_app_close(&relay);
+    assert_null(relay.app_face);
+    assert_null(relay.app_rx);
+    assert_int_equal(ccnl_app_send(&relay, pkt, len), -1);
+    ccnl_core_cleanup(&relay);
+    ccnl_core_cleanup(&other);
+}
+
+void test_ccnl_app_send_from_rx()
+{
+    struct ccnl_relay_s relay;
+    uint8_t buf[256], again[256], *pkt;
+    size_t len;
+
+    memset(&relay, 0, sizeof(relay));
+    ccnl_core_init();
+    ccnl_relay_config(&relay, NULL, NULL, -1, -1, -1, -1, -1, NULL, 6, 10, NULL);
+    assert_int_equal(ccnl_app_open(&relay, app_rx), 0);
+    delivered = 0;
+
+    /* the application asks again for the Data it is given: the Interest is
+       not taken for the one being served, but answered from the cache */
+    app_pkt("/app/test", 1, buf, sizeof(buf), &pkt, &len);
+    assert_int_equal(ccnl_app_send(&relay, pkt, len), 0);
+    app_pkt("/app/test", 2, again, sizeof(again), &resend_pkt, &resend_len);
+    resend = 1;
+    app_pkt("/app/test", 0, buf, sizeof(buf), &pkt, &len);
+    assert_int_equal(ccnl_app_send(&relay, pkt, len), 0);
+    assert_int_equal(delivered, 2);
+    assert_int_equal(relay.pitcnt, 0);
+    assert_null(relay.app_queue);
+
+    /* an Interest for another name, sent while the cache answers, waits in
+       the PIT afterwards */
+    app_pkt("/app/other", 3, again, sizeof(again), &resend_pkt, &resend_len);
+    resend = 1;
+    app_pkt("/app/test", 4, buf, sizeof(buf), &pkt, &len);
+    assert_int_equal(ccnl_app_send(&relay, pkt, len), 0);
+    assert_int_equal(delivered, 3);
+    assert_int_equal(relay.pitcnt, 1);
+    assert_null(relay.app_queue);
+
+    ccnl_app_close(&relay);
+    ccnl_core_cleanup(&relay);
+}
+
+int main(void)
+{
+    const UnitTest tests[] = {
+        unit_test(test_ccnl_app_round_trip),
+        unit_test(test_ccnl_app_send_from_rx),
+    };
+
+    return run_tests(tests);
+}
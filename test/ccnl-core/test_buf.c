@@ -0,0 +1,189 @@
+/**
+ * @file test_buf.c
+ * @brief Tests for packet buffers, buffer pools and buffer adoption
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "ccnl-core.h"
+
+void test_ccnl_bufpool_recycle()
+{
+    struct ccnl_bufpool_s pool = { NULL, 64, 0, 1, 0, NULL };
+    struct ccnl_buf_s *b1 = ccnl_bufpool_get(&pool);
+    struct ccnl_buf_s *b2 = ccnl_bufpool_get(&pool);
+
+    assert_non_null(b1);
+    assert_non_null(b2);
+    assert_ptr_equal(b1->pool, &pool);
+    assert_int_equal(b1->datalen, 64);
+
+    b1->datalen = 10;
+    ccnl_buf_free(b1);
+    assert_int_equal(pool.count, 1);
+    /* the free list is full: b2 is freed */
+    ccnl_buf_free(b2);
+    assert_int_equal(pool.count, 1);
+
+    /* b1 comes back, with its full size */
+    b2 = ccnl_bufpool_get(&pool);
+    assert_ptr_equal(b2, b1);
+    assert_int_equal(b2->datalen, 64);
+    assert_int_equal(pool.count, 0);
+
+    ccnl_buf_free(b2);
+    ccnl_bufpool_drain(&pool);
+    assert_null(pool.free);
+    assert_int_equal(pool.count, 0);
+}
+
+void test_ccnl_buf_ref()
+{
+    struct ccnl_bufpool_s pool = { NULL, 64, 0, 4, 0, NULL };
+    struct ccnl_buf_s *b = ccnl_bufpool_get(&pool);
+
+    assert_int_equal(b->refcnt, 1);
+    assert_ptr_equal(ccnl_buf_ref(b), b);
+    assert_int_equal(b->refcnt, 2);
+    assert_null(ccnl_buf_ref(NULL));
+
+    /* only the last reference gives the buffer back */
+    ccnl_buf_free(b);
+    assert_int_equal(pool.count, 0);
+    ccnl_buf_free(b);
+    assert_int_equal(pool.count, 1);
+
+    b = ccnl_bufpool_get(&pool);
+    assert_int_equal(b->refcnt, 1);
+    ccnl_buf_free(b);
+    ccnl_bufpool_drain(&pool);
+}
+
+void test_ccnl_buf_hash()
+{
+    unsigned char data[200];
+    struct ccnl_buf_s *b1, *b2, *b3;
+
+    memset(data, 1, sizeof(data));
+    b1 = ccnl_buf_new(data, sizeof(data));
+    b2 = ccnl_buf_new(data, sizeof(data));
+    b3 = ccnl_buf_new(data, sizeof(data) - 1);
+    assert_int_equal(ccnl_buf_hash(b1), ccnl_buf_hash(b2));
+    /* the length is part of the digest */
+    assert_int_not_equal(ccnl_buf_hash(b1), ccnl_buf_hash(b3));
+
+    /* so are both ends */
+    b2->data[sizeof(data) - 1] = 2;
+    assert_int_not_equal(ccnl_buf_hash(b1), ccnl_buf_hash(b2));
+    b2->data[sizeof(data) - 1] = 1;
+    b2->data[0] = 2;
+    assert_int_not_equal(ccnl_buf_hash(b1), ccnl_buf_hash(b2));
+
+    /* but not the middle of a long buffer */
+    b2->data[0] = 1;
+    b2->data[sizeof(data) / 2] = 2;
+    assert_int_equal(ccnl_buf_hash(b1), ccnl_buf_hash(b2));
+    assert_false(buf_equal(b1, b2));
+
+    ccnl_buf_free(b1);
+    ccnl_buf_free(b2);
+    ccnl_buf_free(b3);
+}
+
+void test_ccnl_buf_adopt_copy()
+{
+    unsigned char data[] = "packet";
+    struct ccnl_buf_s *b;
+
+    /* nothing offered: a copy */
+    assert_null(ccnl_buf_offer(NULL));
+    b = ccnl_buf_adopt(data, sizeof(data));
+    assert_non_null(b);
+    assert_null(b->pool);
+    assert_int_equal(b->datalen, sizeof(data));
+    assert_memory_equal(b->data, data, sizeof(data));
+    ccnl_buf_free(b);
+}
+
+void test_ccnl_buf_adopt_offered()
+{
+    struct ccnl_bufpool_s pool = { NULL, 64, 0, 4, 0, NULL };
+    struct ccnl_buf_s *rx = ccnl_bufpool_get(&pool);
+    struct ccnl_buf_s *b;
+
+    rx->datalen = 40;
+    ccnl_buf_offer(rx);
+
+    /* part of the frame only: a copy, the offer stands */
+    b = ccnl_buf_adopt(rx->data + 1, 39);
+    assert_ptr_not_equal(b, rx);
+    ccnl_buf_free(b);
+    b = ccnl_buf_adopt(rx->data, 39);
+    assert_ptr_not_equal(b, rx);
+    ccnl_buf_free(b);
+
+    /* the whole frame: the buffer itself, which stays in the pool */
+    b = ccnl_buf_adopt(rx->data, 40);
+    assert_ptr_equal(b, rx);
+    assert_ptr_equal(b->pool, &pool);
+    assert_null(ccnl_buf_offer(NULL));
+
+    ccnl_buf_free(b);
+    assert_int_equal(pool.count, 1);
+    ccnl_bufpool_drain(&pool);
+}
+
+void test_ccnl_buf_adopt_small()
+{
+    struct ccnl_bufpool_s pool = { NULL, 64, 0, 4, 0, NULL };
+    struct ccnl_buf_s *rx = ccnl_bufpool_get(&pool);
+    struct ccnl_buf_s *b;
+
+    memset(rx->data, 'x', 10);
+    rx->datalen = 10;
+    ccnl_buf_offer(rx);
+
+    /* a small packet is copied, so as not to hold the whole buffer: the
+       offer stands, and the buffer can receive the next frame */
+    b = ccnl_buf_adopt(rx->data, 10);
+    assert_ptr_not_equal(b, rx);
+    assert_null(b->pool);
+    assert_int_equal(b->datalen, 10);
+    assert_memory_equal(b->data, rx->data, 10);
+    assert_ptr_equal(ccnl_buf_offer(NULL), rx);
+
+    ccnl_buf_free(b);
+    ccnl_buf_free(rx);
+    assert_int_equal(pool.count, 1);
+    ccnl_bufpool_drain(&pool);
+}
+
+int main(void)
+{
+    const UnitTest tests[] = {
+        unit_test(test_ccnl_bufpool_recycle),
+        unit_test(test_ccnl_buf_ref),
+        unit_test(test_ccnl_buf_hash),
+        unit_test(test_ccnl_buf_adopt_copy),
+        unit_test(test_ccnl_buf_adopt_offered),
+        unit_test(test_ccnl_buf_adopt_small),
+    };
+
+    return run_tests(tests);
+}
@@ -0,0 +1,172 @@
+/**
+ * @file test_htable.c
+ * @brief Tests for the hash table and the prefix hash
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "ccnl-core.h"
+#include "ccnl-pkt-ndntlv.h"
+
+struct item_s {
+    int key;
+    struct ccnl_hlink_s hlink;
+};
+
+static struct item_s*
+find_item(struct ccnl_htable_s *table, int key)
+{
+    struct ccnl_hlink_s *l;
+    uint32_t h = ccnl_hash_uint(CCNL_HASH_INIT, (uint32_t) key) & 0x7;
+
+    for (l = ccnl_htable_first(table, h); l; l = ccnl_htable_next(l)) {
+        struct item_s *it = CCNL_HTABLE_ENTRY(l, struct item_s, hlink);
+        if (it->key == key) {
+            return it;
+        }
+    }
+    return NULL;
+}
+
+void test_ccnl_htable_empty()
+{
+    struct ccnl_htable_s table = { 0 };
+
+    assert_null(ccnl_htable_first(&table, 42));
+    assert_null(find_item(&table, 1));
+    ccnl_htable_free(&table);
+}
+
+void test_ccnl_htable_add_remove()
+{
+    struct ccnl_htable_s table = { 0 };
+    struct item_s items[100];
+    int k;
+
+    /* only 8 distinct hash values: forces collisions and growing */
+    for (k = 0; k < 100; k++) {
+        items[k].key = k;
+        assert_int_equal(ccnl_htable_add(&table, &items[k].hlink,
+                 ccnl_hash_uint(CCNL_HASH_INIT, (uint32_t) k) & 0x7), 0);
+    }
+    assert_int_equal(table.count, 100);
+    assert_true(table.size >= 64);
+
+    for (k = 0; k < 100; k++) {
+        assert_ptr_equal(find_item(&table, k), &items[k]);
+    }
+    assert_null(find_item(&table, 100));
+
+    for (k = 0; k < 100; k += 2) {
+        assert_int_equal(ccnl_htable_remove(&table, &items[k].hlink), 0);
+    }
+    assert_int_equal(ccnl_htable_remove(&table, &items[0].hlink), -1);
+    assert_int_equal(table.count, 50);
+
+    for (k = 0; k < 100; k++) {
+        if (k % 2) {
+            assert_ptr_equal(find_item(&table, k), &items[k]);
+        } else {
+            assert_null(find_item(&table, k));
+        }
+    }
+    ccnl_htable_free(&table);
+    assert_null(table.buckets);
+}
+
+void test_ccnl_prefix_hash()
+{
+    /* ccnl_URItoPrefix modifies its argument */
+    char u1[] = "/ndn/test/a", u2[] = "/ndn/test/b", u3[] = "/ndn/testa";
+    char u4[] = "/ndn/test/a";
+    struct ccnl_prefix_s *p1 = ccnl_URItoPrefix(u1, 1, NULL);
+    struct ccnl_prefix_s *p2 = ccnl_URItoPrefix(u2, 1, NULL);
+    struct ccnl_prefix_s *p3 = ccnl_URItoPrefix(u3, 1, NULL);
+    struct ccnl_prefix_s *p4 = ccnl_URItoPrefix(u4, 6, NULL);
+
+    assert_int_equal(ccnl_prefix_hash(p1, 3), ccnl_prefix_hash(p1, 3));
+    assert_int_equal(ccnl_prefix_hash(p1, 2), ccnl_prefix_hash(p2, 2));
+    assert_int_not_equal(ccnl_prefix_hash(p1, 3), ccnl_prefix_hash(p2, 3));
+    /* component boundaries are part of the hash */
+    assert_int_not_equal(ccnl_prefix_hash(p1, 3), ccnl_prefix_hash(p3, 3));
+    /* so is the suite */
+    assert_int_not_equal(ccnl_prefix_hash(p1, 3), ccnl_prefix_hash(p4, 3));
+    /* the count is capped at the number of components */
+    assert_int_equal(ccnl_prefix_hash(p1, 3), ccnl_prefix_hash(p1, 10));
+
+    ccnl_prefix_free(p1);
+    ccnl_prefix_free(p2);
+    ccnl_prefix_free(p3);
+    ccnl_prefix_free(p4);
+}
+
+void test_ccnl_prefix_hashes()
+{
+    char u[] = "/ndn/test/a";
+    struct ccnl_prefix_s *p = ccnl_URItoPrefix(u, 1, NULL);
+    uint32_t hashes[5], k;
+
+    assert_int_equal(ccnl_prefix_hashes(p, hashes, 4), 3);
+    for (k = 0; k <= 3; k++) {
+        assert_int_equal(hashes[k], ccnl_prefix_hash(p, k));
+    }
+    assert_int_equal(ccnl_prefix_hashes(p, hashes, 1), 1);
+    assert_int_equal(hashes[1], ccnl_prefix_hash(p, 1));
+
+    ccnl_prefix_free(p);
+}
+
+void test_ccnl_ndntlv_name_hashes()
+{
+    char u[] = "/ndn/test/a";
+    struct ccnl_prefix_s *p = ccnl_URItoPrefix(u, 6, NULL); /* ndn2013 */
+    struct ccnl_ndntlv_interest_opts_s opts;
+    uint8_t buf[256];
+    size_t offs = sizeof(buf), len;
+    uint32_t hashes[CCNL_MAX_NAME_COMP + 1], k;
+
+    memset(&opts, 0, sizeof(opts));
+    assert_int_equal(ccnl_ndntlv_prependInterest(p, -1, &opts, &offs, buf, &len), 0);
+
+    /* the same hashes as for the parsed prefix */
+    assert_int_equal(ccnl_ndntlv_name_hashes(buf + offs, len, hashes, 4), 3);
+    for (k = 0; k <= 3; k++) {
+        assert_int_equal(hashes[k], ccnl_prefix_hash(p, k));
+    }
+    assert_int_equal(ccnl_ndntlv_name_hashes(buf + offs, len, hashes, 2), 2);
+    assert_int_equal(hashes[2], ccnl_prefix_hash(p, 2));
+
+    /* a truncated packet is not hashed */
+    assert_int_equal(ccnl_ndntlv_name_hashes(buf + offs, len - 1, hashes, 4), -1);
+
+    ccnl_prefix_free(p);
+}
+
+int main(void)
+{
+    const UnitTest tests[] = {
+        unit_test(test_ccnl_htable_empty),
+        unit_test(test_ccnl_htable_add_remove),
+        unit_test(test_ccnl_prefix_hash),
+        unit_test(test_ccnl_prefix_hashes),
+        unit_test(test_ccnl_ndntlv_name_hashes),
+    };
+
+    return run_tests(tests);
+}
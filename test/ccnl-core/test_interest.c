@@ -54,6 +54,46 @@ void test_ccnl_interest_remove_pending_invalid_parameters()
     assert_int_equal(result, -2); 
 }
 
+void test_ccnl_interest_deadline()
+{
+    struct ccnl_interest_s interest;
+    memset(&interest, 0, sizeof(interest));
+    interest.last_used = 100;
+    interest.lifetime = 4;
+
+    /* the next retransmission comes first */
+    assert_int_equal(ccnl_interest_deadline(&interest, 100, 1), 101);
+    /* then the end of the lifetime */
+    assert_int_equal(ccnl_interest_deadline(&interest, 104, 1), 104);
+    interest.lifetime = 0;
+    assert_int_equal(ccnl_interest_deadline(&interest, 100, 1), 100);
+}
+
+void test_ccnl_interest_deadline_spread()
+{
+    struct ccnl_interest_s interest;
+    uint32_t k, d, seen = 0;
+    memset(&interest, 0, sizeof(interest));
+    interest.last_used = 100;
+    interest.lifetime = 1000;
+
+    /* interests created at the same time are due within the second half of
+       the period, not all at its end */
+    for (k = 0; k < 64; k++) {
+        interest.hlink.hash = k * 0x9e3779b9;
+        d = ccnl_interest_deadline(&interest, 100, 8);
+        assert_in_range(d, 104, 108);
+        seen |= 1U << (d - 104);
+    }
+    assert_int_equal(seen, 0x1f);
+
+    /* and an interest is not always early by the same amount */
+    interest.hlink.hash = 0;
+    d = ccnl_interest_deadline(&interest, 100, 8);
+    interest.retries = 1;
+    assert_int_not_equal(ccnl_interest_deadline(&interest, 100, 8), d);
+}
+
 void test1()
 {
   int result = 0;
@@ -67,6 +107,8 @@ int main(void)
     unit_test(test_ccnl_interest_is_same_invalid_parameters),
     unit_test(test_ccnl_interest_remove_pending_invalid_parameters),
     unit_test(test_ccnl_interest_append_pending_invalid_parameters),
+    unit_test(test_ccnl_interest_deadline),
+    unit_test(test_ccnl_interest_deadline_spread),
   };
  
   return run_tests(tests);
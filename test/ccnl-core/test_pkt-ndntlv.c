@@ -0,0 +1,140 @@
+/**
+ * @file test_pkt-ndntlv.c
+ * @brief Tests for decoding NDN TLV packets
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "ccnl-core.h"
+#include "ccnl-pkt-ndntlv.h"
+
+static struct ccnl_pkt_s*
+decode(uint8_t *buf, size_t len, unsigned int opts)
+{
+    uint8_t *data = buf;
+    uint64_t typ;
+    size_t vallen;
+
+    if (ccnl_ndntlv_dehead(&data, &len, &typ, &vallen)) {
+        return NULL;
+    }
+    return ccnl_ndntlv_decode(typ, buf, &data, &len, opts);
+}
+
+void test_ccnl_ndntlv_decode_arena()
+{
+    char u[] = "/ndn/test/a";
+    uint32_t chunk = 7;
+    struct ccnl_prefix_s *p = ccnl_URItoPrefix(u, 6, &chunk); /* ndn2013 */
+    struct ccnl_ndntlv_interest_opts_s opts;
+    struct ccnl_pkt_s *heap, *arena;
+    uint8_t buf[256];
+    size_t offs = sizeof(buf), len;
+    uint32_t k;
+
+    memset(&opts, 0, sizeof(opts));
+    opts.nonce = 0x01020304;
+    opts.interestlifetime = 1000;
+    assert_int_equal(ccnl_ndntlv_prependInterest(p, -1, &opts, &offs, buf, &len), 0);
+
+    heap = decode(buf + offs, len, 0);
+    arena = decode(buf + offs, len, CCNL_DECODE_ARENA);
+    assert_non_null(heap);
+    assert_non_null(arena);
+    assert_false(heap->flags & CCNL_PKT_ARENA);
+    assert_true(arena->flags & CCNL_PKT_ARENA);
+
+    /* the same view of the packet */
+    assert_int_equal(arena->flags & ~CCNL_PKT_ARENA, heap->flags);
+    assert_int_equal(arena->pfx->compcnt, heap->pfx->compcnt);
+    for (k = 0; k < heap->pfx->compcnt; k++) {
+        assert_int_equal(arena->pfx->complen[k], heap->pfx->complen[k]);
+        assert_memory_equal(arena->pfx->comp[k], heap->pfx->comp[k],
+                            heap->pfx->complen[k]);
+    }
+    assert_int_equal(ccnl_prefix_cmp(arena->pfx, NULL, heap->pfx, CMP_EXACT), 0);
+    assert_non_null(arena->pfx->chunknum);
+    assert_int_equal(*arena->pfx->chunknum, chunk);
+    assert_int_equal(arena->s.ndntlv.nonce->datalen, 4);
+    assert_memory_equal(arena->s.ndntlv.nonce->data,
+                        heap->s.ndntlv.nonce->data, 4);
+    assert_int_equal(arena->s.ndntlv.interestlifetime, 1000);
+
+    /* offsets point into the packet buffer */
+    assert_true(arena->pfx->nameptr >= arena->buf->data &&
+                arena->pfx->nameptr < arena->buf->data + arena->buf->datalen);
+
+    ccnl_pkt_free(heap);
+    ccnl_pkt_free(arena);
+
+    /* a truncated packet is not decoded */
+    assert_null(decode(buf + offs, len - 1, CCNL_DECODE_ARENA));
+
+    ccnl_prefix_free(p);
+}
+
+void test_ccnl_ndntlv_decode_lazy()
+{
+    char u[] = "/ndn/test/a";
+    struct ccnl_prefix_s *p = ccnl_URItoPrefix(u, 6, NULL); /* ndn2013 */
+    struct ccnl_ndntlv_data_opts_s opts;
+    struct ccnl_pkt_s *eager, *lazy;
+    uint8_t buf[256], payload[] = "data";
+    size_t offs = sizeof(buf), len;
+
+    opts.freshnessperiod = 5000;
+    opts.finalblockid = 3;
+    assert_int_equal(ccnl_ndntlv_prependContent(p, payload, sizeof(payload),
+                                    NULL, &opts, &offs, buf, &len), 0);
+
+    eager = decode(buf + offs, len, 0);
+    lazy = decode(buf + offs, len, CCNL_DECODE_ARENA | CCNL_DECODE_LAZY);
+    assert_non_null(eager);
+    assert_non_null(lazy);
+    assert_false(eager->flags & CCNL_PKT_LAZY);
+    assert_int_equal(eager->s.ndntlv.freshnessperiod, 5000);
+    assert_int_equal(eager->val.final_block_id, 3);
+
+    /* what forwarding needs is there, the metadata is not decoded yet */
+    assert_true(lazy->flags & CCNL_PKT_LAZY);
+    assert_int_equal(ccnl_prefix_cmp(lazy->pfx, NULL, eager->pfx, CMP_EXACT), 0);
+    assert_int_equal(lazy->contlen, sizeof(payload));
+    assert_memory_equal(lazy->content, payload, sizeof(payload));
+    assert_int_equal(lazy->s.ndntlv.freshnessperiod, 0);
+
+    assert_int_equal(ccnl_pkt_decode_rest(lazy), 0);
+    assert_false(lazy->flags & CCNL_PKT_LAZY);
+    assert_int_equal(lazy->s.ndntlv.freshnessperiod, 5000);
+    assert_int_equal(lazy->val.final_block_id, 3);
+    assert_int_equal(ccnl_pkt_decode_rest(lazy), 0);
+
+    ccnl_pkt_free(eager);
+    ccnl_pkt_free(lazy);
+    ccnl_prefix_free(p);
+}
+
+int main(void)
+{
+    const UnitTest tests[] = {
+        unit_test(test_ccnl_ndntlv_decode_arena),
+        unit_test(test_ccnl_ndntlv_decode_lazy),
+    };
+
+    return run_tests(tests);
+}
@@ -0,0 +1,279 @@
+/**
+ * @file test_relay.c
+ * @brief Tests for the relay's nonce store
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "ccnl-core.h"
+#include "ccnl-pkt-ndntlv.h"
+
+static int
+nonce_seen(struct ccnl_relay_s *relay, uint32_t value, size_t len)
+{
+    struct ccnl_buf_s *nonce = calloc(1, sizeof(struct ccnl_buf_s) + len);
+    int result;
+
+    nonce->datalen = len;
+    memcpy(nonce->data, &value, sizeof(value));
+    result = ccnl_nonce_find_or_append(relay, nonce);
+    free(nonce);
+    return result;
+}
+
+void test_ccnl_nonce_find_or_append()
+{
+    struct ccnl_relay_s relay;
+    memset(&relay, 0, sizeof(relay));
+
+    assert_int_equal(nonce_seen(&relay, 1, 4), 0);
+    assert_int_equal(nonce_seen(&relay, 2, 4), 0);
+    assert_int_equal(nonce_seen(&relay, 1, 4), -1);
+    assert_int_equal(nonce_seen(&relay, 2, 4), -1);
+    /* the length is part of the nonce */
+    assert_int_equal(nonce_seen(&relay, 1, 8), 0);
+    /* nonces longer than CCNL_NONCE_MAXLEN are kept as well */
+    assert_int_equal(nonce_seen(&relay, 3, 24), 0);
+    assert_int_equal(nonce_seen(&relay, 3, 24), -1);
+    assert_int_equal(relay.noncecnt, 4);
+    ccnl_core_cleanup(&relay);
+}
+
+void test_ccnl_nonce_ring_full()
+{
+    struct ccnl_relay_s relay;
+    uint32_t k, max = CCNL_NONCE_RING_MIN + 5;
+    memset(&relay, 0, sizeof(relay));
+    relay.max_nonces = (int) max;
+
+    for (k = 0; k <= max; k++) {
+        assert_int_equal(nonce_seen(&relay, k, 4), 0);
+    }
+    assert_int_equal(relay.noncecnt, max);
+    assert_int_equal(relay.noncesize, max);
+    /* the oldest nonce was forgotten to make room */
+    assert_int_equal(nonce_seen(&relay, max, 4), -1);
+    assert_int_equal(nonce_seen(&relay, 1, 4), -1);
+    assert_int_equal(nonce_seen(&relay, 0, 4), 0);
+    ccnl_core_cleanup(&relay);
+}
+
+void test_ccnl_nonce_ring_grow()
+{
+    struct ccnl_relay_s relay;
+    uint32_t k, cnt = 3 * CCNL_NONCE_RING_MIN;
+    memset(&relay, 0, sizeof(relay));
+    relay.nonce_window = 60;
+
+    /* the ring grows to hold all nonces of the window, in their order */
+    for (k = 0; k < cnt; k++) {
+        assert_int_equal(nonce_seen(&relay, k, 4), 0);
+    }
+    assert_int_equal(relay.noncecnt, cnt);
+    assert_int_equal(relay.noncesize, 4 * CCNL_NONCE_RING_MIN);
+    assert_int_equal(relay.nonce_first, 0);
+    for (k = 0; k < cnt; k++) {
+        assert_int_equal(nonce_seen(&relay, k, 4), -1);
+    }
+    ccnl_core_cleanup(&relay);
+}
+
+void test_ccnl_fib_link_ifaces_only()
+{
+    struct ccnl_relay_s relay;
+    struct ccnl_face_s face;
+    struct ccnl_forward_s fwd;
+    memset(&relay, 0, sizeof(relay));
+    memset(&face, 0, sizeof(face));
+    memset(&fwd, 0, sizeof(fwd));
+
+    face.ifndx = -1;
+    fwd.face = &face;
+    relay.fib_ifaces_only = 1;
+    assert_int_equal(ccnl_fib_link(&relay, &fwd), -1);
+    assert_null(relay.fib);
+
+    face.ifndx = 0;
+    assert_int_equal(ccnl_fib_link(&relay, &fwd), 0);
+    assert_ptr_equal(relay.fib, &fwd);
+    ccnl_fib_unlink(&relay, &fwd);
+    assert_null(relay.fib);
+}
+
+static struct ccnl_pkt_s*
+ndn_pkt(const char *uri, int data)
+{
+    char u[CCNL_MAX_PREFIX_SIZE];
+    struct ccnl_prefix_s *p;
+    struct ccnl_ndntlv_interest_opts_s opts;
+    struct ccnl_pkt_s *pkt = NULL;
+    uint8_t buf[256], *start, *cp;
+    size_t offs = sizeof(buf), len, vallen;
+    uint64_t typ;
+    int8_t err;
+
+    strcpy(u, uri);
+    p = ccnl_URItoPrefix(u, 6, NULL); /* ndn2013 */
+    memset(&opts, 0, sizeof(opts));
+    if (data) {
+        err = ccnl_ndntlv_prependContent(p, (uint8_t*) "x", 1, NULL, NULL,
+                                         &offs, buf, &len);
+    } else {
+        err = ccnl_ndntlv_prependInterest(p, -1, &opts, &offs, buf, &len);
+    }
+    start = cp = buf + offs;
+    if (!err && !ccnl_ndntlv_dehead(&cp, &len, &typ, &vallen)) {
+        pkt = ccnl_ndntlv_bytes2pkt(typ, start, &cp, &len);
+    }
+    ccnl_prefix_free(p);
+    return pkt;
+}
+
+void test_ccnl_content_serve_pending()
+{
+    const char *names[] = { "/a", "/a/b", "/a/b", "/a/c",
+                            "/a/b/0123456789abcdef0123456789abcdef" };
+    struct ccnl_relay_s relay;
+    struct ccnl_pkt_s *pkt;
+    struct ccnl_content_s *c;
+    size_t k;
+    memset(&relay, 0, sizeof(relay));
+    relay.max_pit_entries = -1;
+
+    for (k = 0; k < sizeof(names) / sizeof(names[0]); k++) {
+        pkt = ndn_pkt(names[k], 0);
+        assert_non_null(pkt);
+        assert_non_null(ccnl_interest_new(&relay, NULL, &pkt));
+    }
+    assert_int_equal(relay.pit_digests.count, 1);
+
+    /* all interests for a prefix of the name are served, the others stay */
+    pkt = ndn_pkt("/a/b", 1);
+    assert_non_null(pkt);
+    c = ccnl_content_new(&pkt);
+    assert_non_null(c);
+    assert_int_equal(ccnl_content_serve_pending(&relay, c), 3);
+    assert_int_equal(relay.pitcnt, 2);
+    assert_int_equal(relay.pit_names.count, 2);
+    assert_int_equal(relay.pit_digests.count, 1);
+    assert_int_equal(ccnl_content_serve_pending(&relay, c), 0);
+
+    while (relay.pit) {
+        ccnl_interest_remove(&relay, relay.pit);
+    }
+    assert_int_equal(relay.pit_digests.count, 0);
+    ccnl_content_free(c);
+    ccnl_htable_free(&relay.pit_index);
+    ccnl_htable_free(&relay.pit_names);
+    ccnl_htable_free(&relay.pit_digests);
+    ccnl_wheel_free(&relay.pit_wheel);
+}
+
+static int sent, flushes;
+
+static void
+count_tx(struct ccnl_relay_s *relay, struct ccnl_if_s *ifc, sockunion *dst,
+         struct ccnl_buf_s *buf)
+{
+    (void) relay;
+    (void) ifc;
+    (void) dst;
+    (void) buf;
+    sent++;
+}
+
+static void
+drain(struct ccnl_relay_s *relay, struct ccnl_if_s *ifc)
+{
+    flushes++;
+    while (ifc->qlen > 0) {
+        ccnl_interface_CTS(relay, ifc);
+    }
+}
+
+void test_ccnl_interface_enqueue_full()
+{
+    struct ccnl_relay_s relay;
+    struct ccnl_pkt_s *pkt;
+    struct ccnl_content_s *c;
+    struct ccnl_interest_s *i;
+    struct ccnl_face_s *f;
+    sockunion su;
+    int k, faces = 2 * CCNL_MAX_IF_QLEN + 1;
+    memset(&relay, 0, sizeof(relay));
+    relay.max_pit_entries = -1;
+    relay.ifcount = 1;
+    relay.ifs[0].sock = -1;
+    relay.ccnl_ll_TX_ptr = count_tx;
+    relay.tx_deferred = 1;
+    relay.tx_flush = drain;
+
+    pkt = ndn_pkt("/a", 0);
+    assert_non_null(pkt);
+    i = ccnl_interest_new(&relay, NULL, &pkt);
+    assert_non_null(i);
+    memset(&su, 0, sizeof(su));
+    su.ip4.sin_family = AF_INET;
+    for (k = 0; k < faces; k++) {
+        su.ip4.sin_port = htons((uint16_t) (9000 + k));
+        f = ccnl_get_face_or_create(&relay, 0, &su.sa, sizeof(su.ip4));
+        assert_non_null(f);
+        assert_int_equal(ccnl_interest_append_pending(i, f), 0);
+    }
+
+    /* one Data for more faces than the interface queue holds: the queue is
+       sent each time it fills up, nothing is dropped */
+    pkt = ndn_pkt("/a", 1);
+    assert_non_null(pkt);
+    c = ccnl_content_new(&pkt);
+    assert_non_null(c);
+    sent = flushes = 0;
+    assert_int_equal(ccnl_content_serve_pending(&relay, c), faces);
+    assert_int_equal(relay.pitcnt, 0);
+    assert_int_equal(flushes, 2);
+    assert_int_equal(sent, 2 * CCNL_MAX_IF_QLEN);
+    assert_int_equal(relay.ifs[0].qlen, 1);
+    drain(&relay, relay.ifs);
+    assert_int_equal(sent, faces);
+
+    /* without a flush hook, the oldest packet goes instead of being dropped */
+    relay.tx_flush = NULL;
+    for (k = 0; k < CCNL_MAX_IF_QLEN + 1; k++) {
+        ccnl_send_pkt(&relay, relay.faces, c->pkt);
+    }
+    assert_int_equal(sent, faces + 1);
+    assert_int_equal(relay.ifs[0].qlen, CCNL_MAX_IF_QLEN);
+
+    ccnl_content_free(c);
+    ccnl_core_cleanup(&relay);
+}
+
+int main(void)
+{
+    const UnitTest tests[] = {
+        unit_test(test_ccnl_nonce_find_or_append),
+        unit_test(test_ccnl_nonce_ring_full),
+        unit_test(test_ccnl_nonce_ring_grow),
+        unit_test(test_ccnl_fib_link_ifaces_only),
+        unit_test(test_ccnl_content_serve_pending),
+        unit_test(test_ccnl_interface_enqueue_full),
+    };
+
+    return run_tests(tests);
+}
@@ -0,0 +1,261 @@
+/**
+ * @file test_shm.c
+ * @brief Tests for the shared memory channels
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "ccnl-os-includes.h"
+#include "ccnl-core.h"
+#include "ccnl-shm.h"
+
+#ifdef USE_SHM_FACES
+
+static struct ccnl_relay_s relay;
+static struct ccnl_shm_client_s client;
+static sockunion relay_addr, app_addr;
+static int app_sock = -1;
+
+static uint32_t received;       /* packets seen by deliver() */
+static int refill;              /* deliver() sends this many packets more */
+
+static int
+bind_unix(sockunion *su, const char *name)
+{
+    int sock = socket(AF_UNIX, SOCK_DGRAM, 0);
+
+    memset(su, 0, sizeof(*su));
+    su->ux.sun_family = AF_UNIX;
+    snprintf(su->ux.sun_path, sizeof(su->ux.sun_path), "/tmp/ccnl-test-%s-%d",
+             name, (int) getpid());
+    unlink(su->ux.sun_path);
+    if (sock >= 0 && bind(sock, &su->sa, sizeof(su->ux))) {
+        close(sock);
+        sock = -1;
+    }
+    return sock;
+}
+
+/* the relay's side of the handshake, while the application waits */
+static void*
+serve_request(void *arg)
+{
+    uint8_t buf[64];
+    sockunion src;
+    socklen_t addrlen = sizeof(src.ux);
+    ssize_t len;
+
+    (void) arg;
+    len = recvfrom(relay.ifs[0].sock, buf, sizeof(buf), 0, &src.sa, &addrlen);
+    if (len > 0) {
+        ccnl_shm_control(&relay, 0, buf, (size_t) len, &src);
+    }
+    return NULL;
+}
+
+/* packet k is k % 251 + 1 bytes of the value k */
+static size_t
+make_packet(uint32_t k, uint8_t *buf)
+{
+    size_t len = k % 251 + 1;
+
+    memset(buf, (int) (k & 0xff), len);
+    return len;
+}
+
+static void
+deliver(struct ccnl_relay_s *r, int ifndx, uint8_t *data, size_t len,
+        sockunion *src, struct ccnl_buf_s **rxbuf)
+{
+    uint8_t expect[256];
+
+    assert_ptr_equal(r, &relay);
+    assert_int_equal(ifndx, 0);
+    assert_string_equal(src->ux.sun_path, app_addr.ux.sun_path);
+    assert_ptr_equal(data, (*rxbuf)->data);
+
+    /* the slot is given back already: the application may fill it again,
+       which does not change the packet being delivered */
+    if (refill > 0) {
+        uint8_t other[256];
+        size_t olen = make_packet(received + CCNL_SHM_SLOTS, other);
+
+        assert_int_equal(ccnl_shm_client_send(&client, other, olen), 0);
+        refill--;
+    }
+    assert_int_equal(len, make_packet(received, expect));
+    assert_memory_equal(data, expect, len);
+    received++;
+}
+
+static void
+channel_open(void)
+{
+    pthread_t thread;
+
+    memset(&relay, 0, sizeof(relay));
+    relay.ifs[0].sock = bind_unix(&relay_addr, "shm-relay");
+    relay.ifcount = 1;
+    app_sock = bind_unix(&app_addr, "shm-app");
+    assert_true(relay.ifs[0].sock >= 0);
+    assert_true(app_sock >= 0);
+    assert_true(ccnl_shm_setup() >= 0);
+
+    assert_int_equal(pthread_create(&thread, NULL, serve_request, NULL), 0);
+    assert_int_equal(ccnl_shm_connect(app_sock, &relay_addr.ux, &client, 2), 0);
+    pthread_join(thread, NULL);
+}
+
+static void
+channel_close(void)
+{
+    ccnl_shm_disconnect(app_sock, &relay_addr.ux, &client);
+    ccnl_shm_cleanup();
+    close(app_sock);
+    close(relay.ifs[0].sock);
+    unlink(app_addr.ux.sun_path);
+    unlink(relay_addr.ux.sun_path);
+}
+
+void test_ccnl_shm_channel()
+{
+    sockunion other;
+
+    channel_open();
+    assert_non_null(ccnl_shm_of(&app_addr));
+    memset(&other, 0, sizeof(other));
+    other.ux.sun_family = AF_UNIX;
+    strcpy(other.ux.sun_path, "/tmp/ccnl-test-nobody");
+    assert_null(ccnl_shm_of(&other));
+
+    /* an application which asks again gets a new channel: the old is gone */
+    ccnl_shm_control(&relay, 0, (uint8_t*) "not a request", 13, &app_addr);
+    assert_non_null(ccnl_shm_of(&app_addr));
+    channel_close();
+}
+
+void test_ccnl_shm_ring_wraparound()
+{
+    uint8_t buf[256], got[256];
+    uint32_t k, sent = 0, round;
+    struct pollfd bell = { -1, POLLIN, 0 };
+
+    channel_open();
+    bell.fd = ccnl_shm_setup();
+    received = 0;
+    refill = 0;
+    for (round = 0; round < 3; round++) {
+        /* the ring holds CCNL_SHM_SLOTS packets, no more */
+        for (k = 0; k < CCNL_SHM_SLOTS; k++, sent++) {
+            size_t len = make_packet(sent, buf);
+            assert_int_equal(ccnl_shm_client_send(&client, buf, len), 0);
+        }
+        assert_int_equal(ccnl_shm_client_send(&client, buf, 1), -1);
+        ccnl_shm_rx(&relay, deliver);
+        assert_int_equal(received, sent);
+    }
+
+    /* a slot is free again before its packet is delivered */
+    for (k = 0; k < CCNL_SHM_SLOTS; k++, sent++) {
+        size_t len = make_packet(sent, buf);
+        assert_int_equal(ccnl_shm_client_send(&client, buf, len), 0);
+    }
+    refill = 5;
+    ccnl_shm_rx(&relay, deliver);
+    assert_int_equal(refill, 0);
+    assert_int_equal(received, sent);
+
+    /* a call takes a ring's worth, the doorbell stays readable for the rest */
+    assert_int_equal(poll(&bell, 1, 0), 1);
+    ccnl_shm_rx(&relay, deliver);
+    sent += 5;
+    assert_int_equal(received, sent);
+    assert_int_equal(poll(&bell, 1, 0), 0);
+
+    /* and back to the application, across the end of the ring */
+    for (k = 0; k < 2 * CCNL_SHM_SLOTS + 7; k++) {
+        size_t len = make_packet(k, buf);
+        assert_int_equal(ccnl_shm_send(ccnl_shm_of(&app_addr), buf, len),
+                         (ssize_t) len);
+        assert_int_equal(ccnl_shm_client_recv(&client, got, sizeof(got), 1),
+                         (ssize_t) len);
+        assert_memory_equal(got, buf, len);
+    }
+    assert_int_equal(ccnl_shm_client_recv(&client, got, sizeof(got), 0), 0);
+    channel_close();
+}
+
+/* asks for a channel (op 1), or releases it (op 4), as the application at
+   name would */
+static void
+fake_control(const char *name, uint32_t op, sockunion *src)
+{
+    uint8_t ctrl[12];
+
+    memset(src, 0, sizeof(*src));
+    src->ux.sun_family = AF_UNIX;
+    snprintf(src->ux.sun_path, sizeof(src->ux.sun_path),
+             "/tmp/ccnl-test-%s-%d", name, (int) getpid());
+    memcpy(ctrl, "ccnl-shm", 8);
+    memcpy(ctrl + 8, &op, sizeof(op));
+    assert_int_equal(ccnl_shm_control(&relay, 0, ctrl, sizeof(ctrl), src), 0);
+}
+
+void test_ccnl_shm_max_chans()
+{
+    sockunion src;
+    char name[32];
+    int k;
+
+    /* the application's channel, and as many more as are granted */
+    channel_open();
+    for (k = 1; k < CCNL_SHM_MAX_CHANS; k++) {
+        snprintf(name, sizeof(name), "shm-app%d", k);
+        fake_control(name, 1, &src);
+        assert_non_null(ccnl_shm_of(&src));
+    }
+    fake_control("shm-one-more", 1, &src);
+    assert_null(ccnl_shm_of(&src));
+
+    /* an application which asks again still gets its new channel */
+    fake_control("shm-app1", 1, &src);
+    assert_non_null(ccnl_shm_of(&src));
+
+    /* and a released channel makes room for the next */
+    fake_control("shm-app2", 4, &src);
+    assert_null(ccnl_shm_of(&src));
+    fake_control("shm-one-more", 1, &src);
+    assert_non_null(ccnl_shm_of(&src));
+    channel_close();
+}
+
+#endif // USE_SHM_FACES
+
+int main(void)
+{
+    const UnitTest tests[] = {
+#ifdef USE_SHM_FACES
+        unit_test(test_ccnl_shm_channel),
+        unit_test(test_ccnl_shm_ring_wraparound),
+        unit_test(test_ccnl_shm_max_chans),
+#endif
+    };
+
+    return run_tests(tests);
+}
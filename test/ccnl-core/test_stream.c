@@ -0,0 +1,155 @@
+/**
+ * @file test_stream.c
+ * @brief Tests for the stream faces
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "ccnl-os-includes.h"
+#include "ccnl-core.h"
+#include "ccnl-stream.h"
+#include "ccnl-pkt-ndntlv.h"
+
+#ifdef USE_STREAM_FACES
+
+void test_ccnl_stream_framelen_partial()
+{
+    char u[] = "/ndn/test/a";
+    struct ccnl_prefix_s *p = ccnl_URItoPrefix(u, 6, NULL); /* ndn2013 */
+    struct ccnl_ndntlv_interest_opts_s opts;
+    uint8_t buf[256], ccnx[] = { 1, 0, 0x01, 0x00, 64, 0, 0, 8 };
+    size_t offs = sizeof(buf), len, k;
+
+    memset(&opts, 0, sizeof(opts));
+    opts.nonce = 1;
+    assert_int_equal(ccnl_ndntlv_prependInterest(p, -1, &opts, &offs, buf, &len), 0);
+    ccnl_prefix_free(p);
+
+    /* too short to tell, then the whole packet is known from its header */
+    for (k = 0; k < 8; k++) {
+        assert_int_equal(ccnl_stream_framelen(buf + offs, k), 0);
+    }
+    for (k = 8; k <= len; k++) {
+        assert_int_equal(ccnl_stream_framelen(buf + offs, k), (ssize_t) len);
+    }
+    assert_int_equal(ccnl_stream_framelen(ccnx, 7), 0);
+    assert_int_equal(ccnl_stream_framelen(ccnx, 8), 256);
+}
+
+void test_ccnl_stream_framelen_oversized()
+{
+    /* an NDN Interest of 1 MiB, a CCNx packet of 64 KiB - 1 */
+    uint8_t ndn[] = { 0x05, 0xfe, 0x00, 0x10, 0x00, 0x00, 0x07, 0x00 };
+    uint8_t ccnx[] = { 1, 1, 0xff, 0xff, 64, 0, 0, 8 };
+
+    assert_int_equal(ccnl_stream_framelen(ndn, sizeof(ndn)), -1);
+    assert_int_equal(ccnl_stream_framelen(ccnx, sizeof(ccnx)), 0xffff);
+}
+
+void test_ccnl_stream_framelen_malformed()
+{
+    uint8_t ndn_len64[] = { 0x06, 0xff, 0, 0, 0, 0, 0, 0, 0, 1 };
+    uint8_t ccnx_short[] = { 1, 0, 0x00, 0x04, 64, 0, 0, 8 };
+    uint8_t ccnb[] = { 0x04, 0x82, 0xb2, 0x00, 0x00, 0x00, 0x00, 0x00 };
+    uint8_t unknown[] = { 0x42, 0, 0, 0, 0, 0, 0, 0 };
+
+    assert_int_equal(ccnl_stream_framelen(ndn_len64, sizeof(ndn_len64)), -1);
+    assert_int_equal(ccnl_stream_framelen(ccnx_short, sizeof(ccnx_short)), -1);
+    assert_int_equal(ccnl_stream_framelen(ccnb, sizeof(ccnb)), -1);
+    assert_int_equal(ccnl_stream_framelen(unknown, sizeof(unknown)), -1);
+}
+
+static void
+deliver(struct ccnl_relay_s *relay, int ifndx, uint8_t *data, size_t len,
+        sockunion *src, size_t addrlen)
+{
+    (void) relay;
+    (void) ifndx;
+    (void) data;
+    (void) len;
+    (void) src;
+    (void) addrlen;
+    assert_true(0); /* the clients send nothing */
+}
+
+void test_ccnl_stream_max_conns()
+{
+    struct ccnl_relay_s relay;
+    sockunion addr;
+    int clients[CCNL_STREAM_MAX_CONNS + 1], k;
+    char c;
+
+    memset(&relay, 0, sizeof(relay));
+    memset(&addr, 0, sizeof(addr));
+    addr.ux.sun_family = AF_UNIX;
+    snprintf(addr.ux.sun_path, sizeof(addr.ux.sun_path),
+             "/tmp/ccnl-test-stream-%d", (int) getpid());
+    relay.ifs[0].addr = addr;
+    relay.ifs[0].sock = ccnl_stream_listen(&relay, 0, &addr);
+    relay.ifcount = 1;
+    assert_true(relay.ifs[0].sock >= 0);
+
+    /* each connection is accepted before the next one is made */
+    for (k = 0; k <= CCNL_STREAM_MAX_CONNS; k++) {
+        clients[k] = socket(AF_UNIX, SOCK_STREAM, 0);
+        assert_true(clients[k] >= 0);
+        assert_int_equal(connect(clients[k], &addr.sa, sizeof(addr.ux)), 0);
+        ccnl_stream_rx(&relay, 0, deliver);
+    }
+
+    /* the connections up to the limit stay open, the one beyond is closed */
+    for (k = 0; k < CCNL_STREAM_MAX_CONNS; k++) {
+        assert_int_equal(recv(clients[k], &c, 1, MSG_DONTWAIT), -1);
+        assert_int_equal(errno, EAGAIN);
+    }
+    assert_int_equal(recv(clients[k], &c, 1, 0), 0);
+
+    /* and a closed one makes room for the next */
+    close(clients[0]);
+    ccnl_stream_rx(&relay, 0, deliver);
+    close(clients[k]);
+    clients[0] = socket(AF_UNIX, SOCK_STREAM, 0);
+    assert_int_equal(connect(clients[0], &addr.sa, sizeof(addr.ux)), 0);
+    ccnl_stream_rx(&relay, 0, deliver);
+    assert_int_equal(recv(clients[0], &c, 1, MSG_DONTWAIT), -1);
+    assert_int_equal(errno, EAGAIN);
+
+    for (k = 0; k < CCNL_STREAM_MAX_CONNS; k++) {
+        close(clients[k]);
+    }
+    ccnl_stream_cleanup();
+    close(relay.ifs[0].sock);
+    unlink(addr.ux.sun_path);
+}
+
+#endif // USE_STREAM_FACES
+
+int main(void)
+{
+    const UnitTest tests[] = {
+#ifdef USE_STREAM_FACES
+        unit_test(test_ccnl_stream_framelen_partial),
+        unit_test(test_ccnl_stream_framelen_oversized),
+        unit_test(test_ccnl_stream_framelen_malformed),
+        unit_test(test_ccnl_stream_max_conns),
+#endif
+    };
+
+    return run_tests(tests);
+}
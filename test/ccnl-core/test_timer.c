@@ -0,0 +1,77 @@
+/**
+ * @file test_timer.c
+ * @brief Tests for the timers
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "ccnl-core.h"
+
+static int fired;
+
+static void
+count(void *aux1, void *aux2)
+{
+    (void) aux1;
+    (void) aux2;
+    fired++;
+}
+
+void test_ccnl_rem_timer_stale_handle()
+{
+    struct timeval tv;
+    void *a, *b, *c;
+
+    /* a removed timer's handle does not remove the timer set next */
+    a = ccnl_set_timer(1000000, count, NULL, NULL);
+    assert_non_null(a);
+    ccnl_rem_timer(a);
+    assert_int_equal(ccnl_timer_next(&tv), -1);
+    b = ccnl_set_timer(1000000, count, NULL, NULL);
+    assert_non_null(b);
+    assert_ptr_not_equal(a, b);
+    ccnl_rem_timer(a);
+    assert_int_equal(ccnl_timer_next(&tv), 0);
+
+    /* neither does the handle of a timer which expired */
+    ccnl_rem_timer(b);
+    fired = 0;
+    a = ccnl_set_timer(0, count, NULL, NULL);
+    usleep(1000);
+    assert_int_equal(ccnl_run_events(), -1);
+    assert_int_equal(fired, 1);
+    c = ccnl_set_timer(1000000, count, NULL, NULL);
+    ccnl_rem_timer(a);
+    ccnl_rem_timer(b);
+    assert_int_equal(ccnl_timer_next(&tv), 0);
+    ccnl_rem_timer(c);
+    assert_int_equal(ccnl_timer_next(&tv), -1);
+
+    ccnl_rem_timer(NULL);
+    ccnl_timer_cleanup();
+}
+
+int main(void)
+{
+    const UnitTest tests[] = {
+        unit_test(test_ccnl_rem_timer_stale_handle),
+    };
+
+    return run_tests(tests);
+}
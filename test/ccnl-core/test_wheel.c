@@ -0,0 +1,101 @@
+/**
+ * @file test_wheel.c
+ * @brief Tests for the timing wheel
+ *
+ * Copyright (C) 2018 University of Basel
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any
+ * purpose with or without fee is hereby granted, provided that the above
+ * copyright notice and this permission notice appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+ * WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+ * ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+ * ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+ * OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+ */
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <cmocka.h>
+
+#include "ccnl-core.h"
+
+struct item_s {
+    int key;
+    struct ccnl_wlink_s wlink;
+};
+
+static int
+expire_all(struct ccnl_wheel_s *wheel, uint32_t now)
+{
+    int cnt = 0;
+
+    while (ccnl_wheel_expire(wheel, now)) {
+        cnt++;
+    }
+    return cnt;
+}
+
+void test_ccnl_wheel_empty()
+{
+    struct ccnl_wheel_s wheel = { 0 };
+
+    assert_null(ccnl_wheel_expire(&wheel, 1000));
+    ccnl_wheel_free(&wheel);
+}
+
+void test_ccnl_wheel_expire()
+{
+    struct ccnl_wheel_s wheel = { 0 };
+    struct item_s items[10];
+    struct ccnl_wlink_s *l;
+    int k;
+
+    memset(items, 0, sizeof(items));
+    assert_null(ccnl_wheel_expire(&wheel, 1000));
+    for (k = 0; k < 10; k++) {
+        items[k].key = k;
+        assert_int_equal(ccnl_wheel_schedule(&wheel, &items[k].wlink,
+                                             1000 + k), 0);
+    }
+    /* a deadline more than one revolution away shares a slot */
+    assert_int_equal(ccnl_wheel_schedule(&wheel, &items[9].wlink,
+                                         1000 + CCNL_WHEEL_SIZE), 0);
+
+    assert_int_equal(expire_all(&wheel, 1000), 1);
+    l = ccnl_wheel_expire(&wheel, 1002);
+    assert_ptr_equal(CCNL_WHEEL_ENTRY(l, struct item_s, wlink), &items[1]);
+    l = ccnl_wheel_expire(&wheel, 1002);
+    assert_ptr_equal(CCNL_WHEEL_ENTRY(l, struct item_s, wlink), &items[2]);
+    assert_null(ccnl_wheel_expire(&wheel, 1002));
+
+    /* cancelled and rescheduled entries */
+    ccnl_wheel_cancel(&items[3].wlink);
+    ccnl_wheel_cancel(&items[3].wlink);
+    assert_int_equal(ccnl_wheel_schedule(&wheel, &items[4].wlink, 1100), 0);
+    assert_int_equal(expire_all(&wheel, 1008), 4);
+    assert_int_equal(expire_all(&wheel, 1099), 0);
+    assert_int_equal(expire_all(&wheel, 1100), 1);
+
+    /* a deadline in the past is due at the next expiry */
+    assert_int_equal(ccnl_wheel_schedule(&wheel, &items[0].wlink, 10), 0);
+    assert_int_equal(expire_all(&wheel, 1100), 1);
+
+    /* a long pause visits every slot */
+    assert_int_equal(expire_all(&wheel, 1000 + 3 * CCNL_WHEEL_SIZE), 1);
+    ccnl_wheel_free(&wheel);
+    assert_null(wheel.slots);
+}
+
+int main(void)
+{
+    const UnitTest tests[] = {
+        unit_test(test_ccnl_wheel_empty),
+        unit_test(test_ccnl_wheel_expire),
+    };
+
+    return run_tests(tests);
+}